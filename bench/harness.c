@@ -0,0 +1,273 @@
+/**
+ * @file harness.c
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Running JWM under Xvfb for the benchmark tools.
+ *
+ */
+
+#include "harness.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <sys/select.h>
+
+/** Configuration used for JWM when none is given. */
+static const char CONFIG[] =
+   "<?xml version=\"1.0\"?>\n"
+   "<JWM>\n"
+   "   <Tray x=\"0\" y=\"-1\" autohide=\"off\">\n"
+   "      <Pager labeled=\"true\"/>\n"
+   "      <TaskList maxwidth=\"256\"/>\n"
+   "      <Clock/>\n"
+   "   </Tray>\n"
+   "   <Desktops width=\"4\" height=\"1\"/>\n"
+   "   <FocusModel>click</FocusModel>\n"
+   "   <SnapMode>none</SnapMode>\n"
+   "   <MoveMode>opaque</MoveMode>\n"
+   "   <ResizeMode>opaque</ResizeMode>\n"
+   "</JWM>\n";
+
+static const char *ATOM_NAMES[ATOM_COUNT] = {
+   "WM_STATE",
+   "_NET_WM_NAME",
+   "_NET_WM_ICON",
+   "_NET_FRAME_EXTENTS",
+   "_NET_REQUEST_FRAME_EXTENTS",
+   "_NET_CURRENT_DESKTOP",
+   "_NET_SUPPORTING_WM_CHECK",
+   "UTF8_STRING"
+};
+
+Display *display = NULL;
+Window rootWindow;
+Atom atoms[ATOM_COUNT];
+double timeout = DEFAULT_TIMEOUT;
+pid_t wmPid = 0;
+
+static Window probe;
+static pid_t serverPid = 0;
+static char configPath[64];
+
+static int HandleXError(Display *d, XErrorEvent *e);
+static pid_t Start(char *const argv[]);
+static void StartServer(const char *name);
+static void StartWM(const char *path, const char *name, const char *config);
+
+/** Start Xvfb and JWM. */
+void StartHarness(const char *displayName, const char *wmPath,
+                  const char *config)
+{
+   StartServer(displayName);
+   XSetErrorHandler(HandleXError);
+   rootWindow = DefaultRootWindow(display);
+   XInternAtoms(display, (char**)ATOM_NAMES, ATOM_COUNT, False, atoms);
+   probe = XCreateSimpleWindow(display, rootWindow, 0, 0, 1, 1, 0, 0, 0);
+   XSelectInput(display, probe, PropertyChangeMask);
+   StartWM(wmPath, displayName, config);
+}
+
+/** Get the current time in milliseconds. */
+double GetTime(void)
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return (double)tv.tv_sec * 1000.0 + (double)tv.tv_usec / 1000.0;
+}
+
+/** Get the CPU time used by a process in milliseconds (-1 if unknown). */
+double GetCPUTime(pid_t pid)
+{
+   char path[64];
+   char buffer[1024];
+   unsigned long utime, stime;
+   const char *p;
+   FILE *fd;
+   size_t len;
+
+   snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+   fd = fopen(path, "r");
+   if(!fd) {
+      return -1.0;
+   }
+   len = fread(buffer, 1, sizeof(buffer) - 1, fd);
+   fclose(fd);
+   buffer[len] = 0;
+
+   /* Skip past the command name, which may contain spaces. */
+   p = strrchr(buffer, ')');
+   if(!p || sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u"
+                          " %lu %lu", &utime, &stime) != 2) {
+      return -1.0;
+   }
+   return (double)(utime + stime) * 1000.0 / (double)sysconf(_SC_CLK_TCK);
+}
+
+/** Get the next event, waiting until a deadline. */
+char NextEvent(XEvent *event, double deadline)
+{
+   const int fd = ConnectionNumber(display);
+   while(XPending(display) == 0) {
+      struct timeval tv;
+      fd_set fds;
+      const double remaining = deadline - GetTime();
+      if(remaining <= 0.0) {
+         return 0;
+      }
+      tv.tv_sec = (long)(remaining / 1000.0);
+      tv.tv_usec = (long)(remaining * 1000.0) % 1000000;
+      FD_ZERO(&fds);
+      FD_SET(fd, &fds);
+      select(fd + 1, &fds, NULL, NULL, &tv);
+   }
+   XNextEvent(display, event);
+   return 1;
+}
+
+/** Wait for a property of a window to change. */
+char WaitForProperty(Window w, Atom atom, double deadline)
+{
+   XEvent event;
+   while(NextEvent(&event, deadline)) {
+      if(event.type == PropertyNotify
+         && event.xproperty.window == w
+         && event.xproperty.atom == atom) {
+         return 1;
+      }
+   }
+   return 0;
+}
+
+/** Wait for JWM to handle the requests sent so far. */
+char Ping(void)
+{
+   XEvent event;
+   memset(&event, 0, sizeof(event));
+   event.xclient.type = ClientMessage;
+   event.xclient.window = probe;
+   event.xclient.message_type = atoms[ATOM_NET_REQUEST_FRAME_EXTENTS];
+   event.xclient.format = 32;
+   XSendEvent(display, rootWindow, False,
+              SubstructureRedirectMask | SubstructureNotifyMask, &event);
+   XFlush(display);
+   return WaitForProperty(probe, atoms[ATOM_NET_FRAME_EXTENTS],
+                          GetTime() + timeout);
+}
+
+/** Ignore X errors (windows may be gone when JWM is slow). */
+int HandleXError(Display *d, XErrorEvent *e)
+{
+   return 0;
+}
+
+/** Start a program. */
+pid_t Start(char *const argv[])
+{
+   const pid_t pid = fork();
+   if(pid == 0) {
+      execvp(argv[0], argv);
+      fprintf(stderr, "could not run %s: %s\n", argv[0], strerror(errno));
+      _exit(1);
+   } else if(pid < 0) {
+      fprintf(stderr, "fork failed: %s\n", strerror(errno));
+      StopHarness();
+      exit(1);
+   }
+   return pid;
+}
+
+/** Start Xvfb and connect to it. */
+void StartServer(const char *name)
+{
+   char *argv[] = {
+      "Xvfb", NULL, "-screen", "0", "1280x1024x24", "-nolisten", "tcp", NULL
+   };
+   unsigned int tries;
+
+   argv[1] = (char*)name;
+   serverPid = Start(argv);
+   for(tries = 0; tries < 100; tries++) {
+      usleep(100000);
+      display = XOpenDisplay(name);
+      if(display) {
+         return;
+      }
+   }
+   fprintf(stderr, "could not connect to Xvfb on %s\n", name);
+   StopHarness();
+   exit(1);
+}
+
+/** Start JWM and wait for it to manage the screen. */
+void StartWM(const char *path, const char *name, const char *config)
+{
+   char *argv[] = { NULL, "-display", NULL, "-f", NULL, NULL };
+   unsigned int tries;
+   FILE *fd;
+   int fdn;
+
+   if(!config) {
+      strcpy(configPath, "/tmp/jwmbench-XXXXXX");
+      fdn = mkstemp(configPath);
+      fd = fdn >= 0 ? fdopen(fdn, "w") : NULL;
+      if(!fd) {
+         fprintf(stderr, "could not write %s\n", configPath);
+         StopHarness();
+         exit(1);
+      }
+      fputs(CONFIG, fd);
+      fclose(fd);
+      config = configPath;
+   }
+
+   argv[0] = (char*)path;
+   argv[2] = (char*)name;
+   argv[4] = (char*)config;
+   wmPid = Start(argv);
+
+   for(tries = 0; tries < 100; tries++) {
+      Atom type;
+      int format;
+      unsigned long count, extra;
+      unsigned char *data = NULL;
+      usleep(100000);
+      if(XGetWindowProperty(display, rootWindow,
+                            atoms[ATOM_NET_SUPPORTING_WM_CHECK],
+                            0, 1, False, XA_WINDOW, &type, &format,
+                            &count, &extra, &data) == Success && data) {
+         XFree(data);
+         if(count == 1) {
+            return;
+         }
+      }
+   }
+   fprintf(stderr, "%s did not start\n", path);
+   StopHarness();
+   exit(1);
+}
+
+/** Stop JWM and Xvfb. */
+void StopHarness(void)
+{
+   if(display) {
+      XCloseDisplay(display);
+      display = NULL;
+   }
+   if(wmPid > 0) {
+      kill(wmPid, SIGTERM);
+      waitpid(wmPid, NULL, 0);
+      wmPid = 0;
+   }
+   if(serverPid > 0) {
+      kill(serverPid, SIGTERM);
+      waitpid(serverPid, NULL, 0);
+      serverPid = 0;
+   }
+   if(configPath[0]) {
+      unlink(configPath);
+      configPath[0] = 0;
+   }
+}
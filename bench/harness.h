@@ -0,0 +1,93 @@
+/**
+ * @file harness.h
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Header for running JWM under Xvfb.
+ *
+ */
+
+#ifndef HARNESS_H
+#define HARNESS_H
+
+#include "../config.h"
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/Xatom.h>
+#ifdef HAVE_XTEST
+#  include <X11/extensions/XTest.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+/** Default time to wait for JWM to respond (milliseconds). */
+#define DEFAULT_TIMEOUT 2000.0
+
+/** Number of desktops in the default configuration. */
+#define DESKTOP_COUNT 4
+
+/** Atoms used by the harness. */
+typedef enum {
+   ATOM_WM_STATE,
+   ATOM_NET_WM_NAME,
+   ATOM_NET_WM_ICON,
+   ATOM_NET_FRAME_EXTENTS,
+   ATOM_NET_REQUEST_FRAME_EXTENTS,
+   ATOM_NET_CURRENT_DESKTOP,
+   ATOM_NET_SUPPORTING_WM_CHECK,
+   ATOM_UTF8_STRING,
+   ATOM_COUNT
+} AtomType;
+
+extern Display *display;
+extern Window rootWindow;
+extern Atom atoms[ATOM_COUNT];
+extern double timeout;
+extern pid_t wmPid;
+
+/** Start Xvfb and JWM.
+ * @param displayName The display to use for Xvfb.
+ * @param wmPath The JWM to run.
+ * @param config The configuration file (NULL for the default).
+ */
+void StartHarness(const char *displayName, const char *wmPath,
+                  const char *config);
+
+/** Stop JWM and Xvfb. */
+void StopHarness(void);
+
+/** Get the current time in milliseconds. */
+double GetTime(void);
+
+/** Get the CPU time used by a process in milliseconds (-1 if unknown). */
+double GetCPUTime(pid_t pid);
+
+/** Get the next event, waiting until a deadline.
+ * @param event The event.
+ * @param deadline The time (from GetTime) to stop waiting.
+ * @return 1 if there is an event, 0 if the deadline passed.
+ */
+char NextEvent(XEvent *event, double deadline);
+
+/** Wait for a property of a window to change.
+ * @param w The window (PropertyChangeMask must be selected).
+ * @param atom The property.
+ * @param deadline The time (from GetTime) to stop waiting.
+ * @return 1 if the property changed, 0 if the deadline passed.
+ */
+char WaitForProperty(Window w, Atom atom, double deadline);
+
+/** Wait for JWM to handle the requests sent so far.
+ * This sends _NET_REQUEST_FRAME_EXTENTS for an unmapped window. JWM
+ * handles events in order, so its answer (a change to
+ * _NET_FRAME_EXTENTS) shows that the requests before it were handled.
+ * @return 1 if JWM answered in time, 0 otherwise.
+ */
+char Ping(void);
+
+#endif /* HARNESS_H */
@@ -0,0 +1,508 @@
+/**
+ * @file jwmbench.c
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Load generator for measuring JWM performance.
+ *
+ * This starts Xvfb and JWM and then acts as a set of X clients running
+ * scripted scenarios. For each scenario, the latency from a request to
+ * the event that shows JWM handled it is measured, and the CPU time
+ * used by JWM is read from /proc.
+ *
+ * Requests that have no visible result of their own are followed by a
+ * _NET_REQUEST_FRAME_EXTENTS message for an unmapped window. JWM
+ * handles events in order, so its answer (a change to
+ * _NET_FRAME_EXTENTS) shows that the request before it was handled.
+ *
+ */
+
+#include "harness.h"
+
+/** Default number of windows. */
+#define DEFAULT_WINDOWS 200
+
+/** Number of operations in the sequential scenarios. */
+#define OPERATION_COUNT 500
+
+/** Number of steps in a simulated drag. */
+#define DRAG_STEPS 200
+
+/** A scenario. */
+typedef struct ScenarioType {
+   const char *name;
+   void (*Run)(void);
+} ScenarioType;
+
+
+static Window *windows = NULL;
+static double *sent = NULL;
+static unsigned int windowCount = DEFAULT_WINDOWS;
+
+static double *samples = NULL;
+static unsigned int sampleCount = 0;
+static unsigned int sampleMax = 0;
+static unsigned int lost = 0;
+
+static void RunMap(void);
+static void RunTitle(void);
+static void RunRestack(void);
+static void RunDesktop(void);
+static void RunUnmap(void);
+static void RunIcons(void);
+static void RunDrag(void);
+
+static const ScenarioType SCENARIOS[] = {
+   { "map",       RunMap      },
+   { "title",     RunTitle    },
+   { "restack",   RunRestack  },
+   { "desktop",   RunDesktop  },
+   { "unmap",     RunUnmap    },
+   { "icons",     RunIcons    },
+   { "drag",      RunDrag     }
+};
+static const unsigned int SCENARIO_COUNT
+   = sizeof(SCENARIOS) / sizeof(SCENARIOS[0]);
+
+static void AddSample(double ms);
+static int CompareSamples(const void *a, const void *b);
+static void ShowResults(const char *name, double cpu);
+static void Measure(double start, char done);
+static Window CreateClient(unsigned int index);
+static void MapStorm(void);
+static void UnmapStorm(void);
+static int FindWindow(Window w);
+static char IsSelected(const char *list, const char *name);
+static void Usage(const char *name);
+
+/** Record a latency. */
+void AddSample(double ms)
+{
+   if(sampleCount == sampleMax) {
+      sampleMax = sampleMax ? sampleMax * 2 : 1024;
+      samples = realloc(samples, sampleMax * sizeof(double));
+      if(!samples) {
+         fprintf(stderr, "out of memory\n");
+         exit(1);
+      }
+   }
+   samples[sampleCount++] = ms;
+}
+
+/** Order latencies. */
+int CompareSamples(const void *a, const void *b)
+{
+   const double da = *(const double*)a;
+   const double db = *(const double*)b;
+   return da < db ? -1 : (da > db ? 1 : 0);
+}
+
+/** Show the latency percentiles for a scenario and clear them. */
+void ShowResults(const char *name, double cpu)
+{
+   if(sampleCount > 0) {
+      qsort(samples, sampleCount, sizeof(double), CompareSamples);
+      printf("%-10s %6u %8.2f %8.2f %8.2f %8.2f %6u",
+             name, sampleCount,
+             samples[sampleCount * 50 / 100],
+             samples[sampleCount * 90 / 100],
+             samples[sampleCount * 99 / 100],
+             samples[sampleCount - 1], lost);
+   } else {
+      printf("%-10s %6u %8s %8s %8s %8s %6u",
+             name, 0, "-", "-", "-", "-", lost);
+   }
+   if(cpu >= 0.0) {
+      printf(" %8.0f\n", cpu);
+   } else {
+      printf(" %8s\n", "-");
+   }
+   fflush(stdout);
+   sampleCount = 0;
+   lost = 0;
+}
+
+/** Record the latency of an operation if it finished in time. */
+void Measure(double start, char done)
+{
+   if(done) {
+      AddSample(GetTime() - start);
+   } else {
+      lost += 1;
+   }
+}
+
+/** Create a client window. */
+Window CreateClient(unsigned int index)
+{
+   XSetWindowAttributes attr;
+   XClassHint hint;
+   char name[32];
+   Window w;
+
+   attr.background_pixel = 0x204060 + index * 0x10101;
+   attr.event_mask = StructureNotifyMask | PropertyChangeMask;
+   w = XCreateWindow(display, rootWindow,
+                     (index * 37) % 900, (index * 23) % 700, 300, 200, 0,
+                     CopyFromParent, InputOutput, CopyFromParent,
+                     CWBackPixel | CWEventMask, &attr);
+
+   snprintf(name, sizeof(name), "bench %u", index);
+   XStoreName(display, w, name);
+   hint.res_name = "jwmbench";
+   hint.res_class = "JWMBench";
+   XSetClassHint(display, w, &hint);
+   return w;
+}
+
+/** Find the index of a client window (-1 if not found). */
+int FindWindow(Window w)
+{
+   unsigned int i;
+   for(i = 0; i < windowCount; i++) {
+      if(windows[i] == w) {
+         return (int)i;
+      }
+   }
+   return -1;
+}
+
+/** Map all windows at once, measuring the time until each is mapped. */
+void MapStorm(void)
+{
+   XEvent event;
+   unsigned int i, remaining;
+   double deadline;
+
+   for(i = 0; i < windowCount; i++) {
+      sent[i] = GetTime();
+      XMapWindow(display, windows[i]);
+   }
+   XFlush(display);
+
+   remaining = windowCount;
+   deadline = GetTime() + timeout;
+   while(remaining > 0 && NextEvent(&event, deadline)) {
+      if(event.type == MapNotify) {
+         const int index = FindWindow(event.xmap.window);
+         if(index >= 0 && sent[index] > 0.0) {
+            const double now = GetTime();
+            AddSample(now - sent[index]);
+            sent[index] = 0.0;
+            remaining -= 1;
+            deadline = now + timeout;
+         }
+      }
+   }
+   lost += remaining;
+}
+
+/** Unmap all windows at once, measuring the time until JWM withdraws
+ * each (by removing WM_STATE).
+ */
+void UnmapStorm(void)
+{
+   XEvent event;
+   unsigned int i, remaining;
+   double deadline;
+
+   for(i = 0; i < windowCount; i++) {
+      sent[i] = GetTime();
+      XUnmapWindow(display, windows[i]);
+   }
+   XFlush(display);
+
+   remaining = windowCount;
+   deadline = GetTime() + timeout;
+   while(remaining > 0 && NextEvent(&event, deadline)) {
+      if(event.type == PropertyNotify
+         && event.xproperty.atom == atoms[ATOM_WM_STATE]
+         && event.xproperty.state == PropertyDelete) {
+         const int index = FindWindow(event.xproperty.window);
+         if(index >= 0 && sent[index] > 0.0) {
+            const double now = GetTime();
+            AddSample(now - sent[index]);
+            sent[index] = 0.0;
+            remaining -= 1;
+            deadline = now + timeout;
+         }
+      }
+   }
+   lost += remaining;
+}
+
+/** Determine if a scenario is in a comma-separated list. */
+char IsSelected(const char *list, const char *name)
+{
+   const size_t len = strlen(name);
+   while(list) {
+      if(!strncmp(list, name, len) && (list[len] == 0 || list[len] == ',')) {
+         return 1;
+      }
+      list = strchr(list, ',');
+      if(list) {
+         list += 1;
+      }
+   }
+   return 0;
+}
+
+/** Map storm of plain windows. */
+void RunMap(void)
+{
+   unsigned int i;
+   for(i = 0; i < windowCount; i++) {
+      windows[i] = CreateClient(i);
+   }
+   MapStorm();
+}
+
+/** Title changes, each followed by a ping. */
+void RunTitle(void)
+{
+   char name[64];
+   unsigned int i;
+   for(i = 0; i < OPERATION_COUNT; i++) {
+      const double start = GetTime();
+      const Window w = windows[i % windowCount];
+      const int len = snprintf(name, sizeof(name), "bench title %u", i);
+      XChangeProperty(display, w, atoms[ATOM_NET_WM_NAME],
+                      atoms[ATOM_UTF8_STRING], 8, PropModeReplace,
+                      (unsigned char*)name, len);
+      Measure(start, Ping());
+   }
+}
+
+/** Raise windows in turn, each followed by a ping. */
+void RunRestack(void)
+{
+   unsigned int i;
+   for(i = 0; i < OPERATION_COUNT; i++) {
+      const double start = GetTime();
+      XRaiseWindow(display, windows[(i * 7) % windowCount]);
+      Measure(start, Ping());
+   }
+}
+
+/** Switch desktops, waiting for JWM to update _NET_CURRENT_DESKTOP. */
+void RunDesktop(void)
+{
+   XEvent event;
+   unsigned int i;
+
+   XSelectInput(display, rootWindow, PropertyChangeMask);
+   for(i = 1; i <= OPERATION_COUNT / 5; i++) {
+      const double start = GetTime();
+      memset(&event, 0, sizeof(event));
+      event.xclient.type = ClientMessage;
+      event.xclient.window = rootWindow;
+      event.xclient.message_type = atoms[ATOM_NET_CURRENT_DESKTOP];
+      event.xclient.format = 32;
+      event.xclient.data.l[0] = i % DESKTOP_COUNT;
+      event.xclient.data.l[1] = CurrentTime;
+      XSendEvent(display, rootWindow, False,
+                 SubstructureRedirectMask | SubstructureNotifyMask, &event);
+      XFlush(display);
+      Measure(start, WaitForProperty(rootWindow,
+                                     atoms[ATOM_NET_CURRENT_DESKTOP],
+                                     start + timeout));
+   }
+   XSelectInput(display, rootWindow, NoEventMask);
+}
+
+/** Unmap storm. */
+void RunUnmap(void)
+{
+   UnmapStorm();
+}
+
+/** Map storm of windows with several icon sizes. */
+void RunIcons(void)
+{
+   static const unsigned int sizes[] = { 16, 32, 48, 64, 128 };
+   const unsigned int sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+   unsigned long *data;
+   unsigned int i, x, length;
+
+   length = 0;
+   for(i = 0; i < sizeCount; i++) {
+      length += 2 + sizes[i] * sizes[i];
+   }
+   data = malloc(length * sizeof(unsigned long));
+   if(!data) {
+      fprintf(stderr, "out of memory\n");
+      exit(1);
+   }
+
+   for(i = 0; i < windowCount; i++) {
+      unsigned int offset = 0;
+      unsigned int s;
+      for(s = 0; s < sizeCount; s++) {
+         data[offset++] = sizes[s];
+         data[offset++] = sizes[s];
+         for(x = 0; x < sizes[s] * sizes[s]; x++) {
+            data[offset++] = 0xFF000000UL | ((x * 2654435761UL + i) & 0xFFFFFF);
+         }
+      }
+      XDestroyWindow(display, windows[i]);
+      windows[i] = CreateClient(i);
+      XChangeProperty(display, windows[i], atoms[ATOM_NET_WM_ICON],
+                      XA_CARDINAL, 32, PropModeReplace,
+                      (unsigned char*)data, length);
+   }
+   free(data);
+
+   MapStorm();
+}
+
+/** Drag a window by its title bar with XTest. */
+void RunDrag(void)
+{
+#ifdef HAVE_XTEST
+   XWindowAttributes attr;
+   XEvent event;
+   Window w, root, parent, *children;
+   unsigned int count, i;
+   int x, y, eventBase, errorBase, major, minor;
+
+   if(!XTestQueryExtension(display, &eventBase, &errorBase,
+                           &major, &minor)) {
+      fprintf(stderr, "drag: XTest is not available\n");
+      return;
+   }
+
+   /* Map a window to drag. */
+   w = CreateClient(windowCount);
+   XMapWindow(display, w);
+   XFlush(display);
+   do {
+      if(!NextEvent(&event, GetTime() + timeout)) {
+         lost += 1;
+         return;
+      }
+   } while(event.type != MapNotify || event.xmap.window != w);
+
+   /* Find the frame and press in the middle of its title bar. */
+   if(!XQueryTree(display, w, &root, &parent, &children, &count)) {
+      return;
+   }
+   if(children) {
+      XFree(children);
+   }
+   XGetWindowAttributes(display, parent, &attr);
+   x = attr.x + attr.width / 2;
+   y = attr.y + 8;
+
+   /* Time the frame moving. The synthetic ConfigureNotify sent to the
+    * client is deferred until the pointer stops. */
+   XSelectInput(display, parent, StructureNotifyMask);
+
+   XTestFakeMotionEvent(display, -1, x, y, CurrentTime);
+   XTestFakeButtonEvent(display, 1, True, CurrentTime);
+   XFlush(display);
+   for(i = 0; i < DRAG_STEPS; i++) {
+      const double start = GetTime();
+      x += 2;
+      y += 1;
+      XTestFakeMotionEvent(display, -1, x, y, CurrentTime);
+      XFlush(display);
+      for(;;) {
+         if(!NextEvent(&event, start + timeout)) {
+            lost += 1;
+            break;
+         }
+         if(event.type == ConfigureNotify
+            && event.xconfigure.window == parent) {
+            AddSample(GetTime() - start);
+            break;
+         }
+      }
+   }
+   XTestFakeButtonEvent(display, 1, False, CurrentTime);
+   XDestroyWindow(display, w);
+   XFlush(display);
+#else
+   fprintf(stderr, "drag: built without XTest\n");
+#endif
+}
+
+/** Display usage information. */
+void Usage(const char *name)
+{
+   unsigned int i;
+   printf("usage: %s [options]\n", name);
+   printf("  -d display   display for Xvfb (default :99)\n");
+   printf("  -j path      JWM to run (default ../src/jwm)\n");
+   printf("  -n count     number of windows (default %u)\n",
+          DEFAULT_WINDOWS);
+   printf("  -s list      comma-separated scenarios to report:");
+   for(i = 0; i < SCENARIO_COUNT; i++) {
+      printf(" %s", SCENARIOS[i].name);
+   }
+   printf("\n");
+   printf("  -t ms        time to wait for JWM (default %.0f)\n",
+          DEFAULT_TIMEOUT);
+}
+
+int main(int argc, char *argv[])
+{
+   const char *displayName = ":99";
+   const char *wmPath = "../src/jwm";
+   const char *selected = NULL;
+   unsigned int i;
+   int x;
+
+   for(x = 1; x < argc; x++) {
+      if(!strcmp(argv[x], "-d") && x + 1 < argc) {
+         displayName = argv[++x];
+      } else if(!strcmp(argv[x], "-j") && x + 1 < argc) {
+         wmPath = argv[++x];
+      } else if(!strcmp(argv[x], "-n") && x + 1 < argc) {
+         windowCount = (unsigned int)atoi(argv[++x]);
+      } else if(!strcmp(argv[x], "-s") && x + 1 < argc) {
+         selected = argv[++x];
+      } else if(!strcmp(argv[x], "-t") && x + 1 < argc) {
+         timeout = atof(argv[++x]);
+      } else {
+         Usage(argv[0]);
+         return 1;
+      }
+   }
+   if(windowCount == 0) {
+      windowCount = 1;
+   }
+
+   windows = calloc(windowCount, sizeof(Window));
+   sent = calloc(windowCount, sizeof(double));
+   if(!windows || !sent) {
+      fprintf(stderr, "out of memory\n");
+      return 1;
+   }
+
+   StartHarness(displayName, wmPath, NULL);
+
+   printf("%u windows\n", windowCount);
+   printf("%-10s %6s %8s %8s %8s %8s %6s %8s\n", "scenario", "ops",
+          "p50 ms", "p90 ms", "p99 ms", "max ms", "lost", "cpu ms");
+
+   /* The map scenario always runs since the others need the windows. */
+   for(i = 0; i < SCENARIO_COUNT; i++) {
+      const char *name = SCENARIOS[i].name;
+      double cpu;
+      if(!selected || IsSelected(selected, name)) {
+         cpu = GetCPUTime(wmPid);
+         (SCENARIOS[i].Run)();
+         if(cpu >= 0.0) {
+            cpu = GetCPUTime(wmPid) - cpu;
+         }
+         ShowResults(name, cpu);
+      } else if(i == 0) {
+         (SCENARIOS[i].Run)();
+         sampleCount = 0;
+         lost = 0;
+      }
+   }
+
+   StopHarness();
+   return 0;
+}
@@ -0,0 +1,357 @@
+/**
+ * @file jwmmicro.c
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Microbenchmarks for JWM modules.
+ *
+ * The JWM modules are linked from src/libjwm.a against a stub X layer
+ * (xstub.c) that counts calls instead of talking to a server, so the
+ * computation around the X calls can be timed without a display. For
+ * each benchmark, the time and number of X calls per operation are
+ * reported.
+ *
+ */
+
+#include "../src/jwm.h"
+#include "../src/main.h"
+#include "../src/client.h"
+#include "../src/clientlist.h"
+#include "../src/color.h"
+#include "../src/font.h"
+#include "../src/gradient.h"
+#include "../src/icon.h"
+#include "../src/lex.h"
+#include "../src/misc.h"
+#include "../src/screen.h"
+#include "../src/settings.h"
+#include "micro.h"
+#include "xstub.h"
+
+/** Default number of clients. */
+#define DEFAULT_CLIENTS 100
+
+/** Default size of the source icon. */
+#define DEFAULT_ICON_SIZE 128
+
+/** Default number of menu items in the generated configuration. */
+#define DEFAULT_CONFIG_ITEMS 1000
+
+/** A benchmark. */
+typedef struct MicroBenchType {
+   const char *name;
+   void (*Run)(unsigned int count);
+   unsigned int count;     /**< Default number of operations. */
+} MicroBenchType;
+
+/* Globals normally defined in main.c. */
+Display *display = NULL;
+Window rootWindow;
+int rootWidth, rootHeight;
+int rootScreen;
+Colormap rootColormap;
+VisualData rootVisual;
+GC rootGC;
+int colormapCount;
+Window supportingWindow;
+Atom managerSelection;
+char shouldExit = 0;
+char shouldRestart = 0;
+char isRestarting = 0;
+char initializing = 0;
+char shouldReload = 0;
+char shouldReport = 0;
+unsigned int currentDesktop = 0;
+char *exitCommand = NULL;
+XContext clientContext;
+XContext frameContext;
+#ifdef USE_SHAPE
+char haveShape = 0;
+int shapeEvent;
+#endif
+#ifdef USE_XRENDER
+char haveRender = 0;
+#endif
+#ifdef USE_XSYNC
+char haveSync = 0;
+int syncEvent;
+#endif
+char *configPath = NULL;
+
+unsigned int benchClients = DEFAULT_CLIENTS;
+unsigned int benchIconSize = DEFAULT_ICON_SIZE;
+unsigned int benchErrors = 0;
+
+static unsigned int configItems = DEFAULT_CONFIG_ITEMS;
+static ClientNode *clients = NULL;
+static char *config = NULL;
+
+static void RunGradient(unsigned int count);
+static void RunTokenize(unsigned int count);
+static void RunStringWidth(unsigned int count);
+static void RunStringWidthHit(unsigned int count);
+
+static const MicroBenchType BENCHMARKS[] = {
+   { "tile",     RunTile,            100      },
+   { "snap",     RunSnap,            10000    },
+   { "icon",     RunIconScale,       1000     },
+   { "gradient", RunGradient,        10000    },
+   { "tokenize", RunTokenize,        100      },
+   { "width",    RunStringWidth,     100000   },
+   { "widthhit", RunStringWidthHit,  100000   }
+};
+static const unsigned int BENCHMARK_COUNT
+   = sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]);
+
+static double GetTime(void);
+static void Startup(void);
+static void CreateClients(void);
+static void CreateConfig(void);
+static char IsSelected(const char *list, const char *name);
+static void Usage(const char *name);
+
+/** Get the current time in milliseconds. */
+double GetTime(void)
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return (double)tv.tv_sec * 1000.0 + (double)tv.tv_usec / 1000.0;
+}
+
+/** Start the parts of JWM used by the benchmarks. */
+void Startup(void)
+{
+   display = JXOpenDisplay(NULL);
+   rootScreen = DefaultScreen(display);
+   rootWindow = RootWindow(display, rootScreen);
+   rootWidth = DisplayWidth(display, rootScreen);
+   rootHeight = DisplayHeight(display, rootScreen);
+   rootVisual.depth = DefaultDepth(display, rootScreen);
+   rootVisual.visual = DefaultVisual(display, rootScreen);
+   rootColormap = DefaultColormap(display, rootScreen);
+   rootGC = DefaultGC(display, rootScreen);
+   colormapCount = MaxCmapsOfScreen(ScreenOfDisplay(display, rootScreen));
+
+   InitializeColors();
+   InitializeFonts();
+   InitializeIcons();
+   InitializeScreens();
+   InitializeSettings();
+
+   StartupSettings();
+   StartupScreens();
+   StartupColors();
+   StartupFonts();
+   StartupIcons();
+}
+
+/** Create mapped clients scattered over the screen. */
+void CreateClients(void)
+{
+   unsigned int i;
+
+   clients = Allocate(benchClients * sizeof(ClientNode));
+   memset(clients, 0, benchClients * sizeof(ClientNode));
+   for(i = 0; i < benchClients; i++) {
+      ClientNode *np = &clients[i];
+      np->width = 100 + (i * 7919) % 200;
+      np->height = 80 + (i * 6007) % 160;
+      np->x = (i * 104729) % (rootWidth - np->width);
+      np->y = (i * 1299709) % (rootHeight - np->height);
+      np->xinc = 1;
+      np->yinc = 1;
+      np->state.border = BORDER_DEFAULT;
+      np->state.status = STAT_MAPPED;
+      np->state.layer = LAYER_NORMAL;
+
+      np->prev = NULL;
+      np->next = nodes[LAYER_NORMAL];
+      if(nodes[LAYER_NORMAL]) {
+         nodes[LAYER_NORMAL]->prev = np;
+      } else {
+         nodeTail[LAYER_NORMAL] = np;
+      }
+      nodes[LAYER_NORMAL] = np;
+   }
+}
+
+/** Create a configuration file with a large root menu. */
+void CreateConfig(void)
+{
+   static const char HEADER[] =
+      "<?xml version=\"1.0\"?>\n"
+      "<JWM>\n"
+      "   <RootMenu onroot=\"1\">\n";
+   static const char ITEM[] =
+      "      <Program icon=\"app%u.png\" label=\"Application %u\">"
+      "app%u --option=&quot;%u&quot;</Program>\n";
+   static const char FOOTER[] =
+      "   </RootMenu>\n"
+      "   <Tray x=\"0\" y=\"-1\"><Pager/><TaskList/><Clock/></Tray>\n"
+      "</JWM>\n";
+   size_t len, max;
+   unsigned int i;
+
+   max = sizeof(HEADER) + sizeof(FOOTER) + configItems * (sizeof(ITEM) + 40);
+   config = Allocate(max);
+   strcpy(config, HEADER);
+   len = strlen(config);
+   for(i = 0; i < configItems; i++) {
+      len += snprintf(&config[len], max - len, ITEM, i, i, i, i);
+   }
+   strcpy(&config[len], FOOTER);
+}
+
+/** Drawing title bar gradients. */
+void RunGradient(unsigned int count)
+{
+   unsigned int i;
+   for(i = 0; i < count; i++) {
+      const long from = (i * 2654435761UL) & 0xFFFFFF;
+      const long to = ~from & 0xFFFFFF;
+      DrawHorizontalGradient(rootWindow, rootGC, from, to, 0, 0, 400,
+                             settings.titleHeight);
+   }
+}
+
+/** Tokenizing a configuration with configItems menu items. */
+void RunTokenize(unsigned int count)
+{
+   TokenNode *tokens;
+   unsigned int i;
+   for(i = 0; i < count; i++) {
+      tokens = Tokenize(CopyString(config), "bench");
+      if(JUNLIKELY(!tokens)) {
+         benchErrors += 1;
+      }
+      ReleaseTokens(tokens);
+   }
+}
+
+/** Measuring a new title each time (text cache misses). */
+void RunStringWidth(unsigned int count)
+{
+   char title[64];
+   unsigned int i;
+   for(i = 0; i < count; i++) {
+      snprintf(title, sizeof(title), "Window title %u", i);
+      if(JUNLIKELY(GetStringWidth(FONT_BORDER, title) <= 0)) {
+         benchErrors += 1;
+      }
+   }
+}
+
+/** Measuring the titles of benchClients clients (text cache hits). */
+void RunStringWidthHit(unsigned int count)
+{
+   char title[64];
+   unsigned int i;
+   for(i = 0; i < count; i++) {
+      snprintf(title, sizeof(title), "Window title for client %u",
+               i % benchClients);
+      if(JUNLIKELY(GetStringWidth(FONT_BORDER, title) <= 0)) {
+         benchErrors += 1;
+      }
+   }
+}
+
+/** Determine if a name is in a comma-separated list. */
+char IsSelected(const char *list, const char *name)
+{
+   const size_t len = strlen(name);
+   while(list) {
+      if(!strncmp(list, name, len) && (list[len] == ',' || !list[len])) {
+         return 1;
+      }
+      list = strchr(list, ',');
+      if(list) {
+         list += 1;
+      }
+   }
+   return 0;
+}
+
+/** Display usage information. */
+void Usage(const char *name)
+{
+   unsigned int i;
+   printf("usage: %s [options]\n", name);
+   printf("  -c count     menu items in the configuration (default %u)\n",
+          DEFAULT_CONFIG_ITEMS);
+   printf("  -i size      size of the source icon (default %u)\n",
+          DEFAULT_ICON_SIZE);
+   printf("  -n count     number of clients (default %u)\n",
+          DEFAULT_CLIENTS);
+   printf("  -o count     operations per benchmark\n");
+   printf("  -s list      comma-separated benchmarks to run:");
+   for(i = 0; i < BENCHMARK_COUNT; i++) {
+      printf(" %s", BENCHMARKS[i].name);
+   }
+   printf("\n");
+   printf("  -v           show the X calls made by each benchmark\n");
+}
+
+int main(int argc, char *argv[])
+{
+   const char *selected = NULL;
+   unsigned int operations = 0;
+   char verbose = 0;
+   unsigned int i;
+   int x;
+
+   for(x = 1; x < argc; x++) {
+      if(!strcmp(argv[x], "-c") && x + 1 < argc) {
+         configItems = (unsigned int)atoi(argv[++x]);
+      } else if(!strcmp(argv[x], "-i") && x + 1 < argc) {
+         benchIconSize = (unsigned int)atoi(argv[++x]);
+      } else if(!strcmp(argv[x], "-n") && x + 1 < argc) {
+         benchClients = (unsigned int)atoi(argv[++x]);
+      } else if(!strcmp(argv[x], "-o") && x + 1 < argc) {
+         operations = (unsigned int)atoi(argv[++x]);
+      } else if(!strcmp(argv[x], "-s") && x + 1 < argc) {
+         selected = argv[++x];
+      } else if(!strcmp(argv[x], "-v")) {
+         verbose = 1;
+      } else {
+         Usage(argv[0]);
+         return 1;
+      }
+   }
+   if(benchClients == 0) {
+      benchClients = 1;
+   }
+   if(benchIconSize == 0) {
+      benchIconSize = 1;
+   }
+
+   Startup();
+   CreateClients();
+   CreateConfig();
+
+   printf("%u clients, %ux%u icon, %u menu items\n",
+          benchClients, benchIconSize, benchIconSize, configItems);
+   printf("%-10s %10s %12s %12s\n", "benchmark", "ops", "us/op", "X calls/op");
+   for(i = 0; i < BENCHMARK_COUNT; i++) {
+      const MicroBenchType *bp = &BENCHMARKS[i];
+      const unsigned int count = operations ? operations : bp->count;
+      double start, elapsed;
+      if(selected && !IsSelected(selected, bp->name)) {
+         continue;
+      }
+      ResetStubCalls();
+      start = GetTime();
+      (bp->Run)(count);
+      elapsed = GetTime() - start;
+      printf("%-10s %10u %12.3f %12.1f\n", bp->name, count,
+             elapsed * 1000.0 / count, (double)GetStubCalls() / count);
+      if(verbose) {
+         ShowStubCalls();
+      }
+   }
+
+   if(benchErrors > 0) {
+      fprintf(stderr, "%s: %u wrong results\n", argv[0], benchErrors);
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,505 @@
+/**
+ * @file jwmreplay.c
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Replay of events recorded with "jwm -capture".
+ *
+ * This starts Xvfb and JWM and then recreates the clients in a capture:
+ * windows are created with the recorded geometry and properties and the
+ * requests that caused the recorded events (maps, configure requests,
+ * withdrawals, client messages, and, with XTest, input) are made again.
+ * Events that JWM caused itself are skipped. Events are replayed as
+ * fast as possible unless -r is given.
+ *
+ */
+
+#include "harness.h"
+#include "../src/capture.h"
+
+#include <sys/time.h>
+
+/** Map from a recorded ID to a local one. */
+typedef struct IDMap {
+   unsigned long *from;
+   unsigned long *to;
+   unsigned int count;
+   unsigned int max;
+} IDMap;
+
+/** Properties that JWM sets on clients (these are not replayed once the
+ * client is mapped). */
+static const char *WM_PROPERTIES[] = {
+   "WM_STATE",
+   "_NET_FRAME_EXTENTS",
+   "_NET_WM_ALLOWED_ACTIONS",
+   "_NET_WM_DESKTOP",
+   "_NET_WM_STATE"
+};
+static const unsigned int WM_PROPERTY_COUNT
+   = sizeof(WM_PROPERTIES) / sizeof(WM_PROPERTIES[0]);
+
+static FILE *input = NULL;
+static IDMap atomMap;
+static IDMap windowMap;
+static Atom wmProperties[sizeof(WM_PROPERTIES) / sizeof(WM_PROPERTIES[0])];
+static Atom netWMState;
+static char realTime = 0;
+static char useInput = 1;
+static char newWindow = 0;
+static unsigned long replayed = 0;
+static unsigned long skipped = 0;
+
+static int ReadValue(void);
+static unsigned long FindID(const IDMap *map, unsigned long from);
+static void InsertID(IDMap *map, unsigned long from, unsigned long to);
+static void RemoveID(IDMap *map, unsigned long from);
+static Atom TranslateAtom(unsigned long atom);
+static void ReadAtom(void);
+static void ReadWindow(void);
+static void ReadProperty(void);
+static void ReadEvent(double start);
+static void ReplayEvent(XEvent *event, long flags);
+static void ReplayInput(const XEvent *event);
+static void Usage(const char *name);
+
+/** Read a 32-bit value. */
+int ReadValue(void)
+{
+   int value = 0;
+   if(fread(&value, sizeof(value), 1, input) != 1) {
+      fprintf(stderr, "capture file is truncated\n");
+      StopHarness();
+      exit(1);
+   }
+   return value;
+}
+
+/** Look up a recorded ID (0 if unknown). */
+unsigned long FindID(const IDMap *map, unsigned long from)
+{
+   unsigned int x;
+   for(x = 0; x < map->count; x++) {
+      if(map->from[x] == from) {
+         return map->to[x];
+      }
+   }
+   return 0;
+}
+
+/** Add or replace a recorded ID. */
+void InsertID(IDMap *map, unsigned long from, unsigned long to)
+{
+   unsigned int x;
+   for(x = 0; x < map->count; x++) {
+      if(map->from[x] == from) {
+         map->to[x] = to;
+         return;
+      }
+   }
+   if(map->count == map->max) {
+      map->max = map->max ? map->max * 2 : 64;
+      map->from = realloc(map->from, map->max * sizeof(unsigned long));
+      map->to = realloc(map->to, map->max * sizeof(unsigned long));
+      if(!map->from || !map->to) {
+         fprintf(stderr, "out of memory\n");
+         exit(1);
+      }
+   }
+   map->from[map->count] = from;
+   map->to[map->count] = to;
+   map->count += 1;
+}
+
+/** Remove a recorded ID. */
+void RemoveID(IDMap *map, unsigned long from)
+{
+   unsigned int x;
+   for(x = 0; x < map->count; x++) {
+      if(map->from[x] == from) {
+         map->count -= 1;
+         map->from[x] = map->from[map->count];
+         map->to[x] = map->to[map->count];
+         return;
+      }
+   }
+}
+
+/** Translate a recorded atom. */
+Atom TranslateAtom(unsigned long atom)
+{
+   const Atom result = FindID(&atomMap, atom);
+   if(result == None && atom <= XA_LAST_PREDEFINED) {
+      return atom;
+   }
+   return result;
+}
+
+/** Read an atom name. */
+void ReadAtom(void)
+{
+   char *name;
+   const unsigned long atom = (unsigned int)ReadValue();
+   const int len = ReadValue();
+
+   name = malloc(len + 1);
+   if(!name || fread(name, 1, len, input) != (size_t)len) {
+      fprintf(stderr, "capture file is truncated\n");
+      StopHarness();
+      exit(1);
+   }
+   name[len] = 0;
+   InsertID(&atomMap, atom, XInternAtom(display, name, False));
+   free(name);
+}
+
+/** Read the geometry of a window about to be mapped and create it. */
+void ReadWindow(void)
+{
+   XSetWindowAttributes attr;
+   const unsigned long from = (unsigned int)ReadValue();
+   const int x = ReadValue();
+   const int y = ReadValue();
+   const int width = ReadValue();
+   const int height = ReadValue();
+   const int border = ReadValue();
+   Window w;
+
+   w = FindID(&windowMap, from);
+   if(w == None) {
+      attr.background_pixel = 0x808080;
+      w = XCreateWindow(display, rootWindow, x, y,
+                        width > 0 ? width : 1, height > 0 ? height : 1,
+                        border, CopyFromParent, InputOutput, CopyFromParent,
+                        CWBackPixel, &attr);
+      InsertID(&windowMap, from, w);
+   } else {
+      XMoveResizeWindow(display, w, x, y,
+                        width > 0 ? width : 1, height > 0 ? height : 1);
+   }
+   newWindow = 1;
+}
+
+/** Read a property and set it. */
+void ReadProperty(void)
+{
+   const Window w = FindID(&windowMap, (unsigned int)ReadValue());
+   const Atom atom = TranslateAtom((unsigned int)ReadValue());
+   const Atom type = TranslateAtom((unsigned int)ReadValue());
+   const int format = ReadValue();
+   const int count = ReadValue();
+   unsigned char *data;
+   size_t size;
+   int x;
+
+   size = format == 32 ? sizeof(long) : (format == 16 ? sizeof(short) : 1);
+   data = malloc(size * (count > 0 ? count : 1));
+   if(!data) {
+      fprintf(stderr, "out of memory\n");
+      exit(1);
+   }
+   if(format == 32) {
+      for(x = 0; x < count; x++) {
+         ((long*)data)[x] = (unsigned int)ReadValue();
+      }
+      if(type == XA_ATOM) {
+         for(x = 0; x < count; x++) {
+            ((long*)data)[x] = TranslateAtom(((long*)data)[x]);
+         }
+      }
+   } else if(count > 0) {
+      if(fread(data, size, count, input) != (size_t)count) {
+         fprintf(stderr, "capture file is truncated\n");
+         StopHarness();
+         exit(1);
+      }
+   }
+
+   /* Skip properties of unknown windows and those JWM sets itself. */
+   if(w == None || atom == None) {
+      free(data);
+      return;
+   }
+   if(!newWindow) {
+      for(x = 0; x < (int)WM_PROPERTY_COUNT; x++) {
+         if(atom == wmProperties[x]) {
+            free(data);
+            return;
+         }
+      }
+   }
+
+   if(type == None) {
+      XDeleteProperty(display, w, atom);
+   } else {
+      XChangeProperty(display, w, atom, type, format, PropModeReplace,
+                      data, count);
+   }
+   free(data);
+}
+
+/** Read an event and replay it. */
+void ReadEvent(double start)
+{
+   XEvent event;
+   const int sec = ReadValue();
+   const int usec = ReadValue();
+   const long flags = ReadValue();
+
+   if(fread(&event, sizeof(event), 1, input) != 1) {
+      fprintf(stderr, "capture file is truncated\n");
+      StopHarness();
+      exit(1);
+   }
+   newWindow = 0;
+
+   if(realTime) {
+      const double delay = start + sec * 1000.0 + usec / 1000.0 - GetTime();
+      if(delay > 0.0) {
+         XFlush(display);
+         usleep((useconds_t)(delay * 1000.0));
+      }
+   }
+   ReplayEvent(&event, flags);
+}
+
+/** Make the request that caused an event. */
+void ReplayEvent(XEvent *event, long flags)
+{
+   XWindowChanges wc;
+   Window w;
+   unsigned int mask;
+
+   switch(event->type) {
+   case MapRequest:
+      w = FindID(&windowMap, event->xmaprequest.window);
+      if(w != None) {
+         XMapWindow(display, w);
+         replayed += 1;
+         return;
+      }
+      break;
+   case ConfigureRequest:
+      w = FindID(&windowMap, event->xconfigurerequest.window);
+      if(w != None) {
+         mask = event->xconfigurerequest.value_mask;
+         wc.x = event->xconfigurerequest.x;
+         wc.y = event->xconfigurerequest.y;
+         wc.width = event->xconfigurerequest.width;
+         wc.height = event->xconfigurerequest.height;
+         wc.border_width = event->xconfigurerequest.border_width;
+         wc.stack_mode = event->xconfigurerequest.detail;
+         wc.sibling = FindID(&windowMap, event->xconfigurerequest.above);
+         if(wc.sibling == None) {
+            mask &= ~CWSibling;
+         }
+         XConfigureWindow(display, w, mask, &wc);
+         replayed += 1;
+         return;
+      }
+      break;
+   case UnmapNotify:
+      w = FindID(&windowMap, event->xunmap.window);
+      if(w != None && (flags & CAPTURE_WITHDRAW)) {
+         if(event->xunmap.send_event) {
+            event->xunmap.event = rootWindow;
+            event->xunmap.window = w;
+            XSendEvent(display, rootWindow, False,
+                       SubstructureRedirectMask | SubstructureNotifyMask,
+                       event);
+         } else {
+            XUnmapWindow(display, w);
+         }
+         replayed += 1;
+         return;
+      }
+      break;
+   case DestroyNotify:
+      w = FindID(&windowMap, event->xdestroywindow.window);
+      if(w != None) {
+         XDestroyWindow(display, w);
+         RemoveID(&windowMap, event->xdestroywindow.window);
+         replayed += 1;
+         return;
+      }
+      break;
+   case ClientMessage:
+      w = FindID(&windowMap, event->xclient.window);
+      event->xclient.window = w != None ? w : rootWindow;
+      event->xclient.message_type
+         = TranslateAtom(event->xclient.message_type);
+      if(event->xclient.message_type == None) {
+         break;
+      }
+      if(event->xclient.message_type == netWMState) {
+         event->xclient.data.l[1] = TranslateAtom(event->xclient.data.l[1]);
+         event->xclient.data.l[2] = TranslateAtom(event->xclient.data.l[2]);
+      }
+      XSendEvent(display, rootWindow, False,
+                 SubstructureRedirectMask | SubstructureNotifyMask, event);
+      replayed += 1;
+      return;
+   case ButtonPress:
+   case ButtonRelease:
+   case MotionNotify:
+   case KeyPress:
+   case KeyRelease:
+      if(useInput) {
+         ReplayInput(event);
+         return;
+      }
+      break;
+   default:
+      /* Other events were caused by JWM itself. */
+      break;
+   }
+   skipped += 1;
+}
+
+/** Replay input with XTest. */
+void ReplayInput(const XEvent *event)
+{
+#ifdef HAVE_XTEST
+   switch(event->type) {
+   case ButtonPress:
+   case ButtonRelease:
+      XTestFakeMotionEvent(display, -1, event->xbutton.x_root,
+                           event->xbutton.y_root, CurrentTime);
+      XTestFakeButtonEvent(display, event->xbutton.button,
+                           event->type == ButtonPress, CurrentTime);
+      break;
+   case MotionNotify:
+      XTestFakeMotionEvent(display, -1, event->xmotion.x_root,
+                           event->xmotion.y_root, CurrentTime);
+      break;
+   default:
+      XTestFakeKeyEvent(display, event->xkey.keycode,
+                        event->type == KeyPress, CurrentTime);
+      break;
+   }
+   replayed += 1;
+#else
+   skipped += 1;
+#endif
+}
+
+/** Display usage information. */
+void Usage(const char *name)
+{
+   printf("usage: %s [options] capture\n", name);
+   printf("  -d display   display for Xvfb (default :99)\n");
+   printf("  -f file      JWM configuration (default: the jwmbench one)\n");
+   printf("  -j path      JWM to run (default ../src/jwm)\n");
+   printf("  -n           do not replay input events\n");
+   printf("  -r           replay with the recorded timing\n");
+   printf("  -t ms        time to wait for JWM (default %.0f)\n",
+          DEFAULT_TIMEOUT);
+}
+
+int main(int argc, char *argv[])
+{
+   const char *displayName = ":99";
+   const char *wmPath = "../src/jwm";
+   const char *config = NULL;
+   const char *path = NULL;
+   char magic[sizeof(CAPTURE_MAGIC) - 1];
+   double start, elapsed, cpu;
+   int x, width, height, type;
+
+   for(x = 1; x < argc; x++) {
+      if(!strcmp(argv[x], "-d") && x + 1 < argc) {
+         displayName = argv[++x];
+      } else if(!strcmp(argv[x], "-f") && x + 1 < argc) {
+         config = argv[++x];
+      } else if(!strcmp(argv[x], "-j") && x + 1 < argc) {
+         wmPath = argv[++x];
+      } else if(!strcmp(argv[x], "-n")) {
+         useInput = 0;
+      } else if(!strcmp(argv[x], "-r")) {
+         realTime = 1;
+      } else if(!strcmp(argv[x], "-t") && x + 1 < argc) {
+         timeout = atof(argv[++x]);
+      } else if(argv[x][0] != '-' && !path) {
+         path = argv[x];
+      } else {
+         Usage(argv[0]);
+         return 1;
+      }
+   }
+   if(!path) {
+      Usage(argv[0]);
+      return 1;
+   }
+
+   input = fopen(path, "rb");
+   if(!input) {
+      fprintf(stderr, "could not open %s\n", path);
+      return 1;
+   }
+   if(fread(magic, sizeof(magic), 1, input) != 1
+      || memcmp(magic, CAPTURE_MAGIC, sizeof(magic))) {
+      fprintf(stderr, "%s is not a capture file\n", path);
+      return 1;
+   }
+   if(ReadValue() != (int)sizeof(XEvent)) {
+      fprintf(stderr, "%s was recorded on a different platform\n", path);
+      return 1;
+   }
+   width = ReadValue();
+   height = ReadValue();
+
+   StartHarness(displayName, wmPath, config);
+   XInternAtoms(display, (char**)WM_PROPERTIES, WM_PROPERTY_COUNT, False,
+                wmProperties);
+   netWMState = XInternAtom(display, "_NET_WM_STATE", False);
+#ifdef HAVE_XTEST
+   if(useInput) {
+      int eventBase, errorBase, major, minor;
+      if(!XTestQueryExtension(display, &eventBase, &errorBase,
+                              &major, &minor)) {
+         fprintf(stderr, "XTest is not available; input is skipped\n");
+         useInput = 0;
+      }
+   }
+#endif
+
+   printf("recorded on a %dx%d screen\n", width, height);
+   cpu = GetCPUTime(wmPid);
+   start = GetTime();
+   while((type = fgetc(input)) != EOF) {
+      switch(type) {
+      case CAPTURE_EVENT:
+         ReadEvent(start);
+         break;
+      case CAPTURE_ATOM:
+         ReadAtom();
+         break;
+      case CAPTURE_WINDOW:
+         ReadWindow();
+         break;
+      case CAPTURE_PROPERTY:
+         ReadProperty();
+         break;
+      default:
+         fprintf(stderr, "bad record in capture file\n");
+         StopHarness();
+         return 1;
+      }
+   }
+   fclose(input);
+
+   /* Wait for JWM to catch up. */
+   if(!Ping()) {
+      fprintf(stderr, "JWM did not respond within %.0f ms\n", timeout);
+   }
+   elapsed = GetTime() - start;
+   if(cpu >= 0.0) {
+      cpu = GetCPUTime(wmPid) - cpu;
+   }
+
+   printf("%lu events replayed, %lu skipped\n", replayed, skipped);
+   printf("%.1f ms elapsed, %.1f ms JWM CPU\n", elapsed, cpu);
+
+   StopHarness();
+   return 0;
+}
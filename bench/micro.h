@@ -0,0 +1,31 @@
+/**
+ * @file micro.h
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Header for the JWM microbenchmarks.
+ *
+ */
+
+#ifndef MICRO_H
+#define MICRO_H
+
+/** Number of clients for the placement benchmarks. */
+extern unsigned int benchClients;
+
+/** Size of the source icon for the icon benchmark. */
+extern unsigned int benchIconSize;
+
+/** Number of wrong results seen by the benchmarks. */
+extern unsigned int benchErrors;
+
+/** Tiled placement of a window among benchClients clients. */
+void RunTile(unsigned int count);
+
+/** Snapping a moving window to the borders of benchClients clients. */
+void RunSnap(unsigned int count);
+
+/** Scaling a benchIconSize icon to the sizes used by JWM. */
+void RunIconScale(unsigned int count);
+
+#endif /* MICRO_H */
@@ -0,0 +1,58 @@
+/**
+ * @file microicon.c
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Icon scaling microbenchmark.
+ *
+ */
+
+#include "../src/jwm.h"
+#include "../src/main.h"
+#include "../src/icon.h"
+#include "../src/misc.h"
+#include "../src/pool.h"
+#include "micro.h"
+
+/** Scaling a benchIconSize icon to the sizes used by JWM. */
+void RunIconScale(unsigned int count)
+{
+   static const int sizes[] = { 16, 20, 24, 32, 48 };
+   const unsigned int sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+   const unsigned int length = 2 + benchIconSize * benchIconSize;
+   unsigned long *data;
+   ScaledIconNode *np;
+   IconNode *icon;
+   unsigned int i;
+
+   data = Allocate(length * sizeof(unsigned long));
+   data[0] = benchIconSize;
+   data[1] = benchIconSize;
+   for(i = 2; i < length; i++) {
+      data[i] = 0xFF000000UL | ((i * 2654435761UL) & 0xFFFFFF);
+   }
+   icon = CreateIconFromBinary(data, length);
+   Release(data);
+   if(JUNLIKELY(!icon)) {
+      benchErrors += 1;
+      return;
+   }
+
+   /* Scale to each size in turn, discarding the result so that the next
+    * request is not found in the cache. */
+   for(i = 0; i < count; i++) {
+      const int size = sizes[i % sizeCount];
+      if(JUNLIKELY(!GetScaledIcon(icon, 0, size, size))) {
+         benchErrors += 1;
+      }
+      while(icon->nodes) {
+         np = icon->nodes->next;
+         JXFreePixmap(display, icon->nodes->image);
+         JXFreePixmap(display, icon->nodes->mask);
+         ReleaseObject(&scaledIconPool, icon->nodes);
+         icon->nodes = np;
+      }
+   }
+
+   DestroyIcon(icon);
+}
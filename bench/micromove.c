@@ -0,0 +1,34 @@
+/**
+ * @file micromove.c
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Snapping microbenchmark.
+ *
+ */
+
+#include "../src/jwm.h"
+#include "../src/main.h"
+#include "../src/client.h"
+#include "../src/move.h"
+#include "micro.h"
+
+/** Snapping a moving window to the borders of benchClients clients. */
+void RunSnap(unsigned int count)
+{
+   ClientNode client;
+   unsigned int i;
+
+   memset(&client, 0, sizeof(client));
+   client.state.border = BORDER_DEFAULT;
+   client.state.layer = LAYER_NORMAL;
+   client.state.status = STAT_MAPPED;
+   client.width = 400;
+   client.height = 300;
+
+   for(i = 0; i < count; i++) {
+      client.x = (i * 7919) % rootWidth;
+      client.y = (i * 6007) % rootHeight;
+      DoSnapBorder(&client);
+   }
+}
@@ -0,0 +1,39 @@
+/**
+ * @file microplace.c
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Placement microbenchmark.
+ *
+ */
+
+#include "../src/jwm.h"
+#include "../src/main.h"
+#include "../src/client.h"
+#include "../src/place.h"
+#include "micro.h"
+
+/** Tiled placement of a window among benchClients clients. */
+void RunTile(unsigned int count)
+{
+   ClientNode client;
+   BoundingBox box;
+   unsigned int i;
+
+   memset(&client, 0, sizeof(client));
+   client.state.border = BORDER_DEFAULT;
+   client.state.layer = LAYER_NORMAL;
+   client.xinc = 1;
+   client.yinc = 1;
+
+   box.x = 0;
+   box.y = 0;
+   box.width = rootWidth;
+   box.height = rootHeight;
+
+   for(i = 0; i < count; i++) {
+      client.width = 200 + (i * 37) % 200;
+      client.height = 150 + (i * 53) % 150;
+      TileClient(&box, &client);
+   }
+}
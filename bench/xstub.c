@@ -0,0 +1,1145 @@
+/**
+ * @file xstub.c
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Stub X layer for the microbenchmarks.
+ *
+ * This replaces the X functions that JWM calls through the JX macros.
+ * Calls are counted instead of being sent to a server. Requests succeed,
+ * resources get new IDs, and queries find nothing. Functions that do
+ * not need a server (XStringToKeysym, XReadBitmapFileData, XSync value
+ * arithmetic, etc.) are left to the X libraries.
+ *
+ */
+
+#include "../src/jwm.h"
+#include "xstub.h"
+
+/** Number of call counters (must be a power of two). */
+#define STUB_TABLE_SIZE 256
+
+/** Calls of one X function. */
+typedef struct StubCall {
+   const char *name;
+   unsigned long calls;
+} StubCall;
+
+static StubCall stubCalls[STUB_TABLE_SIZE];
+static unsigned long totalCalls = 0;
+static XID nextID = 0x00200000;
+
+static void CountCall(const char *name);
+static int CompareStubCalls(const void *a, const void *b);
+static int PutPixel(XImage *image, int x, int y, unsigned long pixel);
+static unsigned long GetPixel(XImage *image, int x, int y);
+static int DestroyImage(XImage *image);
+
+/** Count a call to an X function. */
+void CountCall(const char *name)
+{
+   unsigned int index = ((size_t)name >> 3) & (STUB_TABLE_SIZE - 1);
+   while(stubCalls[index].name && stubCalls[index].name != name) {
+      index = (index + 1) & (STUB_TABLE_SIZE - 1);
+   }
+   stubCalls[index].name = name;
+   stubCalls[index].calls += 1;
+   totalCalls += 1;
+}
+
+/** Reset the counts of X calls. */
+void ResetStubCalls(void)
+{
+   unsigned int x;
+   for(x = 0; x < STUB_TABLE_SIZE; x++) {
+      stubCalls[x].calls = 0;
+   }
+   totalCalls = 0;
+}
+
+/** Get the number of X calls since the last reset. */
+unsigned long GetStubCalls(void)
+{
+   return totalCalls;
+}
+
+/** Show the X calls made since the last reset. */
+void ShowStubCalls(void)
+{
+   StubCall list[STUB_TABLE_SIZE];
+   unsigned int x, count;
+
+   count = 0;
+   for(x = 0; x < STUB_TABLE_SIZE; x++) {
+      if(stubCalls[x].calls > 0) {
+         list[count++] = stubCalls[x];
+      }
+   }
+   qsort(list, count, sizeof(StubCall), CompareStubCalls);
+   for(x = 0; x < count; x++) {
+      printf("   %12lu  %s\n", list[x].calls, list[x].name);
+   }
+}
+
+/** Order calls by count, most first. */
+int CompareStubCalls(const void *a, const void *b)
+{
+   const StubCall *ca = (const StubCall*)a;
+   const StubCall *cb = (const StubCall*)b;
+   if(ca->calls != cb->calls) {
+      return ca->calls < cb->calls ? 1 : -1;
+   }
+   return strcmp(ca->name, cb->name);
+}
+
+/** Set a pixel of a stub image. */
+int PutPixel(XImage *image, int x, int y, unsigned long pixel)
+{
+   char *line = image->data + y * image->bytes_per_line;
+   if(image->bits_per_pixel == 1) {
+      if(pixel) {
+         line[x >> 3] |= 1 << (x & 7);
+      } else {
+         line[x >> 3] &= ~(1 << (x & 7));
+      }
+   } else {
+      ((unsigned int*)line)[x] = (unsigned int)pixel;
+   }
+   return 1;
+}
+
+/** Get a pixel of a stub image. */
+unsigned long GetPixel(XImage *image, int x, int y)
+{
+   const char *line = image->data + y * image->bytes_per_line;
+   if(image->bits_per_pixel == 1) {
+      return (line[x >> 3] >> (x & 7)) & 1;
+   } else {
+      return ((const unsigned int*)line)[x];
+   }
+}
+
+/** Destroy a stub image. */
+int DestroyImage(XImage *image)
+{
+   if(image->data) {
+      free(image->data);
+   }
+   free(image);
+   return 1;
+}
+
+/* The display. */
+
+Display *XOpenDisplay(_Xconst char *name)
+{
+   static Visual visual;
+   static Screen screen;
+   _XPrivDisplay dp;
+
+   CountCall("XOpenDisplay");
+   visual.visualid = ++nextID;
+   visual.class = TrueColor;
+   visual.red_mask = 0xFF0000;
+   visual.green_mask = 0x00FF00;
+   visual.blue_mask = 0x0000FF;
+   visual.bits_per_rgb = 8;
+   visual.map_entries = 256;
+
+   dp = calloc(1, sizeof(*dp));
+   screen.display = (Display*)dp;
+   screen.root = ++nextID;
+   screen.width = STUB_WIDTH;
+   screen.height = STUB_HEIGHT;
+   screen.root_depth = 24;
+   screen.root_visual = &visual;
+   screen.default_gc = XCreateGC((Display*)dp, screen.root, 0, NULL);
+   screen.cmap = ++nextID;
+   screen.white_pixel = 0xFFFFFF;
+   screen.black_pixel = 0;
+   screen.max_maps = 1;
+   screen.min_maps = 1;
+
+   dp->fd = -1;
+   dp->nscreens = 1;
+   dp->default_screen = 0;
+   dp->screens = &screen;
+   return (Display*)dp;
+}
+
+int XCloseDisplay(Display *d)
+{
+   CountCall("XCloseDisplay");
+   free(d);
+   return 0;
+}
+
+int XSync(Display *d, Bool discard)
+{
+   CountCall("XSync");
+   return 1;
+}
+
+int XFree(void *data)
+{
+   CountCall("XFree");
+   free(data);
+   return 1;
+}
+
+/* Events. */
+
+int XPending(Display *d)
+{
+   CountCall("XPending");
+   return 0;
+}
+
+int XNextEvent(Display *d, XEvent *event)
+{
+   CountCall("XNextEvent");
+   memset(event, 0, sizeof(XEvent));
+   return 0;
+}
+
+Bool XCheckMaskEvent(Display *d, long mask, XEvent *event)
+{
+   CountCall("XCheckMaskEvent");
+   return False;
+}
+
+Bool XCheckTypedEvent(Display *d, int type, XEvent *event)
+{
+   CountCall("XCheckTypedEvent");
+   return False;
+}
+
+Bool XCheckTypedWindowEvent(Display *d, Window w, int type, XEvent *event)
+{
+   CountCall("XCheckTypedWindowEvent");
+   return False;
+}
+
+Status XSendEvent(Display *d, Window w, Bool propagate, long mask,
+                  XEvent *event)
+{
+   CountCall("XSendEvent");
+   return 1;
+}
+
+int XSelectInput(Display *d, Window w, long mask)
+{
+   CountCall("XSelectInput");
+   return 1;
+}
+
+int XAllowEvents(Display *d, int mode, Time t)
+{
+   CountCall("XAllowEvents");
+   return 1;
+}
+
+/* Windows. */
+
+Window XCreateSimpleWindow(Display *d, Window parent, int x, int y,
+                           unsigned int width, unsigned int height,
+                           unsigned int border, unsigned long borderPixel,
+                           unsigned long background)
+{
+   CountCall("XCreateSimpleWindow");
+   return ++nextID;
+}
+
+Window XCreateWindow(Display *d, Window parent, int x, int y,
+                     unsigned int width, unsigned int height,
+                     unsigned int border, int depth, unsigned int cls,
+                     Visual *visual, unsigned long mask,
+                     XSetWindowAttributes *attr)
+{
+   CountCall("XCreateWindow");
+   return ++nextID;
+}
+
+int XDestroyWindow(Display *d, Window w)
+{
+   CountCall("XDestroyWindow");
+   return 1;
+}
+
+int XMapWindow(Display *d, Window w)
+{
+   CountCall("XMapWindow");
+   return 1;
+}
+
+int XMapRaised(Display *d, Window w)
+{
+   CountCall("XMapRaised");
+   return 1;
+}
+
+int XUnmapWindow(Display *d, Window w)
+{
+   CountCall("XUnmapWindow");
+   return 1;
+}
+
+int XRaiseWindow(Display *d, Window w)
+{
+   CountCall("XRaiseWindow");
+   return 1;
+}
+
+int XMoveWindow(Display *d, Window w, int x, int y)
+{
+   CountCall("XMoveWindow");
+   return 1;
+}
+
+int XResizeWindow(Display *d, Window w,
+                  unsigned int width, unsigned int height)
+{
+   CountCall("XResizeWindow");
+   return 1;
+}
+
+int XMoveResizeWindow(Display *d, Window w, int x, int y,
+                      unsigned int width, unsigned int height)
+{
+   CountCall("XMoveResizeWindow");
+   return 1;
+}
+
+int XConfigureWindow(Display *d, Window w, unsigned int mask,
+                     XWindowChanges *changes)
+{
+   CountCall("XConfigureWindow");
+   return 1;
+}
+
+int XReparentWindow(Display *d, Window w, Window parent, int x, int y)
+{
+   CountCall("XReparentWindow");
+   return 1;
+}
+
+int XChangeWindowAttributes(Display *d, Window w, unsigned long mask,
+                            XSetWindowAttributes *attr)
+{
+   CountCall("XChangeWindowAttributes");
+   return 1;
+}
+
+int XSetWindowBackground(Display *d, Window w, unsigned long pixel)
+{
+   CountCall("XSetWindowBackground");
+   return 1;
+}
+
+int XSetWindowBorder(Display *d, Window w, unsigned long pixel)
+{
+   CountCall("XSetWindowBorder");
+   return 1;
+}
+
+int XSetWindowBorderWidth(Display *d, Window w, unsigned int width)
+{
+   CountCall("XSetWindowBorderWidth");
+   return 1;
+}
+
+int XClearWindow(Display *d, Window w)
+{
+   CountCall("XClearWindow");
+   return 1;
+}
+
+int XClearArea(Display *d, Window w, int x, int y,
+               unsigned int width, unsigned int height, Bool exposures)
+{
+   CountCall("XClearArea");
+   return 1;
+}
+
+int XDefineCursor(Display *d, Window w, Cursor c)
+{
+   CountCall("XDefineCursor");
+   return 1;
+}
+
+int XAddToSaveSet(Display *d, Window w)
+{
+   CountCall("XAddToSaveSet");
+   return 1;
+}
+
+int XRemoveFromSaveSet(Display *d, Window w)
+{
+   CountCall("XRemoveFromSaveSet");
+   return 1;
+}
+
+int XKillClient(Display *d, XID resource)
+{
+   CountCall("XKillClient");
+   return 1;
+}
+
+int XSetInputFocus(Display *d, Window w, int revert, Time t)
+{
+   CountCall("XSetInputFocus");
+   return 1;
+}
+
+int XInstallColormap(Display *d, Colormap cmap)
+{
+   CountCall("XInstallColormap");
+   return 1;
+}
+
+int XStoreName(Display *d, Window w, _Xconst char *name)
+{
+   CountCall("XStoreName");
+   return 1;
+}
+
+int XSetIconSizes(Display *d, Window w, XIconSize *sizes, int count)
+{
+   CountCall("XSetIconSizes");
+   return 1;
+}
+
+void XSetWMNormalHints(Display *d, Window w, XSizeHints *hints)
+{
+   CountCall("XSetWMNormalHints");
+}
+
+Status XGetWindowAttributes(Display *d, Window w, XWindowAttributes *attr)
+{
+   CountCall("XGetWindowAttributes");
+   return 0;
+}
+
+Status XQueryTree(Display *d, Window w, Window *root, Window *parent,
+                  Window **children, unsigned int *count)
+{
+   CountCall("XQueryTree");
+   *root = RootWindow(d, 0);
+   *parent = *root;
+   *children = NULL;
+   *count = 0;
+   return 1;
+}
+
+Bool XQueryPointer(Display *d, Window w, Window *root, Window *child,
+                   int *rootx, int *rooty, int *winx, int *winy,
+                   unsigned int *mask)
+{
+   CountCall("XQueryPointer");
+   *root = RootWindow(d, 0);
+   *child = None;
+   *rootx = 0;
+   *rooty = 0;
+   *winx = 0;
+   *winy = 0;
+   *mask = 0;
+   return True;
+}
+
+int XWarpPointer(Display *d, Window src, Window dest, int srcx, int srcy,
+                 unsigned int width, unsigned int height,
+                 int destx, int desty)
+{
+   CountCall("XWarpPointer");
+   return 1;
+}
+
+/* Properties, atoms, and hints. */
+
+Atom XInternAtom(Display *d, _Xconst char *name, Bool onlyIfExists)
+{
+   CountCall("XInternAtom");
+   return ++nextID;
+}
+
+char *XGetAtomName(Display *d, Atom atom)
+{
+   char *name;
+   CountCall("XGetAtomName");
+   name = malloc(32);
+   snprintf(name, 32, "ATOM_%lu", (unsigned long)atom);
+   return name;
+}
+
+int XChangeProperty(Display *d, Window w, Atom property, Atom type,
+                    int format, int mode, _Xconst unsigned char *data,
+                    int count)
+{
+   CountCall("XChangeProperty");
+   return 1;
+}
+
+int XDeleteProperty(Display *d, Window w, Atom property)
+{
+   CountCall("XDeleteProperty");
+   return 1;
+}
+
+int XGetWindowProperty(Display *d, Window w, Atom property,
+                       long offset, long length, Bool remove, Atom reqType,
+                       Atom *type, int *format, unsigned long *count,
+                       unsigned long *extra, unsigned char **data)
+{
+   CountCall("XGetWindowProperty");
+   *type = None;
+   *format = 0;
+   *count = 0;
+   *extra = 0;
+   *data = NULL;
+   return Success;
+}
+
+Atom *XListProperties(Display *d, Window w, int *count)
+{
+   CountCall("XListProperties");
+   *count = 0;
+   return NULL;
+}
+
+Window XGetSelectionOwner(Display *d, Atom selection)
+{
+   CountCall("XGetSelectionOwner");
+   return None;
+}
+
+int XSetSelectionOwner(Display *d, Atom selection, Window owner, Time t)
+{
+   CountCall("XSetSelectionOwner");
+   return 1;
+}
+
+Status XFetchName(Display *d, Window w, char **name)
+{
+   CountCall("XFetchName");
+   *name = NULL;
+   return 0;
+}
+
+Status XGetClassHint(Display *d, Window w, XClassHint *hint)
+{
+   CountCall("XGetClassHint");
+   return 0;
+}
+
+Status XGetTransientForHint(Display *d, Window w, Window *owner)
+{
+   CountCall("XGetTransientForHint");
+   return 0;
+}
+
+Status XGetWMColormapWindows(Display *d, Window w, Window **windows,
+                             int *count)
+{
+   CountCall("XGetWMColormapWindows");
+   return 0;
+}
+
+XWMHints *XGetWMHints(Display *d, Window w)
+{
+   CountCall("XGetWMHints");
+   return NULL;
+}
+
+Status XGetWMNormalHints(Display *d, Window w, XSizeHints *hints,
+                         long *supplied)
+{
+   CountCall("XGetWMNormalHints");
+   return 0;
+}
+
+/* Context manager (it keeps its tables in the display). */
+
+int XSaveContext(Display *d, XID id, XContext context, _Xconst char *data)
+{
+   CountCall("XSaveContext");
+   return 0;
+}
+
+int XFindContext(Display *d, XID id, XContext context, XPointer *data)
+{
+   CountCall("XFindContext");
+   return XCNOENT;
+}
+
+int XDeleteContext(Display *d, XID id, XContext context)
+{
+   CountCall("XDeleteContext");
+   return 0;
+}
+
+/* Grabs and keyboard. */
+
+int XGrabServer(Display *d)
+{
+   CountCall("XGrabServer");
+   return 1;
+}
+
+int XUngrabServer(Display *d)
+{
+   CountCall("XUngrabServer");
+   return 1;
+}
+
+int XGrabPointer(Display *d, Window w, Bool ownerEvents, unsigned int mask,
+                 int pointerMode, int keyboardMode, Window confine,
+                 Cursor c, Time t)
+{
+   CountCall("XGrabPointer");
+   return GrabSuccess;
+}
+
+int XUngrabPointer(Display *d, Time t)
+{
+   CountCall("XUngrabPointer");
+   return 1;
+}
+
+int XGrabKeyboard(Display *d, Window w, Bool ownerEvents,
+                  int pointerMode, int keyboardMode, Time t)
+{
+   CountCall("XGrabKeyboard");
+   return GrabSuccess;
+}
+
+int XUngrabKeyboard(Display *d, Time t)
+{
+   CountCall("XUngrabKeyboard");
+   return 1;
+}
+
+int XGrabButton(Display *d, unsigned int button, unsigned int modifiers,
+                Window w, Bool ownerEvents, unsigned int mask,
+                int pointerMode, int keyboardMode, Window confine,
+                Cursor c)
+{
+   CountCall("XGrabButton");
+   return 1;
+}
+
+int XUngrabButton(Display *d, unsigned int button, unsigned int modifiers,
+                  Window w)
+{
+   CountCall("XUngrabButton");
+   return 1;
+}
+
+int XGrabKey(Display *d, int keycode, unsigned int modifiers, Window w,
+             Bool ownerEvents, int pointerMode, int keyboardMode)
+{
+   CountCall("XGrabKey");
+   return 1;
+}
+
+int XUngrabKey(Display *d, int keycode, unsigned int modifiers, Window w)
+{
+   CountCall("XUngrabKey");
+   return 1;
+}
+
+KeyCode XKeysymToKeycode(Display *d, KeySym sym)
+{
+   CountCall("XKeysymToKeycode");
+   return 0;
+}
+
+XModifierKeymap *XGetModifierMapping(Display *d)
+{
+   CountCall("XGetModifierMapping");
+   return calloc(1, sizeof(XModifierKeymap));
+}
+
+int XFreeModifiermap(XModifierKeymap *map)
+{
+   CountCall("XFreeModifiermap");
+   free(map);
+   return 1;
+}
+
+/* Colors and cursors. */
+
+Status XAllocColor(Display *d, Colormap cmap, XColor *c)
+{
+   CountCall("XAllocColor");
+   c->pixel = ((unsigned long)(c->red >> 8) << 16)
+            | ((unsigned long)(c->green >> 8) << 8)
+            | (unsigned long)(c->blue >> 8);
+   return 1;
+}
+
+int XQueryColor(Display *d, Colormap cmap, XColor *c)
+{
+   CountCall("XQueryColor");
+   c->red = ((c->pixel >> 16) & 0xFF) * 257;
+   c->green = ((c->pixel >> 8) & 0xFF) * 257;
+   c->blue = (c->pixel & 0xFF) * 257;
+   return 1;
+}
+
+Status XParseColor(Display *d, Colormap cmap, _Xconst char *spec, XColor *c)
+{
+   CountCall("XParseColor");
+   return 0;
+}
+
+int XFreeColors(Display *d, Colormap cmap, unsigned long *pixels,
+                int count, unsigned long planes)
+{
+   CountCall("XFreeColors");
+   return 1;
+}
+
+Cursor XCreateFontCursor(Display *d, unsigned int shape)
+{
+   CountCall("XCreateFontCursor");
+   return ++nextID;
+}
+
+int XFreeCursor(Display *d, Cursor c)
+{
+   CountCall("XFreeCursor");
+   return 1;
+}
+
+/* Graphics. */
+
+Pixmap XCreatePixmap(Display *d, Drawable drawable, unsigned int width,
+                     unsigned int height, unsigned int depth)
+{
+   CountCall("XCreatePixmap");
+   return ++nextID;
+}
+
+int XFreePixmap(Display *d, Pixmap p)
+{
+   CountCall("XFreePixmap");
+   return 1;
+}
+
+GC XCreateGC(Display *d, Drawable drawable, unsigned long mask,
+             XGCValues *values)
+{
+   CountCall("XCreateGC");
+   return (GC)calloc(1, sizeof(XGCValues) + sizeof(XID));
+}
+
+int XFreeGC(Display *d, GC gc)
+{
+   CountCall("XFreeGC");
+   free(gc);
+   return 1;
+}
+
+int XSetForeground(Display *d, GC gc, unsigned long pixel)
+{
+   CountCall("XSetForeground");
+   return 1;
+}
+
+int XSetLineAttributes(Display *d, GC gc, unsigned int width, int style,
+                       int cap, int join)
+{
+   CountCall("XSetLineAttributes");
+   return 1;
+}
+
+int XSetClipMask(Display *d, GC gc, Pixmap mask)
+{
+   CountCall("XSetClipMask");
+   return 1;
+}
+
+int XSetClipOrigin(Display *d, GC gc, int x, int y)
+{
+   CountCall("XSetClipOrigin");
+   return 1;
+}
+
+int XSetClipRectangles(Display *d, GC gc, int x, int y,
+                       XRectangle *rects, int count, int ordering)
+{
+   CountCall("XSetClipRectangles");
+   return 1;
+}
+
+int XCopyArea(Display *d, Drawable src, Drawable dest, GC gc,
+              int srcx, int srcy, unsigned int width, unsigned int height,
+              int destx, int desty)
+{
+   CountCall("XCopyArea");
+   return 1;
+}
+
+int XDrawLine(Display *d, Drawable drawable, GC gc,
+              int x1, int y1, int x2, int y2)
+{
+   CountCall("XDrawLine");
+   return 1;
+}
+
+int XDrawPoint(Display *d, Drawable drawable, GC gc, int x, int y)
+{
+   CountCall("XDrawPoint");
+   return 1;
+}
+
+int XDrawPoints(Display *d, Drawable drawable, GC gc, XPoint *points,
+                int count, int mode)
+{
+   CountCall("XDrawPoints");
+   return 1;
+}
+
+int XDrawSegments(Display *d, Drawable drawable, GC gc,
+                  XSegment *segments, int count)
+{
+   CountCall("XDrawSegments");
+   return 1;
+}
+
+int XDrawRectangle(Display *d, Drawable drawable, GC gc, int x, int y,
+                   unsigned int width, unsigned int height)
+{
+   CountCall("XDrawRectangle");
+   return 1;
+}
+
+int XFillRectangle(Display *d, Drawable drawable, GC gc, int x, int y,
+                   unsigned int width, unsigned int height)
+{
+   CountCall("XFillRectangle");
+   return 1;
+}
+
+int XFillRectangles(Display *d, Drawable drawable, GC gc,
+                    XRectangle *rects, int count)
+{
+   CountCall("XFillRectangles");
+   return 1;
+}
+
+int XDrawArcs(Display *d, Drawable drawable, GC gc, XArc *arcs, int count)
+{
+   CountCall("XDrawArcs");
+   return 1;
+}
+
+int XFillArcs(Display *d, Drawable drawable, GC gc, XArc *arcs, int count)
+{
+   CountCall("XFillArcs");
+   return 1;
+}
+
+XImage *XCreateImage(Display *d, Visual *visual, unsigned int depth,
+                     int format, int offset, char *data,
+                     unsigned int width, unsigned int height,
+                     int pad, int bytesPerLine)
+{
+   XImage *image;
+
+   CountCall("XCreateImage");
+   image = calloc(1, sizeof(XImage));
+   image->width = width;
+   image->height = height;
+   image->xoffset = offset;
+   image->format = format;
+   image->data = data;
+   image->depth = depth;
+   image->bitmap_pad = pad;
+   image->bits_per_pixel = depth == 1 ? 1 : 32;
+   image->bytes_per_line = bytesPerLine ? bytesPerLine
+                         : (width * image->bits_per_pixel + 7) / 8;
+   image->f.put_pixel = PutPixel;
+   image->f.get_pixel = GetPixel;
+   image->f.destroy_image = DestroyImage;
+   return image;
+}
+
+int XPutImage(Display *d, Drawable drawable, GC gc, XImage *image,
+              int srcx, int srcy, int destx, int desty,
+              unsigned int width, unsigned int height)
+{
+   CountCall("XPutImage");
+   return 1;
+}
+
+#ifndef USE_XFT
+
+XFontStruct *XLoadQueryFont(Display *d, _Xconst char *name)
+{
+   XFontStruct *font;
+   CountCall("XLoadQueryFont");
+   font = calloc(1, sizeof(XFontStruct));
+   font->fid = ++nextID;
+   font->max_char_or_byte2 = 255;
+   font->min_bounds.width = 7;
+   font->max_bounds.width = 7;
+   font->ascent = 12;
+   font->descent = 3;
+   return font;
+}
+
+int XFreeFont(Display *d, XFontStruct *font)
+{
+   CountCall("XFreeFont");
+   free(font);
+   return 1;
+}
+
+int XSetFont(Display *d, GC gc, Font font)
+{
+   CountCall("XSetFont");
+   return 1;
+}
+
+int XDrawString(Display *d, Drawable drawable, GC gc, int x, int y,
+                _Xconst char *str, int length)
+{
+   CountCall("XDrawString");
+   return 1;
+}
+
+#endif /* USE_XFT */
+
+#ifdef USE_SHAPE
+
+void XShapeCombineMask(Display *d, Window w, int kind, int x, int y,
+                       Pixmap mask, int op)
+{
+   CountCall("XShapeCombineMask");
+}
+
+XRectangle *XShapeGetRectangles(Display *d, Window w, int kind,
+                                int *count, int *ordering)
+{
+   CountCall("XShapeGetRectangles");
+   *count = 0;
+   *ordering = Unsorted;
+   return NULL;
+}
+
+Status XShapeQueryExtents(Display *d, Window w,
+                          Bool *bShaped, int *xbs, int *ybs,
+                          unsigned int *wbs, unsigned int *hbs,
+                          Bool *cShaped, int *xcs, int *ycs,
+                          unsigned int *wcs, unsigned int *hcs)
+{
+   CountCall("XShapeQueryExtents");
+   *bShaped = False;
+   *cShaped = False;
+   *xbs = *ybs = *xcs = *ycs = 0;
+   *wbs = *hbs = *wcs = *hcs = 0;
+   return 1;
+}
+
+void XShapeSelectInput(Display *d, Window w, unsigned long mask)
+{
+   CountCall("XShapeSelectInput");
+}
+
+#endif /* USE_SHAPE */
+
+#ifdef USE_XSYNC
+
+XSyncAlarm XSyncCreateAlarm(Display *d, unsigned long mask,
+                            XSyncAlarmAttributes *attr)
+{
+   CountCall("XSyncCreateAlarm");
+   return ++nextID;
+}
+
+Status XSyncChangeAlarm(Display *d, XSyncAlarm alarm, unsigned long mask,
+                        XSyncAlarmAttributes *attr)
+{
+   CountCall("XSyncChangeAlarm");
+   return 1;
+}
+
+Status XSyncDestroyAlarm(Display *d, XSyncAlarm alarm)
+{
+   CountCall("XSyncDestroyAlarm");
+   return 1;
+}
+
+Status XSyncQueryCounter(Display *d, XSyncCounter counter,
+                         XSyncValue *value)
+{
+   CountCall("XSyncQueryCounter");
+   return 0;
+}
+
+#endif /* USE_XSYNC */
+
+#ifdef USE_XINERAMA
+
+Bool XineramaIsActive(Display *d)
+{
+   CountCall("XineramaIsActive");
+   return False;
+}
+
+XineramaScreenInfo *XineramaQueryScreens(Display *d, int *count)
+{
+   CountCall("XineramaQueryScreens");
+   *count = 0;
+   return NULL;
+}
+
+#endif /* USE_XINERAMA */
+
+#ifdef USE_XRENDER
+
+XRenderPictFormat *XRenderFindStandardFormat(Display *d, int format)
+{
+   static XRenderPictFormat result;
+   CountCall("XRenderFindStandardFormat");
+   return &result;
+}
+
+XRenderPictFormat *XRenderFindVisualFormat(Display *d,
+                                           _Xconst Visual *visual)
+{
+   static XRenderPictFormat result;
+   CountCall("XRenderFindVisualFormat");
+   return &result;
+}
+
+Picture XRenderCreatePicture(Display *d, Drawable drawable,
+                             _Xconst XRenderPictFormat *format,
+                             unsigned long mask,
+                             _Xconst XRenderPictureAttributes *attr)
+{
+   CountCall("XRenderCreatePicture");
+   return ++nextID;
+}
+
+void XRenderFreePicture(Display *d, Picture picture)
+{
+   CountCall("XRenderFreePicture");
+}
+
+void XRenderComposite(Display *d, int op, Picture src, Picture mask,
+                      Picture dest, int srcx, int srcy, int maskx, int masky,
+                      int destx, int desty,
+                      unsigned int width, unsigned int height)
+{
+   CountCall("XRenderComposite");
+}
+
+void XRenderSetPictureFilter(Display *d, Picture picture,
+                             const char *filter, XFixed *params,
+                             int count)
+{
+   CountCall("XRenderSetPictureFilter");
+}
+
+void XRenderSetPictureTransform(Display *d, Picture picture,
+                                XTransform *transform)
+{
+   CountCall("XRenderSetPictureTransform");
+}
+
+#endif /* USE_XRENDER */
+
+#ifdef USE_XFT
+
+XftFont *XftFontOpenName(Display *d, int screen, _Xconst char *name)
+{
+   XftFont *font;
+   CountCall("XftFontOpenName");
+   font = calloc(1, sizeof(XftFont));
+   font->ascent = 12;
+   font->descent = 3;
+   font->height = 15;
+   font->max_advance_width = 7;
+   return font;
+}
+
+XftFont *XftFontOpenXlfd(Display *d, int screen, _Xconst char *xlfd)
+{
+   CountCall("XftFontOpenXlfd");
+   return NULL;
+}
+
+void XftFontClose(Display *d, XftFont *font)
+{
+   CountCall("XftFontClose");
+   free(font);
+}
+
+void XftTextExtentsUtf8(Display *d, XftFont *font,
+                        _Xconst FcChar8 *str, int length,
+                        XGlyphInfo *extents)
+{
+   int x, count;
+
+   CountCall("XftTextExtentsUtf8");
+
+   /* Every character is as wide as the widest. */
+   count = 0;
+   for(x = 0; x < length; x++) {
+      if((str[x] & 0xC0) != 0x80) {
+         count += 1;
+      }
+   }
+   memset(extents, 0, sizeof(XGlyphInfo));
+   extents->width = count * font->max_advance_width;
+   extents->height = font->height;
+   extents->xOff = extents->width;
+}
+
+XftDraw *XftDrawCreate(Display *d, Drawable drawable, Visual *visual,
+                       Colormap cmap)
+{
+   CountCall("XftDrawCreate");
+   return (XftDraw*)malloc(sizeof(Drawable));
+}
+
+void XftDrawDestroy(XftDraw *draw)
+{
+   CountCall("XftDrawDestroy");
+   free(draw);
+}
+
+Bool XftDrawSetClipRectangles(XftDraw *draw, int x, int y,
+                              _Xconst XRectangle *rects, int count)
+{
+   CountCall("XftDrawSetClipRectangles");
+   return True;
+}
+
+void XftDrawStringUtf8(XftDraw *draw, _Xconst XftColor *color,
+                       XftFont *font, int x, int y,
+                       _Xconst FcChar8 *str, int length)
+{
+   CountCall("XftDrawStringUtf8");
+}
+
+Bool XftColorAllocValue(Display *d, Visual *visual, Colormap cmap,
+                        _Xconst XRenderColor *color, XftColor *result)
+{
+   CountCall("XftColorAllocValue");
+   result->color = *color;
+   result->pixel = ((unsigned long)(color->red >> 8) << 16)
+                 | ((unsigned long)(color->green >> 8) << 8)
+                 | (unsigned long)(color->blue >> 8);
+   return True;
+}
+
+void XftColorFree(Display *d, Visual *visual, Colormap cmap,
+                  XftColor *color)
+{
+   CountCall("XftColorFree");
+}
+
+#endif /* USE_XFT */
@@ -0,0 +1,28 @@
+/**
+ * @file xstub.h
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Header for the stub X layer used by the microbenchmarks.
+ *
+ */
+
+#ifndef XSTUB_H
+#define XSTUB_H
+
+/** Width of the stub screen. */
+#define STUB_WIDTH   1920
+
+/** Height of the stub screen. */
+#define STUB_HEIGHT  1080
+
+/** Reset the counts of X calls. */
+void ResetStubCalls(void);
+
+/** Get the number of X calls since the last reset. */
+unsigned long GetStubCalls(void);
+
+/** Show the X calls made since the last reset, most frequent first. */
+void ShowStubCalls(void);
+
+#endif /* XSTUB_H */
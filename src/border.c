@@ -314,7 +314,9 @@ void DrawBorder(const ClientNode *np)
    }
 
    /* Do the actual drawing. */
+   BeginSpan("DrawBorder");
    DrawBorderHelper(np);
+   EndSpan();
 
 }
 
@@ -426,6 +428,7 @@ void DrawBorderHelper(const ClientNode *np)
                            settings.cornerRadius);
    }
 
+   ReleaseStringDrawable(canvas);
    JXFreePixmap(display, canvas);
    JXFreeGC(display, gc);
 
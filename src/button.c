@@ -129,13 +129,13 @@ void DrawButton(ButtonNode *bp)
    textWidth = 0;
    textHeight = 0;
    if(bp->text) {
-      textWidth = GetStringWidth(bp->font, bp->text);
-      textHeight = GetStringHeight(bp->font);
-      if(iconWidth > 0 && textWidth + iconWidth + 6 > width) {
+      if(iconWidth > 0) {
          textWidth = width - iconWidth - 6;
-      } else if(iconWidth == 0 && textWidth + 4 > width) {
+      } else {
          textWidth = width - 4;
       }
+      textWidth = GetFittedStringWidth(bp->font, bp->text, textWidth);
+      textHeight = GetStringHeight(bp->font);
       textWidth = textWidth < 0 ? 0 : textWidth;
    }
 
@@ -0,0 +1,235 @@
+/**
+ * @file capture.c
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Recording X events.
+ *
+ * When started with "-capture file", the events JWM receives are
+ * written to a file along with what is needed to recreate the clients
+ * that caused them: the geometry and properties of a window when it
+ * asks to be mapped, the new value of a property when it changes, and
+ * the names of the atoms used. bench/jwmreplay plays a capture back
+ * against Xvfb.
+ *
+ */
+
+#include "jwm.h"
+#include "capture.h"
+#include "client.h"
+#include "error.h"
+#include "hint.h"
+#include "main.h"
+
+static FILE *captureFile = NULL;
+static struct timeval captureStart;
+static Atom *capturedAtoms = NULL;
+static unsigned int capturedAtomCount = 0;
+static unsigned int capturedAtomMax = 0;
+
+static void WriteValue(long value);
+static void WriteAtom(Atom atom);
+static void WriteWindow(Window w);
+static void WriteProperty(Window w, Atom atom);
+static void WriteProperties(Window w);
+
+/** Start recording events. */
+void OpenCapture(const char *path)
+{
+   captureFile = fopen(path, "wb");
+   if(JUNLIKELY(!captureFile)) {
+      Warning(_("could not open %s for writing"), path);
+      return;
+   }
+   gettimeofday(&captureStart, NULL);
+   fwrite(CAPTURE_MAGIC, 1, sizeof(CAPTURE_MAGIC) - 1, captureFile);
+   WriteValue(sizeof(XEvent));
+   WriteValue(rootWidth);
+   WriteValue(rootHeight);
+}
+
+/** Stop recording events. */
+void CloseCapture(void)
+{
+   if(captureFile) {
+      fclose(captureFile);
+      captureFile = NULL;
+   }
+   if(capturedAtoms) {
+      Release(capturedAtoms);
+      capturedAtoms = NULL;
+      capturedAtomCount = 0;
+      capturedAtomMax = 0;
+   }
+}
+
+/** Record an event received from the X server. */
+void CaptureEvent(const XEvent *event)
+{
+   struct timeval now;
+   long flags = 0;
+   ClientNode *np;
+
+   if(JLIKELY(!captureFile)) {
+      return;
+   }
+
+   /* Write what is needed to play the event back. */
+   switch(event->type) {
+   case MapRequest:
+      WriteWindow(event->xmaprequest.window);
+      WriteProperties(event->xmaprequest.window);
+      break;
+   case PropertyNotify:
+      if(event->xproperty.window != rootWindow) {
+         WriteProperty(event->xproperty.window, event->xproperty.atom);
+      }
+      break;
+   case ClientMessage:
+      WriteAtom(event->xclient.message_type);
+      if(event->xclient.message_type == atoms[ATOM_NET_WM_STATE]) {
+         WriteAtom(event->xclient.data.l[1]);
+         WriteAtom(event->xclient.data.l[2]);
+      }
+      break;
+   case UnmapNotify:
+      np = FindClientByWindow(event->xunmap.window);
+      if(np && ((np->state.status & STAT_MAPPED)
+         || event->xunmap.send_event)) {
+         flags |= CAPTURE_WITHDRAW;
+      }
+      break;
+   default:
+      break;
+   }
+
+   gettimeofday(&now, NULL);
+   if(now.tv_usec < captureStart.tv_usec) {
+      now.tv_usec += 1000000;
+      now.tv_sec -= 1;
+   }
+   fputc(CAPTURE_EVENT, captureFile);
+   WriteValue(now.tv_sec - captureStart.tv_sec);
+   WriteValue(now.tv_usec - captureStart.tv_usec);
+   WriteValue(flags);
+   fwrite(event, sizeof(XEvent), 1, captureFile);
+}
+
+/** Write a 32-bit value. */
+void WriteValue(long value)
+{
+   const unsigned int temp = (unsigned int)value;
+   fwrite(&temp, sizeof(temp), 1, captureFile);
+}
+
+/** Write the name of an atom if it has not been written. */
+void WriteAtom(Atom atom)
+{
+   char *name;
+   unsigned int x;
+   size_t len;
+
+   if(atom == None) {
+      return;
+   }
+   for(x = 0; x < capturedAtomCount; x++) {
+      if(capturedAtoms[x] == atom) {
+         return;
+      }
+   }
+
+   name = JXGetAtomName(display, atom);
+   if(JUNLIKELY(!name)) {
+      return;
+   }
+   if(capturedAtomCount == capturedAtomMax) {
+      capturedAtomMax = capturedAtomMax ? capturedAtomMax * 2 : 64;
+      capturedAtoms = Reallocate(capturedAtoms,
+                                 capturedAtomMax * sizeof(Atom));
+   }
+   capturedAtoms[capturedAtomCount++] = atom;
+
+   len = strlen(name);
+   fputc(CAPTURE_ATOM, captureFile);
+   WriteValue(atom);
+   WriteValue(len);
+   fwrite(name, 1, len, captureFile);
+   JXFree(name);
+}
+
+/** Write the geometry of a window. */
+void WriteWindow(Window w)
+{
+   XWindowAttributes attr;
+   if(JXGetWindowAttributes(display, w, &attr)) {
+      fputc(CAPTURE_WINDOW, captureFile);
+      WriteValue(w);
+      WriteValue(attr.x);
+      WriteValue(attr.y);
+      WriteValue(attr.width);
+      WriteValue(attr.height);
+      WriteValue(attr.border_width);
+   }
+}
+
+/** Write the current value of a property (or that it was deleted). */
+void WriteProperty(Window w, Atom atom)
+{
+   unsigned char *data = NULL;
+   unsigned long count, extra, x;
+   Atom type = None;
+   int format = 0;
+   int status;
+
+   status = JXGetWindowProperty(display, w, atom, 0, 1 << 20, False,
+                                AnyPropertyType, &type, &format,
+                                &count, &extra, &data);
+   if(status != Success || type == None) {
+      count = 0;
+      format = 0;
+      type = None;
+   }
+
+   WriteAtom(atom);
+   WriteAtom(type);
+   if(type == XA_ATOM && format == 32) {
+      for(x = 0; x < count; x++) {
+         WriteAtom(((Atom*)data)[x]);
+      }
+   }
+
+   fputc(CAPTURE_PROPERTY, captureFile);
+   WriteValue(w);
+   WriteValue(atom);
+   WriteValue(type);
+   WriteValue(format);
+   WriteValue(count);
+   if(format == 32) {
+      for(x = 0; x < count; x++) {
+         WriteValue(((long*)data)[x]);
+      }
+   } else if(format == 16) {
+      fwrite(data, 2, count, captureFile);
+   } else if(format == 8) {
+      fwrite(data, 1, count, captureFile);
+   }
+
+   if(data) {
+      JXFree(data);
+   }
+}
+
+/** Write all properties of a window. */
+void WriteProperties(Window w)
+{
+   Atom *list;
+   int count, x;
+
+   list = JXListProperties(display, w, &count);
+   if(list) {
+      for(x = 0; x < count; x++) {
+         WriteProperty(w, list[x]);
+      }
+      JXFree(list);
+   }
+}
@@ -0,0 +1,51 @@
+/**
+ * @file capture.h
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Header for recording X events.
+ *
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+/** Capture file identification. */
+#define CAPTURE_MAGIC      "JWMCAP1\n"
+
+/** Record types in a capture file.
+ * Each record starts with a byte giving its type. All other values are
+ * 32-bit integers in host byte order, as follows:
+ *   CAPTURE_EVENT:    seconds, microseconds, flags, then the XEvent
+ *   CAPTURE_ATOM:     atom, name length, then the name
+ *   CAPTURE_WINDOW:   window, x, y, width, height, border width
+ *   CAPTURE_PROPERTY: window, atom, type, format, item count,
+ *                     then the items (format 32 items are 32 bits)
+ * The file starts with CAPTURE_MAGIC, sizeof(XEvent), and the size of
+ * the root window.
+ */
+typedef enum {
+   CAPTURE_EVENT     = 1,
+   CAPTURE_ATOM      = 2,
+   CAPTURE_WINDOW    = 3,
+   CAPTURE_PROPERTY  = 4
+} CaptureRecordType;
+
+/** Flags for a captured event. */
+#define CAPTURE_WITHDRAW   1  /**< UnmapNotify that withdraws a client. */
+
+/** Start recording events.
+ * @param path The file to which events are written.
+ */
+void OpenCapture(const char *path);
+
+/** Stop recording events. */
+void CloseCapture(void);
+
+/** Record an event received from the X server.
+ * This does nothing unless recording was started.
+ * @param event The event.
+ */
+void CaptureEvent(const XEvent *event);
+
+#endif /* CAPTURE_H */
@@ -25,17 +25,41 @@
 #include "settings.h"
 #include "timing.h"
 #include "grab.h"
+#include "pool.h"
 
 static ClientNode *activeClient;
 
+/* Client nodes are reused since some windows come and go constantly. */
+static ObjectPool clientPool = OBJECT_POOL("clients", ClientNode);
+
 unsigned int clientCount;
 
+/* The stacking order last sent to the X server (top to bottom). */
+static Window *stacking = NULL;
+static unsigned int stackingCount = 0;
+static unsigned int stackingSize = 0;
+
+/** A window in the old stacking order, for looking up its position. */
+typedef struct StackEntry {
+   Window window;
+   unsigned int position;
+} StackEntry;
+
+/* Clients with the urgency hint share a single timer. */
+static unsigned int urgentCount = 0;
+static char urgentPhase = 0;
+
 static void LoadFocus(void);
+static void ApplyStacking(const Window *stack, unsigned int count);
+static int CompareStackEntries(const void *a, const void *b);
+static void RemoveStacking(Window w);
 static void ReparentClient(ClientNode *np, char notOwner);
 static void MinimizeTransients(ClientNode *np, char lower);
 static void RestoreTransients(ClientNode *np, char raise);
 static void KillClientHandler(ClientNode *np);
 static void UnmapClient(ClientNode *np);
+static void SignalUrgent(const TimeType *now, int x, int y, Window w,
+                         void *data);
 
 /** Load windows that are already mapped. */
 void StartupClients(void)
@@ -49,6 +73,7 @@ void StartupClients(void)
    clientCount = 0;
    activeClient = NULL;
    currentDesktop = 0;
+   stackingCount = 0;
 
    /* Clear out the client lists. */
    for(x = 0; x < LAYER_COUNT; x++) {
@@ -90,6 +115,13 @@ void ShutdownClients(void)
       }
    }
 
+   if(stacking) {
+      Release(stacking);
+      stacking = NULL;
+   }
+   stackingCount = 0;
+   stackingSize = 0;
+
 }
 
 /** Set the focus to the window currently under the mouse pointer. */
@@ -134,8 +166,10 @@ ClientNode *AddClientWindow(Window w, char alreadyMapped, char notOwner)
       return NULL;
    }
 
+   BeginSpan("AddClientWindow");
+
    /* Prepare a client node for this window. */
-   np = Allocate(sizeof(ClientNode));
+   np = AllocateObject(&clientPool);
    memset(np, 0, sizeof(ClientNode));
 
    np->window = w;
@@ -240,9 +274,7 @@ ClientNode *AddClientWindow(Window w, char alreadyMapped, char notOwner)
       MaximizeClient(np, hmax, vmax);
    }
 
-   if(np->state.status & STAT_URGENT) {
-      RegisterCallback(URGENCY_DELAY, SignalUrgent, np);
-   }
+   AddUrgentClient(np);
 
    /* Update task bars. */
    AddClientToTaskBar(np);
@@ -273,6 +305,7 @@ ClientNode *AddClientWindow(Window w, char alreadyMapped, char notOwner)
    }
    ResetBorder(np);
 
+   EndSpan();
    return np;
 
 }
@@ -1068,6 +1101,8 @@ void RestackClients(void)
       return;
    }
 
+   BeginSpan("RestackClients");
+
    /* Allocate memory for restacking. */
    trayCount = GetTrayCount();
    stack = AllocateStack((clientCount + trayCount) * sizeof(Window));
@@ -1114,12 +1149,161 @@ void RestackClients(void)
 
    }
 
-   JXRestackWindows(display, stack, index);
+   ApplyStacking(stack, index);
 
    ReleaseStack(stack);
    UpdateNetClientList();
    UpdatePager();
 
+   EndSpan();
+
+}
+
+/** Send a new stacking order to the X server.
+ * Windows that kept their relative order since the last call are left
+ * alone; the rest are placed below their new upper neighbor. The
+ * windows left alone are a longest increasing subsequence of the old
+ * positions, so the fewest windows possible are restacked.
+ */
+void ApplyStacking(const Window *stack, unsigned int count)
+{
+
+   XWindowChanges changes;
+   StackEntry *entries;
+   unsigned int *position;
+   unsigned int *tails;
+   unsigned int *links;
+   char *fixed;
+   unsigned int length, first;
+   unsigned int i, j;
+
+   if(count == stackingCount
+      && (count == 0 || !memcmp(stack, stacking, count * sizeof(Window)))) {
+      return;
+   }
+
+   position = AllocateStack(count * sizeof(unsigned int));
+   tails = AllocateStack(count * sizeof(unsigned int));
+   links = AllocateStack(count * sizeof(unsigned int));
+   fixed = AllocateStack(count);
+
+   /* Find the old position of each window (UINT_MAX if new). */
+   entries = AllocateStack((stackingCount + 1) * sizeof(StackEntry));
+   for(j = 0; j < stackingCount; j++) {
+      entries[j].window = stacking[j];
+      entries[j].position = j;
+   }
+   qsort(entries, stackingCount, sizeof(StackEntry), CompareStackEntries);
+   for(i = 0; i < count; i++) {
+      StackEntry key;
+      const StackEntry *ep;
+      key.window = stack[i];
+      ep = bsearch(&key, entries, stackingCount, sizeof(StackEntry),
+                   CompareStackEntries);
+      position[i] = ep ? ep->position : UINT_MAX;
+      fixed[i] = 0;
+   }
+   ReleaseStack(entries);
+
+   /* Find the longest run of windows still in the same order. */
+   length = 0;
+   for(i = 0; i < count; i++) {
+      unsigned int low, high;
+      if(position[i] == UINT_MAX) {
+         continue;
+      }
+      low = 0;
+      high = length;
+      while(low < high) {
+         const unsigned int mid = (low + high) / 2;
+         if(position[tails[mid]] < position[i]) {
+            low = mid + 1;
+         } else {
+            high = mid;
+         }
+      }
+      links[i] = low > 0 ? tails[low - 1] : UINT_MAX;
+      tails[low] = i;
+      if(low == length) {
+         length += 1;
+      }
+   }
+   if(length > 0) {
+      for(i = tails[length - 1]; i != UINT_MAX; i = links[i]) {
+         fixed[i] = 1;
+      }
+   }
+
+   /* Restack everything else relative to the first window left alone
+    * (or the top window if every window moved). */
+   for(first = 0; first < count && !fixed[first]; first++);
+   if(first == count) {
+      first = 0;
+   }
+   changes.stack_mode = Above;
+   for(i = first; i > 0; i--) {
+      changes.sibling = stack[i];
+      JXConfigureWindow(display, stack[i - 1], CWSibling | CWStackMode,
+                        &changes);
+   }
+   changes.stack_mode = Below;
+   for(i = first + 1; i < count; i++) {
+      if(!fixed[i]) {
+         changes.sibling = stack[i - 1];
+         JXConfigureWindow(display, stack[i], CWSibling | CWStackMode,
+                           &changes);
+      }
+   }
+
+   ReleaseStack(fixed);
+   ReleaseStack(links);
+   ReleaseStack(tails);
+   ReleaseStack(position);
+
+   /* Remember the new order. */
+   if(count > stackingSize) {
+      stackingSize = count;
+      if(stacking) {
+         stacking = Reallocate(stacking, stackingSize * sizeof(Window));
+      } else {
+         stacking = Allocate(stackingSize * sizeof(Window));
+      }
+   }
+   memcpy(stacking, stack, count * sizeof(Window));
+   stackingCount = count;
+
+}
+
+/** Order stack entries by window. */
+int CompareStackEntries(const void *a, const void *b)
+{
+   const Window wa = ((const StackEntry*)a)->window;
+   const Window wb = ((const StackEntry*)b)->window;
+   return wa < wb ? -1 : (wa > wb ? 1 : 0);
+}
+
+/** Remove a window that is about to be destroyed from the stacking order.
+ * This keeps a recycled window ID from being taken for the old window.
+ */
+void RemoveStacking(Window w)
+{
+   unsigned int x;
+   for(x = 0; x < stackingCount; x++) {
+      if(stacking[x] == w) {
+         stackingCount -= 1;
+         memmove(&stacking[x], &stacking[x + 1],
+                 (stackingCount - x) * sizeof(Window));
+         break;
+      }
+   }
+}
+
+/** Forget the stacking order sent to the X server.
+ * This must be called when a managed window is restacked directly.
+ */
+void InvalidateStacking(void)
+{
+   stackingCount = 0;
 }
 
 /** Send a client message to a window. */
@@ -1169,9 +1353,7 @@ void RemoveClient(ClientNode *np)
    XDeleteContext(display, np->window, clientContext);
    XDeleteContext(display, np->parent, frameContext);
 
-   if(np->state.status & STAT_URGENT) {
-      UnregisterCallback(SignalUrgent, np);
-   }
+   RemoveUrgentClient(np);
 
    /* Make sure this client isn't active */
    if(activeClient == np && !shouldExit) {
@@ -1209,6 +1391,7 @@ void RemoveClient(ClientNode *np)
 
    /* Destroy the parent */
    if(np->parent) {
+      RemoveStacking(np->parent);
       JXDestroyWindow(display, np->parent);
    }
 
@@ -1233,7 +1416,7 @@ void RemoveClient(ClientNode *np)
 
    DestroyIcon(np->icon);
 
-   Release(np);
+   ReleaseObject(&clientPool, np);
 
    RestackClients();
 
@@ -1441,21 +1624,64 @@ void UpdateClientColormap(ClientNode *np)
 
 }
 
-/** Update callback for clients with the urgency hint set. */
+/** Start flashing a client if it has the urgency hint set. */
+void AddUrgentClient(ClientNode *np)
+{
+   if(np->state.status & STAT_URGENT) {
+      urgentCount += 1;
+      if(urgentCount == 1) {
+         urgentPhase = 0;
+         RegisterCallback(URGENCY_DELAY, SignalUrgent, NULL);
+      }
+   }
+}
+
+/** Stop flashing a client if it has the urgency hint set. */
+void RemoveUrgentClient(ClientNode *np)
+{
+   if(np->state.status & STAT_URGENT) {
+      Assert(urgentCount > 0);
+      urgentCount -= 1;
+      if(urgentCount == 0) {
+         UnregisterCallback(SignalUrgent, NULL);
+      }
+   }
+}
+
+/** Update callback for clients with the urgency hint set.
+ * All urgent clients flash together, so only one timer is needed and
+ * only the urgent clients are redrawn.
+ */
 void SignalUrgent(const TimeType *now, int x, int y, Window w, void *data)
 {
 
-   ClientNode *np = (ClientNode*)data;
+   ClientNode *np;
+   char changed = 0;
+   int layer;
 
-   /* Redraw borders. */
-   if(np->state.status & STAT_FLASH) {
-      np->state.status &= ~STAT_FLASH;
-   } else if(!(np->state.status & STAT_NOTURGENT)) {
-      np->state.status |= STAT_FLASH;
+   urgentPhase = !urgentPhase;
+   for(layer = FIRST_LAYER; layer <= LAST_LAYER; layer++) {
+      for(np = nodes[layer]; np; np = np->next) {
+         const unsigned int old = np->state.status;
+         if(!(old & STAT_URGENT)) {
+            continue;
+         }
+         if(urgentPhase && !(old & STAT_NOTURGENT)) {
+            np->state.status |= STAT_FLASH;
+         } else {
+            np->state.status &= ~STAT_FLASH;
+         }
+         if(np->state.status != old) {
+            DrawBorder(np);
+            changed = 1;
+         }
+      }
+   }
+
+   if(changed) {
+      FlashTaskBar();
+      FlashPager();
    }
-   DrawBorder(np);
-   UpdateTaskBar();
-   UpdatePager();
 
 }
 
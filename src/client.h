@@ -79,6 +79,7 @@ typedef unsigned int StatusFlags;
 #define STAT_NOPAGER    (1 << 23)   /**< Don't show in pager. */
 #define STAT_SHAPED     (1 << 24)   /**< This window is shaped. */
 #define STAT_FLASH      (1 << 25)   /**< Flashing for urgency. */
+#define STAT_SYNC       (1 << 26)   /**< Client uses _NET_WM_SYNC_REQUEST. */
 
 /** Colormap window linked list. */
 typedef struct ColormapNode {
@@ -274,6 +275,11 @@ void RestackClient(ClientNode *np, Window above, int detail);
  */
 void RestackClients(void);
 
+/** Forget the stacking order last sent to the X server.
+ * The next call to RestackClients will restack every window.
+ */
+void InvalidateStacking(void);
+
 /** Set the layer of a client.
  * @param np The client whose layer to set.
  * @param layer the layer to assign to the client.
@@ -323,9 +329,16 @@ void SendConfigureEvent(ClientNode *np);
  */
 void SendClientMessage(Window w, AtomType type, AtomType message);
 
-/** Update callback for clients with the urgency hint set. */
-void SignalUrgent(const struct TimeType *now, int x, int y, Window w,
-                  void *data);
+/** Start flashing a client if it has the urgency hint set.
+ * @param np The client.
+ */
+void AddUrgentClient(ClientNode *np);
+
+/** Stop flashing a client if it has the urgency hint set.
+ * This must be called before the urgency hint of the client changes.
+ * @param np The client.
+ */
+void RemoveUrgentClient(ClientNode *np);
 
 #endif /* CLIENT_H */
 
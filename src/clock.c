@@ -30,11 +30,12 @@ typedef struct ClockType {
    char *zone;              /**< The time zone to use (NULL = local). */
    char *command;           /**< A command to run when clicked. */
    char shortTime[80];      /**< Currently displayed time. */
+   int period;              /**< Seconds between label changes (1 or 60). */
 
-   /* The following are used to control popups. */
-   int mousex;              /**< Last mouse x-coordinate. */
-   int mousey;              /**< Last mouse y-coordinate. */
-   TimeType mouseTime;      /**< Time of the last mouse motion. */
+   /* The following are used to update popups. */
+   char popupShown;         /**< Set while the popup may be shown. */
+   int popupx;              /**< Mouse x-coordinate for the popup. */
+   int popupy;              /**< Mouse y-coordinate for the popup. */
 
    int userWidth;           /**< User-specified clock width (or 0). */
 
@@ -52,13 +53,14 @@ static void Resize(TrayComponentType *cp);
 static void Destroy(TrayComponentType *cp);
 static void ProcessClockButtonEvent(TrayComponentType *cp,
                                     int x, int y, int mask);
-static void ProcessClockMotionEvent(TrayComponentType *cp,
-                                    int x, int y, int mask);
+static void ShowClockPopup(TrayComponentType *cp, int x, int y);
 
 static void DrawClock(ClockType *clk, const TimeType *now, int x, int y);
 
 static void SignalClock(const struct TimeType *now, int x, int y, Window w,
                         void *data);
+static int GetClockPeriod(const char *format);
+static int GetClockDelay(const ClockType *clk, const TimeType *now);
 
 
 /** Initialize clocks. */
@@ -107,6 +109,7 @@ void DestroyClock(void)
       Release(clocks);
       clocks = cp;
    }
+   ReleaseTimeZones();
 
 }
 
@@ -122,16 +125,14 @@ TrayComponentType *CreateClock(const char *format, const char *zone,
    clk->next = clocks;
    clocks = clk;
 
-   clk->mousex = -settings.doubleClickDelta;
-   clk->mousey = -settings.doubleClickDelta;
-   clk->mouseTime.seconds = 0;
-   clk->mouseTime.ms = 0;
+   clk->popupShown = 0;
    clk->userWidth = 0;
 
    if(!format) {
       format = DEFAULT_FORMAT;
    }
    clk->format = CopyString(format);
+   clk->period = GetClockPeriod(format);
 
    clk->zone = CopyString(zone);
 
@@ -155,9 +156,9 @@ TrayComponentType *CreateClock(const char *format, const char *zone,
    cp->Resize = Resize;
    cp->Destroy = Destroy;
    cp->ProcessButtonPress = ProcessClockButtonEvent;
-   cp->ProcessMotionEvent = ProcessClockMotionEvent;
+   cp->ShowPopup = ShowClockPopup;
 
-   RegisterCallback(Min(900, settings.popupDelay / 2), SignalClock, clk);
+   RegisterCallback(900, SignalClock, clk);
 
    return cp;
 
@@ -190,6 +191,7 @@ void Resize(TrayComponentType *cp)
    Assert(clk);
 
    if(cp->pixmap != None) {
+      ReleaseStringDrawable(cp->pixmap);
       JXFreePixmap(display, cp->pixmap);
    }
 
@@ -209,6 +211,7 @@ void Destroy(TrayComponentType *cp)
 {
    Assert(cp);
    if(cp->pixmap != None) {
+      ReleaseStringDrawable(cp->pixmap);
       JXFreePixmap(display, cp->pixmap);
    }
 }
@@ -231,19 +234,25 @@ void ProcessClockButtonEvent(TrayComponentType *cp, int x, int y, int mask)
 
 }
 
-/** Process a motion event on a clock tray component. */
-void ProcessClockMotionEvent(TrayComponentType *cp,
-                             int x, int y, int mask)
+/** Show the popup for a clock tray component. */
+void ShowClockPopup(TrayComponentType *cp, int x, int y)
 {
 
    ClockType *clk;
+   TimeType now;
 
    Assert(cp);
 
    clk = (ClockType*)cp->object;
-   clk->mousex = cp->screenx + x;
-   clk->mousey = cp->screeny + y;
-   GetCurrentTime(&clk->mouseTime);
+   clk->popupShown = 1;
+   clk->popupx = cp->screenx + x;
+   clk->popupy = cp->screeny + y;
+   ShowPopup(clk->popupx, clk->popupy, GetTimeString("%c", clk->zone));
+
+   /* Wake up in time to update the popup. */
+   GetCurrentTime(&now);
+   SetCallbackDelay(SignalClock, clk,
+                    Min(GetClockDelay(clk, &now), 1010 - now.ms));
 
 }
 
@@ -252,18 +261,25 @@ void SignalClock(const TimeType *now, int x, int y, Window w, void *data)
 {
 
    ClockType *cp = (ClockType*)data;
-   const char *longTime;
+   int delay;
 
    DrawClock(cp, now, x, y);
-   if(cp->cp->tray->window == w &&
-      abs(cp->mousex - x) < settings.doubleClickDelta &&
-      abs(cp->mousey - y) < settings.doubleClickDelta) {
-      if(GetTimeDifference(now, &cp->mouseTime) >= settings.popupDelay) {
-         longTime = GetTimeString("%c", cp->zone);
-         ShowPopup(x, y, longTime);
+   delay = GetClockDelay(cp, now);
+
+   /* Update the popup until the mouse moves. */
+   if(cp->popupShown) {
+      if(cp->cp->tray->window == w
+         && cp->popupx == x && cp->popupy == y) {
+         ShowPopup(x, y, GetTimeString("%c", cp->zone));
+         delay = Min(delay, 1010 - now->ms);
+      } else {
+         cp->popupShown = 0;
       }
    }
 
+   /* Sleep until the label or the popup needs to change. */
+   SetCallbackDelay(SignalClock, cp, delay);
+
 }
 
 /** Draw a clock tray component. */
@@ -321,3 +337,31 @@ void DrawClock(ClockType *clk, const TimeType *now, int x, int y)
 
 }
 
+/** Determine how often the output of a clock format changes.
+ * @return 1 if the format shows seconds, 60 otherwise.
+ */
+int GetClockPeriod(const char *format)
+{
+   while(*format) {
+      if(*format++ == '%') {
+         if(*format == 'E' || *format == 'O') {
+            format += 1;
+         }
+         if(*format && strchr("sSTrcX+", *format)) {
+            return 1;
+         }
+         if(*format) {
+            format += 1;
+         }
+      }
+   }
+   return 60;
+}
+
+/** Get the time in milliseconds until the clock label may change. */
+int GetClockDelay(const ClockType *clk, const TimeType *now)
+{
+   /* Wake a little after the boundary so the new time is visible. */
+   const int seconds = clk->period - now->seconds % clk->period;
+   return seconds * 1000 - now->ms + 10;
+}
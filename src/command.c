@@ -19,6 +19,13 @@ typedef struct CommandNode {
    struct CommandNode *next;  /**< The next command in the list. */
 } CommandNode;
 
+/** Characters that require a command to be run by the shell. */
+static const char *SHELL_CHARS = "|&;<>()$`\\\"'*?[]#~={}%!\n";
+
+#ifdef HAVE_POSIX_SPAWN
+extern char **environ;
+#endif
+
 static CommandNode *startupCommands = NULL;
 static CommandNode *shutdownCommands = NULL;
 static CommandNode *restartCommands = NULL;
@@ -26,6 +33,8 @@ static CommandNode *restartCommands = NULL;
 static void RunCommands(CommandNode *commands);
 static void ReleaseCommands(CommandNode **commands);
 static void AddCommand(CommandNode **commands, const char *command);
+static char **GetCommandArguments(const char *command);
+static pid_t SpawnCommand(const char *command, int outputFd);
 
 /** Process startup/restart commands. */
 void StartupCommands(void)
@@ -117,26 +126,186 @@ void AddRestartCommand(const char *command) {
 /** Execute an external program. */
 void RunCommand(const char *command)
 {
+   if(JUNLIKELY(!command)) {
+      return;
+   }
+   SpawnCommand(command, -1);
+}
+
+/** Execute an external program with output to a pipe. */
+int OpenCommand(const char *command, pid_t *pid)
+{
+   int fds[2];
+
+   if(JUNLIKELY(pipe(fds) < 0)) {
+      return -1;
+   }
+
+   fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+   *pid = SpawnCommand(command, fds[1]);
+   close(fds[1]);
+   if(JUNLIKELY(*pid < 0)) {
+      close(fds[0]);
+      return -1;
+   }
+   fcntl(fds[0], F_SETFL, O_NONBLOCK);
+   return fds[0];
+}
+
+/** Split a command into arguments if it can be run without the shell.
+ * The result is a single allocation to be released with Release.
+ * @return The arguments or NULL if the shell is needed.
+ */
+char **GetCommandArguments(const char *command)
+{
+   char **argv;
+   char *str;
+   size_t len;
+   int count, x;
+   char inWord;
+
+   if(command[strcspn(command, SHELL_CHARS)] != 0) {
+      return NULL;
+   }
+
+   count = 0;
+   inWord = 0;
+   for(len = 0; command[len]; len++) {
+      if(command[len] == ' ' || command[len] == '\t') {
+         inWord = 0;
+      } else if(!inWord) {
+         inWord = 1;
+         count += 1;
+      }
+   }
+   if(count == 0) {
+      return NULL;
+   }
+
+   argv = Allocate((count + 1) * sizeof(char*) + len + 1);
+   str = (char*)&argv[count + 1];
+   memcpy(str, command, len + 1);
+   x = 0;
+   inWord = 0;
+   for(; *str; str++) {
+      if(*str == ' ' || *str == '\t') {
+         *str = 0;
+         inWord = 0;
+      } else if(!inWord) {
+         argv[x++] = str;
+         inWord = 1;
+      }
+   }
+   argv[x] = NULL;
+   return argv;
+}
 
+/** Start a command in its own session.
+ * Commands without shell syntax are run directly; others use the shell.
+ * @param command The command to run.
+ * @param outputFd Descriptor for standard output (-1 to inherit).
+ * @return The process ID (-1 on error).
+ */
+pid_t SpawnCommand(const char *command, int outputFd)
+{
+   static char *shellArgv[] = { SHELL_NAME, "-c", NULL, NULL };
    const char *displayString;
+   char *displayEnv;
+   char **argv;
+   char **args;
+   pid_t pid;
+#ifdef HAVE_POSIX_SPAWN
+   posix_spawn_file_actions_t actions;
+   posix_spawnattr_t attr;
+   char **envp;
+   int count, x, y;
+   int rc;
+#endif
 
-   if(JUNLIKELY(!command)) {
-      return;
+   args = GetCommandArguments(command);
+   if(args) {
+      argv = args;
+   } else {
+      shellArgv[2] = (char*)command;
+      argv = shellArgv;
    }
 
+   displayEnv = NULL;
    displayString = DisplayString(display);
-   if(!fork()) {
+   if(displayString && displayString[0]) {
+      displayEnv = Allocate(strlen(displayString) + 9);
+      sprintf(displayEnv, "DISPLAY=%s", displayString);
+   }
+
+#ifdef HAVE_POSIX_SPAWN
+
+   /* Set DISPLAY in a copy of the environment. */
+   for(count = 0; environ[count]; count++);
+   envp = Allocate((count + 2) * sizeof(char*));
+   y = 0;
+   for(x = 0; x < count; x++) {
+      if(!displayEnv || strncmp(environ[x], "DISPLAY=", 8)) {
+         envp[y++] = environ[x];
+      }
+   }
+   if(displayEnv) {
+      envp[y++] = displayEnv;
+   }
+   envp[y] = NULL;
+
+   posix_spawn_file_actions_init(&actions);
+   posix_spawn_file_actions_addclose(&actions, ConnectionNumber(display));
+   if(outputFd >= 0 && outputFd != STDOUT_FILENO) {
+      posix_spawn_file_actions_adddup2(&actions, outputFd, STDOUT_FILENO);
+      posix_spawn_file_actions_addclose(&actions, outputFd);
+   }
+   posix_spawnattr_init(&attr);
+#ifdef POSIX_SPAWN_SETSID
+   posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSID);
+#else
+   posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+   posix_spawnattr_setpgroup(&attr, 0);
+#endif
+
+   if(args) {
+      rc = posix_spawnp(&pid, argv[0], &actions, &attr, argv, envp);
+   } else {
+      rc = posix_spawn(&pid, SHELL_NAME, &actions, &attr, argv, envp);
+   }
+   if(JUNLIKELY(rc != 0)) {
+      Warning(_("exec failed: (%s) %s"), argv[0], command);
+      pid = -1;
+   }
+
+   posix_spawnattr_destroy(&attr);
+   posix_spawn_file_actions_destroy(&actions);
+   Release(envp);
+
+#else
+
+   pid = fork();
+   if(pid == 0) {
       close(ConnectionNumber(display));
-      if(displayString && displayString[0]) {
-         char *str = malloc(strlen(displayString) + 9);
-         sprintf(str, "DISPLAY=%s", displayString);
-         putenv(str);
+      if(outputFd >= 0 && outputFd != STDOUT_FILENO) {
+         dup2(outputFd, STDOUT_FILENO);
+         close(outputFd);
+      }
+      if(displayEnv) {
+         putenv(displayEnv);
       }
       setsid();
-      execl(SHELL_NAME, SHELL_NAME, "-c", command, NULL);
-      Warning(_("exec failed: (%s) %s"), SHELL_NAME, command);
-      exit(EXIT_SUCCESS);
+      execvp(argv[0], argv);
+      Warning(_("exec failed: (%s) %s"), argv[0], command);
+      _exit(EXIT_FAILURE);
    }
 
-}
+#endif
 
+   if(displayEnv) {
+      Release(displayEnv);
+   }
+   if(args) {
+      Release(args);
+   }
+   return pid;
+}
@@ -37,5 +37,14 @@ void AddRestartCommand(const char *command);
  */
 void RunCommand(const char *command);
 
+/** Run a command with its standard output connected to a pipe.
+ * The command runs in its own session so that it can be killed
+ * along with its children.
+ * @param command The command to run (run in sh).
+ * @param pid Location to store the process ID.
+ * @return The non-blocking read end of the pipe (-1 on error).
+ */
+int OpenCommand(const char *command, pid_t *pid);
+
 #endif /* COMMAND_H */
 
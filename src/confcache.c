@@ -0,0 +1,676 @@
+/**
+ * @file confcache.c
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Compiled configuration cache.
+ *
+ * The token trees of every file read while parsing the configuration
+ * are stored in a binary file next to the configuration. On the next
+ * start the trees are restored directly from the mapped cache for
+ * every file whose modification time and size are unchanged.
+ *
+ */
+
+#include "jwm.h"
+#include "confcache.h"
+#include "lex.h"
+#include "misc.h"
+#include "error.h"
+
+/** Suffix appended to the configuration path for the cache. */
+#define CACHE_SUFFIX    ".cache"
+
+/** Cache format version. Change when the format or tokens change. */
+#define CACHE_VERSION   1
+
+/** Offset used for NULL strings. */
+#define CACHE_NULL      ((unsigned int)-1)
+
+/** Files modified this close to the cache creation time are reread
+ * since a change within the same second would not be detected. */
+#define CACHE_SLACK     2
+
+/** Cache file header. */
+typedef struct CacheHeader {
+   char magic[4];             /**< "JWMC". */
+   unsigned int version;      /**< CACHE_VERSION. */
+   unsigned int nodeSize;     /**< Size of a CacheNode. */
+   unsigned int fileCount;    /**< Number of files. */
+   unsigned int recordSize;   /**< Bytes of records after the header. */
+   unsigned int stringSize;   /**< Bytes of strings after the records. */
+   time_t created;            /**< When the cache was written. */
+} CacheHeader;
+
+/** Cached file.
+ * Followed by nodeCount nodes in pre-order and attributeCount
+ * attributes in node order.
+ */
+typedef struct CacheFile {
+   time_t mtime;                 /**< Modification time of the file. */
+   off_t size;                   /**< Size of the file. */
+   unsigned int path;            /**< Path of the file. */
+   unsigned int nodeCount;       /**< Number of nodes. */
+   unsigned int attributeCount;  /**< Number of attributes. */
+} CacheFile;
+
+/** Cached token node. */
+typedef struct CacheNode {
+   unsigned int type;            /**< Token type. */
+   unsigned int line;            /**< Line number. */
+   unsigned int invalidName;     /**< Name if the type is invalid. */
+   unsigned int value;           /**< Body of the tag. */
+   unsigned int attributeCount;  /**< Number of attributes. */
+   unsigned int childCount;      /**< Number of children. */
+} CacheNode;
+
+/** Cached attribute. */
+typedef struct CacheAttribute {
+   unsigned int name;            /**< Name of the attribute. */
+   unsigned int value;           /**< Value of the attribute. */
+} CacheAttribute;
+
+/** Growable buffer used to write the cache. */
+typedef struct CacheBuffer {
+   char *data;
+   unsigned int length;
+   unsigned int max;
+} CacheBuffer;
+
+static char *cachePath = NULL;
+
+/* The existing cache. */
+static char *cacheData = NULL;
+static size_t cacheLength;
+static char cacheMapped;
+static const CacheHeader *header;
+static const CacheFile **files;
+static const char *strings;
+
+/* Files used while parsing. */
+static const CacheFile **usedFiles;
+static unsigned int usedCount;
+static unsigned int usedMax;
+static char dirty;
+
+/* The new cache. */
+static CacheBuffer records;
+static CacheBuffer stringTable;
+static unsigned int newFileCount;
+
+/* Status of the file passed to GetCachedTokens. */
+static struct stat pendingStat;
+static char hasPendingStat;
+
+static void LoadCache(void);
+static void ReleaseCache(void);
+static char ValidateCache(void);
+static const char *GetCacheString(unsigned int offset);
+static TokenNode *RestoreNode(TokenNode *parent, const CacheNode **np,
+                              const CacheAttribute **ap,
+                              TokenNode **nextNode,
+                              AttributeNode **nextAttribute,
+                              const char *fileName);
+static TokenNode *RestoreFile(const CacheFile *fp);
+static void MarkCacheDirty(void);
+static void SaveFile(const char *fileName, const struct stat *sp,
+                     const TokenNode *tokens);
+static void CountTokens(const TokenNode *np, unsigned int *nodeCount,
+                        unsigned int *attributeCount);
+static void SaveNodes(const TokenNode *np, unsigned int nodeOffset);
+static void SaveAttributes(const TokenNode *np);
+static unsigned int SaveString(const char *str);
+static void *AppendBuffer(CacheBuffer *bp, const void *data,
+                          unsigned int length);
+static void WriteCache(void);
+
+/** Open the configuration cache before parsing. */
+void BeginConfigCache(const char *configPath, char rebuild)
+{
+   cachePath = Allocate(strlen(configPath) + sizeof(CACHE_SUFFIX));
+   strcpy(cachePath, configPath);
+   strcat(cachePath, CACHE_SUFFIX);
+
+   usedCount = 0;
+   usedMax = 8;
+   usedFiles = Allocate(usedMax * sizeof(CacheFile*));
+   dirty = 0;
+   hasPendingStat = 0;
+
+   memset(&records, 0, sizeof(records));
+   memset(&stringTable, 0, sizeof(stringTable));
+   newFileCount = 0;
+
+   header = NULL;
+   files = NULL;
+   cacheData = NULL;
+   if(!rebuild) {
+      LoadCache();
+   }
+}
+
+/** Close the configuration cache after parsing. */
+char EndConfigCache(void)
+{
+   char upToDate;
+
+   if(usedCount > 0 && (!header || usedCount != header->fileCount)) {
+      MarkCacheDirty();
+   }
+   upToDate = !dirty;
+   if(dirty) {
+      WriteCache();
+   }
+
+   if(records.data) {
+      Release(records.data);
+   }
+   if(stringTable.data) {
+      Release(stringTable.data);
+   }
+   Release(usedFiles);
+   ReleaseCache();
+   Release(cachePath);
+   cachePath = NULL;
+
+   return upToDate;
+}
+
+/** Get the tokens for a file from the configuration cache. */
+char GetCachedTokens(const char *fileName, TokenNode **tokens)
+{
+   unsigned int x;
+
+   hasPendingStat = 0;
+   if(JUNLIKELY(!cachePath)) {
+      return 0;
+   }
+   if(stat(fileName, &pendingStat) < 0) {
+      return 0;
+   }
+   hasPendingStat = 1;
+
+   if(header) {
+      for(x = 0; x < header->fileCount; x++) {
+         const CacheFile *fp = files[x];
+         if(!strcmp(GetCacheString(fp->path), fileName)) {
+            if(fp->mtime != pendingStat.st_mtime
+               || fp->size != pendingStat.st_size
+               || fp->mtime + CACHE_SLACK > header->created) {
+               break;
+            }
+            *tokens = RestoreFile(fp);
+            if(dirty) {
+               SaveFile(fileName, &pendingStat, *tokens);
+            } else {
+               if(usedCount >= usedMax) {
+                  usedMax *= 2;
+                  usedFiles = Reallocate(usedFiles,
+                                         usedMax * sizeof(CacheFile*));
+               }
+               usedFiles[usedCount] = fp;
+            }
+            usedCount += 1;
+            hasPendingStat = 0;
+            return 1;
+         }
+      }
+   }
+
+   return 0;
+}
+
+/** Add the tokens for a file to the configuration cache. */
+void CacheTokens(const char *fileName, const TokenNode *tokens)
+{
+   if(JUNLIKELY(!cachePath)) {
+      return;
+   }
+   MarkCacheDirty();
+   usedCount += 1;
+   if(hasPendingStat) {
+      SaveFile(fileName, &pendingStat, tokens);
+      hasPendingStat = 0;
+   } else {
+      /* The file could not be checked; force a reread next time. */
+      struct stat st;
+      memset(&st, 0, sizeof(st));
+      SaveFile(fileName, &st, tokens);
+   }
+}
+
+/** Release tokens returned by GetCachedTokens. */
+void ReleaseCachedTokens(TokenNode *tokens)
+{
+   if(tokens) {
+      Release(tokens);
+   }
+}
+
+/** Load the existing cache file. */
+void LoadCache(void)
+{
+   struct stat st;
+   int fd;
+
+   fd = open(cachePath, O_RDONLY);
+   if(fd < 0) {
+      return;
+   }
+   if(fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(CacheHeader)) {
+      close(fd);
+      return;
+   }
+   cacheLength = st.st_size;
+
+#ifdef HAVE_MMAP
+   cacheData = mmap(NULL, cacheLength, PROT_READ, MAP_SHARED, fd, 0);
+   if(JUNLIKELY(cacheData == MAP_FAILED)) {
+      cacheData = NULL;
+      close(fd);
+      return;
+   }
+   cacheMapped = 1;
+#else
+   cacheData = Allocate(cacheLength);
+   cacheMapped = 0;
+   if(JUNLIKELY(read(fd, cacheData, cacheLength) != (ssize_t)cacheLength)) {
+      Release(cacheData);
+      cacheData = NULL;
+      close(fd);
+      return;
+   }
+#endif
+   close(fd);
+
+   if(JUNLIKELY(!ValidateCache())) {
+      Debug("ignoring invalid configuration cache %s", cachePath);
+      ReleaseCache();
+   }
+}
+
+/** Release the existing cache. */
+void ReleaseCache(void)
+{
+   if(files) {
+      Release(files);
+      files = NULL;
+   }
+   if(cacheData) {
+#ifdef HAVE_MMAP
+      if(cacheMapped) {
+         munmap(cacheData, cacheLength);
+      } else {
+         Release(cacheData);
+      }
+#else
+      Release(cacheData);
+#endif
+      cacheData = NULL;
+   }
+   header = NULL;
+}
+
+/** Check the structure of the cache and index its files. */
+char ValidateCache(void)
+{
+   const char *data;
+   const char *end;
+   unsigned int x, y;
+   unsigned int pending;
+
+   header = (const CacheHeader*)cacheData;
+   if(memcmp(header->magic, "JWMC", 4)
+      || header->version != CACHE_VERSION
+      || header->nodeSize != sizeof(CacheNode)
+      || header->recordSize > cacheLength - sizeof(CacheHeader)
+      || header->stringSize != cacheLength - sizeof(CacheHeader)
+                                           - header->recordSize
+      || header->stringSize == 0) {
+      return 0;
+   }
+   data = cacheData + sizeof(CacheHeader);
+   end = data + header->recordSize;
+   strings = end;
+   if(strings[header->stringSize - 1] != 0) {
+      return 0;
+   }
+
+   files = Allocate(Max(header->fileCount, 1) * sizeof(CacheFile*));
+   for(x = 0; x < header->fileCount; x++) {
+      const CacheFile *fp = (const CacheFile*)data;
+      const CacheNode *np;
+      const CacheAttribute *ap;
+      unsigned int attributes;
+      if((size_t)(end - data) < sizeof(CacheFile)) {
+         return 0;
+      }
+      data += sizeof(CacheFile);
+      if((end - data) / sizeof(CacheNode) < fp->nodeCount) {
+         return 0;
+      }
+      np = (const CacheNode*)data;
+      data += fp->nodeCount * sizeof(CacheNode);
+      if((end - data) / sizeof(CacheAttribute) < fp->attributeCount) {
+         return 0;
+      }
+      ap = (const CacheAttribute*)data;
+      data += fp->attributeCount * sizeof(CacheAttribute);
+      if(fp->path >= header->stringSize) {
+         return 0;
+      }
+
+      /* Check that the nodes form a single tree in pre-order and
+       * that the attributes add up. */
+      pending = fp->nodeCount > 0 ? 1 : 0;
+      attributes = 0;
+      for(y = 0; y < fp->nodeCount; y++) {
+         if(pending == 0
+            || np[y].type > TOK_WINDOWSTYLE
+            || np[y].childCount > fp->nodeCount
+            || (np[y].value != CACHE_NULL
+                && np[y].value >= header->stringSize)
+            || (np[y].invalidName != CACHE_NULL
+                && np[y].invalidName >= header->stringSize)) {
+            return 0;
+         }
+         pending = pending - 1 + np[y].childCount;
+         attributes += np[y].attributeCount;
+         if(pending > fp->nodeCount || attributes > fp->attributeCount) {
+            return 0;
+         }
+      }
+      if(pending != 0 || attributes != fp->attributeCount) {
+         return 0;
+      }
+      for(y = 0; y < fp->attributeCount; y++) {
+         if((ap[y].name != CACHE_NULL && ap[y].name >= header->stringSize)
+            || (ap[y].value != CACHE_NULL
+                && ap[y].value >= header->stringSize)) {
+            return 0;
+         }
+      }
+
+      files[x] = fp;
+   }
+
+   return data == end;
+}
+
+/** Get a string from the existing cache. */
+const char *GetCacheString(unsigned int offset)
+{
+   return offset == CACHE_NULL ? NULL : strings + offset;
+}
+
+/** Restore the tokens for a cached file. */
+TokenNode *RestoreFile(const CacheFile *fp)
+{
+   const CacheNode *np;
+   const CacheAttribute *ap;
+   TokenNode *nodes;
+   AttributeNode *attributes;
+   TokenNode *result;
+
+   if(fp->nodeCount == 0) {
+      return NULL;
+   }
+
+   /* All nodes and attributes are allocated together and the strings
+    * refer to the cache. */
+   nodes = Allocate(fp->nodeCount * sizeof(TokenNode)
+                    + fp->attributeCount * sizeof(AttributeNode));
+   attributes = (AttributeNode*)(nodes + fp->nodeCount);
+   np = (const CacheNode*)(fp + 1);
+   ap = (const CacheAttribute*)(np + fp->nodeCount);
+
+   result = RestoreNode(NULL, &np, &ap, &nodes, &attributes,
+                        GetCacheString(fp->path));
+   return result;
+}
+
+/** Restore a token node and its children. */
+TokenNode *RestoreNode(TokenNode *parent, const CacheNode **np,
+                       const CacheAttribute **ap,
+                       TokenNode **nextNode,
+                       AttributeNode **nextAttribute,
+                       const char *fileName)
+{
+   const CacheNode *cp = *np;
+   TokenNode *tp = *nextNode;
+   TokenNode *child;
+   AttributeNode **lastAttribute;
+   unsigned int x;
+
+   *np += 1;
+   *nextNode += 1;
+
+   tp->type = cp->type;
+   tp->invalidName = (char*)GetCacheString(cp->invalidName);
+   tp->value = (char*)GetCacheString(cp->value);
+   tp->fileName = (char*)fileName;
+   tp->line = cp->line;
+   tp->parent = parent;
+   tp->next = NULL;
+
+   tp->attributes = NULL;
+   lastAttribute = &tp->attributes;
+   for(x = 0; x < cp->attributeCount; x++) {
+      AttributeNode *attr = *nextAttribute;
+      *nextAttribute += 1;
+      attr->name = (char*)GetCacheString((*ap)->name);
+      attr->value = (char*)GetCacheString((*ap)->value);
+      attr->next = NULL;
+      *lastAttribute = attr;
+      lastAttribute = &attr->next;
+      *ap += 1;
+   }
+
+   tp->subnodeHead = NULL;
+   tp->subnodeTail = NULL;
+   for(x = 0; x < cp->childCount; x++) {
+      child = RestoreNode(tp, np, ap, nextNode, nextAttribute, fileName);
+      if(tp->subnodeTail) {
+         tp->subnodeTail->next = child;
+      } else {
+         tp->subnodeHead = child;
+      }
+      tp->subnodeTail = child;
+   }
+
+   return tp;
+}
+
+/** Note that the cache must be rewritten.
+ * Files restored from the cache so far are copied to the new cache.
+ */
+void MarkCacheDirty(void)
+{
+   unsigned int x;
+
+   if(dirty) {
+      return;
+   }
+   dirty = 1;
+
+   for(x = 0; x < usedCount; x++) {
+      const CacheFile *fp = usedFiles[x];
+      struct stat st;
+      TokenNode *tokens = RestoreFile(fp);
+      memset(&st, 0, sizeof(st));
+      st.st_mtime = fp->mtime;
+      st.st_size = fp->size;
+      SaveFile(GetCacheString(fp->path), &st, tokens);
+      ReleaseCachedTokens(tokens);
+   }
+}
+
+/** Add a file to the new cache. */
+void SaveFile(const char *fileName, const struct stat *sp,
+              const TokenNode *tokens)
+{
+   CacheFile file;
+   unsigned int offset;
+
+   memset(&file, 0, sizeof(file));
+   file.mtime = sp->st_mtime;
+   file.size = sp->st_size;
+   file.path = SaveString(fileName);
+   CountTokens(tokens, &file.nodeCount, &file.attributeCount);
+   AppendBuffer(&records, &file, sizeof(file));
+   newFileCount += 1;
+
+   offset = records.length;
+   AppendBuffer(&records, NULL, file.nodeCount * sizeof(CacheNode));
+   SaveNodes(tokens, offset);
+   SaveAttributes(tokens);
+}
+
+/** Count nodes and attributes in a token list. */
+void CountTokens(const TokenNode *np, unsigned int *nodeCount,
+                 unsigned int *attributeCount)
+{
+   const AttributeNode *ap;
+   *nodeCount = 0;
+   *attributeCount = 0;
+   while(np) {
+      unsigned int nodes, attributes;
+      CountTokens(np->subnodeHead, &nodes, &attributes);
+      *nodeCount += nodes + 1;
+      *attributeCount += attributes;
+      for(ap = np->attributes; ap; ap = ap->next) {
+         *attributeCount += 1;
+      }
+      np = np->next;
+   }
+}
+
+/** Write nodes in pre-order to space reserved at a record offset. */
+void SaveNodes(const TokenNode *np, unsigned int nodeOffset)
+{
+   const TokenNode *tp;
+   const AttributeNode *ap;
+   CacheNode node;
+
+   while(np) {
+      memset(&node, 0, sizeof(node));
+      node.type = np->type;
+      node.line = np->line;
+      node.invalidName = SaveString(np->invalidName);
+      node.value = SaveString(np->value);
+      for(ap = np->attributes; ap; ap = ap->next) {
+         node.attributeCount += 1;
+      }
+      for(tp = np->subnodeHead; tp; tp = tp->next) {
+         node.childCount += 1;
+      }
+      memcpy(records.data + nodeOffset, &node, sizeof(node));
+      nodeOffset += sizeof(node);
+
+      if(np->subnodeHead) {
+         unsigned int nodes, attributes;
+         SaveNodes(np->subnodeHead, nodeOffset);
+         CountTokens(np->subnodeHead, &nodes, &attributes);
+         nodeOffset += nodes * sizeof(CacheNode);
+      }
+      np = np->next;
+   }
+}
+
+/** Write attributes in node order. */
+void SaveAttributes(const TokenNode *np)
+{
+   const AttributeNode *ap;
+   CacheAttribute attr;
+   while(np) {
+      for(ap = np->attributes; ap; ap = ap->next) {
+         attr.name = SaveString(ap->name);
+         attr.value = SaveString(ap->value);
+         AppendBuffer(&records, &attr, sizeof(attr));
+      }
+      SaveAttributes(np->subnodeHead);
+      np = np->next;
+   }
+}
+
+/** Add a string to the new cache. */
+unsigned int SaveString(const char *str)
+{
+   unsigned int offset;
+   if(!str) {
+      return CACHE_NULL;
+   }
+   offset = stringTable.length;
+   AppendBuffer(&stringTable, str, strlen(str) + 1);
+   return offset;
+}
+
+/** Append data to a buffer (zero filled if data is NULL). */
+void *AppendBuffer(CacheBuffer *bp, const void *data, unsigned int length)
+{
+   char *result;
+   if(bp->length + length > bp->max) {
+      bp->max = Max(bp->max * 2, bp->length + length);
+      bp->max = Max(bp->max, 1024);
+      if(bp->data) {
+         bp->data = Reallocate(bp->data, bp->max);
+      } else {
+         bp->data = Allocate(bp->max);
+      }
+   }
+   result = bp->data + bp->length;
+   if(data) {
+      memcpy(result, data, length);
+   } else {
+      memset(result, 0, length);
+   }
+   bp->length += length;
+   return result;
+}
+
+/** Write the new cache.
+ * The cache is written to a temporary file that is renamed so that a
+ * partially written cache is never used.
+ */
+void WriteCache(void)
+{
+   CacheHeader hdr;
+   char *tempPath;
+   FILE *fd;
+   char ok;
+
+   /* Keep at least one string so the table is never empty. */
+   SaveString("");
+
+   memset(&hdr, 0, sizeof(hdr));
+   memcpy(hdr.magic, "JWMC", 4);
+   hdr.version = CACHE_VERSION;
+   hdr.nodeSize = sizeof(CacheNode);
+   hdr.fileCount = newFileCount;
+   hdr.recordSize = records.length;
+   hdr.stringSize = stringTable.length;
+   hdr.created = time(NULL);
+
+   tempPath = Allocate(strlen(cachePath) + 5);
+   strcpy(tempPath, cachePath);
+   strcat(tempPath, ".tmp");
+
+   fd = fopen(tempPath, "wb");
+   if(!fd) {
+      Debug("could not write configuration cache %s", tempPath);
+      Release(tempPath);
+      return;
+   }
+   ok = fwrite(&hdr, sizeof(hdr), 1, fd) == 1;
+   if(records.length > 0) {
+      ok = ok && fwrite(records.data, records.length, 1, fd) == 1;
+   }
+   ok = ok && fwrite(stringTable.data, stringTable.length, 1, fd) == 1;
+   ok = (fclose(fd) == 0) && ok;
+
+   if(JUNLIKELY(!ok || rename(tempPath, cachePath) < 0)) {
+      Debug("could not write configuration cache %s", cachePath);
+      unlink(tempPath);
+   }
+   Release(tempPath);
+}
@@ -0,0 +1,49 @@
+/**
+ * @file confcache.h
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Header for the compiled configuration cache.
+ *
+ */
+
+#ifndef CONFCACHE_H
+#define CONFCACHE_H
+
+struct TokenNode;
+
+/** Open the configuration cache before parsing.
+ * @param configPath The configuration file being parsed.
+ * @param rebuild Set to ignore the existing cache and write a new one.
+ */
+void BeginConfigCache(const char *configPath, char rebuild);
+
+/** Close the configuration cache after parsing.
+ * The cache file is rewritten if any file was missing from it or out
+ * of date.
+ * @return 1 if the cache was up to date, 0 otherwise.
+ */
+char EndConfigCache(void);
+
+/** Get the tokens for a file from the configuration cache.
+ * The tokens must be released with ReleaseCachedTokens.
+ * @param fileName The file.
+ * @param tokens Location to store the tokens (NULL if the file is empty).
+ * @return 1 if the file was found in the cache and is up to date.
+ */
+char GetCachedTokens(const char *fileName, struct TokenNode **tokens);
+
+/** Add the tokens for a file to the configuration cache.
+ * This must follow an unsuccessful call to GetCachedTokens for the
+ * same file and precede any change to the tokens.
+ * @param fileName The file.
+ * @param tokens The tokens read from the file.
+ */
+void CacheTokens(const char *fileName, const struct TokenNode *tokens);
+
+/** Release tokens returned by GetCachedTokens.
+ * @param tokens The tokens to release.
+ */
+void ReleaseCachedTokens(struct TokenNode *tokens);
+
+#endif /* CONFCACHE_H */
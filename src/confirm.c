@@ -346,6 +346,7 @@ void DestroyConfirmDialog(void)
    RemoveClient(dialog->node);
 
    /* Free the pixmap. */
+   ReleaseStringDrawable(dialog->pmap);
    JXFreePixmap(display, dialog->pmap);
 
    /* Free the message. */
@@ -11,6 +11,7 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 /** Emit a message (if compiled with -DDEBUG). */
 void Debug(const char *str, ...)
@@ -28,19 +29,227 @@ void Debug(const char *str, ...)
 #endif /* DEBUG */
 }
 
-#ifdef DEBUG
+#if defined(DEBUG) || defined(SAMPLE_ALLOCATIONS)
 
-#define CHECKPOINT_LIST_SIZE 8
+/** Number of call site buckets (must be a power of two). */
+#define SITE_HASH_SIZE 512
 
-typedef struct MemoryType {
+/** Initial number of allocation buckets (must be a power of two). */
+#define MEMORY_HASH_SIZE 1024
+
+/** Only one in this many allocations is tracked when sampling. */
+#define SAMPLE_PERIOD 64
+
+/** Statistics for the allocations made at one place in the code. */
+typedef struct SiteType {
    const char *file;
    unsigned int line;
+   unsigned long count;       /**< Live allocations. */
+   unsigned long total;       /**< Allocations made. */
+   unsigned long lastTotal;   /**< Allocations made at the last report. */
+   size_t bytes;              /**< Live bytes. */
+   size_t peak;               /**< Most live bytes. */
+   struct SiteType *next;
+} SiteType;
+
+/** A tracked allocation. */
+typedef struct MemoryType {
+   SiteType *site;
    size_t size;
    char *pointer;
    struct MemoryType *next;
 } MemoryType;
 
-static MemoryType *allocations = NULL;
+static SiteType *sites[SITE_HASH_SIZE];
+static unsigned int siteCount = 0;
+static MemoryType **allocations = NULL;
+static size_t allocationHashSize = 0;
+static size_t allocationCount = 0;
+static size_t liveBytes = 0;
+static size_t peakBytes = 0;
+static time_t lastReport = 0;
+
+static SiteType *GetSite(const char *file, unsigned int line);
+static void AddSite(SiteType *sp, size_t size);
+static void RemoveSite(SiteType *sp, size_t size);
+static size_t GetMemoryHash(const void *pointer);
+static void InsertAllocation(MemoryType *mp);
+static MemoryType *RemoveAllocation(const void *pointer);
+static int CompareSites(const void *a, const void *b);
+
+/** Get the statistics for a call site. */
+SiteType *GetSite(const char *file, unsigned int line)
+{
+   size_t hash;
+   SiteType *sp;
+
+   hash = ((size_t)file >> 3) ^ (line * 2654435761u);
+   hash = (hash ^ (hash >> 13)) & (SITE_HASH_SIZE - 1);
+   for(sp = sites[hash]; sp; sp = sp->next) {
+      if(sp->file == file && sp->line == line) {
+         return sp;
+      }
+   }
+
+   sp = malloc(sizeof(SiteType));
+   Assert(sp);
+   memset(sp, 0, sizeof(SiteType));
+   sp->file = file;
+   sp->line = line;
+   sp->next = sites[hash];
+   sites[hash] = sp;
+   siteCount += 1;
+   return sp;
+}
+
+/** Add an allocation to the statistics of a call site. */
+void AddSite(SiteType *sp, size_t size)
+{
+   sp->count += 1;
+   sp->total += 1;
+   sp->bytes += size;
+   if(sp->bytes > sp->peak) {
+      sp->peak = sp->bytes;
+   }
+   liveBytes += size;
+   if(liveBytes > peakBytes) {
+      peakBytes = liveBytes;
+   }
+}
+
+/** Remove an allocation from the statistics of a call site. */
+void RemoveSite(SiteType *sp, size_t size)
+{
+   sp->count -= 1;
+   sp->bytes -= size;
+   liveBytes -= size;
+}
+
+/** Get the bucket for an allocation. */
+size_t GetMemoryHash(const void *pointer)
+{
+   size_t hash = (size_t)pointer >> 4;
+   hash ^= hash >> 15;
+   hash *= 2654435761u;
+   return (hash ^ (hash >> 16)) & (allocationHashSize - 1);
+}
+
+/** Add an allocation to the table, growing the table if needed. */
+void InsertAllocation(MemoryType *mp)
+{
+   size_t hash;
+
+   if(allocationCount >= allocationHashSize) {
+      MemoryType **old = allocations;
+      const size_t oldSize = allocationHashSize;
+      size_t x;
+      allocationHashSize = oldSize ? oldSize * 2 : MEMORY_HASH_SIZE;
+      allocations = calloc(allocationHashSize, sizeof(MemoryType*));
+      Assert(allocations);
+      for(x = 0; x < oldSize; x++) {
+         while(old[x]) {
+            MemoryType *next = old[x]->next;
+            hash = GetMemoryHash(old[x]->pointer);
+            old[x]->next = allocations[hash];
+            allocations[hash] = old[x];
+            old[x] = next;
+         }
+      }
+      free(old);
+   }
+
+   hash = GetMemoryHash(mp->pointer);
+   mp->next = allocations[hash];
+   allocations[hash] = mp;
+   allocationCount += 1;
+}
+
+/** Remove an allocation from the table.
+ * @return The allocation or NULL if it is not tracked.
+ */
+MemoryType *RemoveAllocation(const void *pointer)
+{
+   MemoryType **mp;
+   if(allocationCount == 0) {
+      return NULL;
+   }
+   for(mp = &allocations[GetMemoryHash(pointer)]; *mp; mp = &(*mp)->next) {
+      if((*mp)->pointer == pointer) {
+         MemoryType *result = *mp;
+         *mp = result->next;
+         allocationCount -= 1;
+         return result;
+      }
+   }
+   return NULL;
+}
+
+/** Order call sites by live bytes, largest first. */
+int CompareSites(const void *a, const void *b)
+{
+   const SiteType *sa = *(const SiteType**)a;
+   const SiteType *sb = *(const SiteType**)b;
+   if(sa->bytes != sb->bytes) {
+      return sa->bytes < sb->bytes ? 1 : -1;
+   }
+   return sa->peak < sb->peak ? 1 : (sa->peak > sb->peak ? -1 : 0);
+}
+
+/** Write allocation statistics for each call site to stderr.
+ * When sampling, the numbers are estimates.
+ */
+void DEBUG_ShowAllocations(void)
+{
+#ifdef DEBUG
+   const unsigned long scale = 1;
+#else
+   const unsigned long scale = SAMPLE_PERIOD;
+#endif
+   SiteType **list;
+   SiteType *sp;
+   unsigned int x, count;
+   time_t now;
+   long elapsed;
+
+   now = time(NULL);
+   elapsed = lastReport ? (long)(now - lastReport) : 0;
+   lastReport = now;
+
+   list = malloc((siteCount + 1) * sizeof(SiteType*));
+   Assert(list);
+   count = 0;
+   for(x = 0; x < SITE_HASH_SIZE; x++) {
+      for(sp = sites[x]; sp; sp = sp->next) {
+         list[count++] = sp;
+      }
+   }
+   qsort(list, count, sizeof(SiteType*), CompareSites);
+
+   fprintf(stderr, "MEMORY: %lu live bytes (peak %lu) at %u sites%s\n",
+           (unsigned long)liveBytes * scale,
+           (unsigned long)peakBytes * scale,
+           count, scale > 1 ? " (sampled)" : "");
+   fprintf(stderr, "MEMORY: %10s %10s %8s %10s %8s  site\n",
+           "bytes", "peak", "count", "allocs", "rate/s");
+   for(x = 0; x < count; x++) {
+      const unsigned long made = list[x]->total - list[x]->lastTotal;
+      sp = list[x];
+      fprintf(stderr, "MEMORY: %10lu %10lu %8lu %10lu %8lu  %s[%u]\n",
+              (unsigned long)sp->bytes * scale,
+              (unsigned long)sp->peak * scale,
+              sp->count * scale, sp->total * scale,
+              elapsed > 0 ? made * scale / elapsed : 0,
+              sp->file, sp->line);
+      sp->lastTotal = sp->total;
+   }
+   free(list);
+}
+
+#endif /* DEBUG || SAMPLE_ALLOCATIONS */
+
+#ifdef DEBUG
+
+#define CHECKPOINT_LIST_SIZE 8
 
 static const char *checkpointFile[CHECKPOINT_LIST_SIZE];
 static unsigned int checkpointLine[CHECKPOINT_LIST_SIZE];
@@ -62,19 +271,20 @@ void DEBUG_StartDebug(const char *file, unsigned int line)
 void DEBUG_StopDebug(const char *file, unsigned int line)
 {
    Debug("%s[%u]: debug mode stopped", file, line);
-   if(allocations) {
+   if(allocationCount > 0) {
       MemoryType *mp;
-      unsigned int count = 0;
+      size_t x;
       Debug("MEMORY: memory leaks follow");
-      for(mp = allocations; mp; mp = mp->next) {
-         Debug("        %u bytes in %s at line %u",
-            mp->size, mp->file, mp->line);
-         ++count;
+      for(x = 0; x < allocationHashSize; x++) {
+         for(mp = allocations[x]; mp; mp = mp->next) {
+            Debug("        %u bytes in %s at line %u",
+               (unsigned int)mp->size, mp->site->file, mp->site->line);
+         }
       }
-      if(count == 1) {
+      if(allocationCount == 1) {
          Debug("MEMORY: 1 memory leak");
       } else {
-         Debug("MEMORY: %u memory leaks", count);
+         Debug("MEMORY: %u memory leaks", (unsigned int)allocationCount);
       }
    } else {
       Debug("MEMORY: no memory leaks");
@@ -110,8 +320,7 @@ void *DEBUG_Allocate(size_t size, const char *file, unsigned int line)
    MemoryType *mp;
    mp = (MemoryType*)malloc(sizeof(MemoryType));
    Assert(mp);
-   mp->file = file;
-   mp->line = line;
+   mp->site = GetSite(file, line);
    mp->size = size;
    mp->pointer = malloc(size + sizeof(char) + 8);
    if(!mp->pointer) {
@@ -127,8 +336,8 @@ void *DEBUG_Allocate(size_t size, const char *file, unsigned int line)
    mp->pointer[7] = 42;
    mp->pointer[size + 8] = 42;
 
-   mp->next = allocations;
-   allocations = mp;
+   AddSite(mp->site, size);
+   InsertAllocation(mp);
    return mp->pointer + 8;
 }
 
@@ -144,49 +353,39 @@ void *DEBUG_Reallocate(void *ptr, size_t size,
       return DEBUG_Allocate(size, file, line);
    } else {
       char *cptr = (char*)ptr - 8;
-      for(mp = allocations; mp; mp = mp->next) {
-         if(mp->pointer == cptr) {
-            if(cptr[mp->size + 8] != 42) {
-               Debug("MEMORY: %s[%u]: The canary is dead (overflow).",
-                     file, line);
-            }
-            if(cptr[7] != 42) {
-               Debug("MEMORY: %s[%u]: The canary is dead (underflow).",
-                     file, line);
-            }
-            mp->file = file;
-            mp->line = line;
-            mp->size = size;
-            mp->pointer = realloc(cptr, size + sizeof(char) + 8);
-            if(!mp->pointer) {
-               Debug("MEMORY: %s[%u]: Failed to reallocate %d bytes.",
-                     file, line, (int)size);
-               Assert(0);
-            }
-            mp->pointer[7] = 42;
-            mp->pointer[size + 8] = 42;
-            return mp->pointer + 8;
+      mp = RemoveAllocation(cptr);
+      if(mp) {
+         if(cptr[mp->size + 8] != 42) {
+            Debug("MEMORY: %s[%u]: The canary is dead (overflow).",
+                  file, line);
+         }
+         if(cptr[7] != 42) {
+            Debug("MEMORY: %s[%u]: The canary is dead (underflow).",
+                  file, line);
+         }
+         RemoveSite(mp->site, mp->size);
+         mp->pointer = realloc(cptr, size + sizeof(char) + 8);
+      } else {
+         Debug("MEMORY: %s[%u]: Attempt to reallocate unallocated pointer",
+               file, line);
+         mp = malloc(sizeof(MemoryType));
+         Assert(mp);
+         mp->pointer = malloc(size + sizeof(char) + 8);
+         if(mp->pointer) {
+            memset(mp->pointer, 85, size);
          }
       }
-
-      Debug("MEMORY: %s[%u]: Attempt to reallocate unallocated pointer",
-            file, line);
-      mp = malloc(sizeof(MemoryType));
-      Assert(mp);
-      mp->file = file;
-      mp->line = line;
-      mp->size = size;
-      mp->pointer = malloc(size + sizeof(char) + 8);
       if(!mp->pointer) {
          Debug("MEMORY: %s[%u]: Failed to reallocate %d bytes.",
                file, line, (int)size);
          Assert(0);
       }
-      memset(mp->pointer, 85, size);
+      mp->site = GetSite(file, line);
+      mp->size = size;
       mp->pointer[7] = 42;
       mp->pointer[size + 8] = 42;
-      mp->next = allocations;
-      allocations = mp;
+      AddSite(mp->site, size);
+      InsertAllocation(mp);
       return mp->pointer + 8;
    }
 }
@@ -194,7 +393,7 @@ void *DEBUG_Reallocate(void *ptr, size_t size,
 /** Release memory and log. */
 void DEBUG_Release(void **ptr, const char *file, unsigned int line)
 {
-   MemoryType *mp, *last;
+   MemoryType *mp;
    if(!ptr) {
       Debug("MEMORY: %s[%u]: Invalid attempt to release", file, line);
    } else if(!*ptr) {
@@ -202,31 +401,24 @@ void DEBUG_Release(void **ptr, const char *file, unsigned int line)
             file, line);
    } else {
       char *cptr = (char*)*ptr - 8;
-      last = NULL;
-      for(mp = allocations; mp; mp = mp->next) {
-         if(mp->pointer == cptr) {
-            if(last) {
-               last->next = mp->next;
-            } else {
-               allocations = mp->next;
-            }
-
-            if(cptr[mp->size + 8] != 42) {
-               Debug("MEMORY: %s[%u]: The canary is dead (overflow).",
-                     file, line);
-            }
-            if(cptr[7] != 42) {
-               Debug("MEMORY: %s[%u]: The canary is dead (underflow).",
-                     file, line);
-            }
-
-            memset(cptr, 0xFF, mp->size + 8 + sizeof(char));
-            free(mp);
-            free(cptr);
-            *ptr = NULL;
-            return;
+      mp = RemoveAllocation(cptr);
+      if(mp) {
+
+         if(cptr[mp->size + 8] != 42) {
+            Debug("MEMORY: %s[%u]: The canary is dead (overflow).",
+                  file, line);
          }
-         last = mp;
+         if(cptr[7] != 42) {
+            Debug("MEMORY: %s[%u]: The canary is dead (underflow).",
+                  file, line);
+         }
+
+         RemoveSite(mp->site, mp->size);
+         memset(cptr, 0xFF, mp->size + 8 + sizeof(char));
+         free(mp);
+         free(cptr);
+         *ptr = NULL;
+         return;
       }
       Debug("MEMORY: %s[%u]: Attempt to delete unallocated pointer",
             file, line);
@@ -240,5 +432,61 @@ void DEBUG_Release(void **ptr, const char *file, unsigned int line)
 
 #undef CHECKPOINT_LIST_SIZE
 
+#elif defined(SAMPLE_ALLOCATIONS)
+
+static unsigned int sampleCounter = 0;
+
+/** Allocate memory, tracking one in SAMPLE_PERIOD allocations. */
+void *SAMPLE_Allocate(size_t size, const char *file, unsigned int line)
+{
+   void *result = malloc(size);
+   sampleCounter += 1;
+   if(sampleCounter >= SAMPLE_PERIOD && result) {
+      MemoryType *mp = malloc(sizeof(MemoryType));
+      sampleCounter = 0;
+      if(mp) {
+         mp->site = GetSite(file, line);
+         mp->size = size;
+         mp->pointer = result;
+         AddSite(mp->site, size);
+         InsertAllocation(mp);
+      }
+   }
+   return result;
+}
+
+/** Reallocate memory, keeping the record of a tracked allocation. */
+void *SAMPLE_Reallocate(void *ptr, size_t size,
+                        const char *file, unsigned int line)
+{
+   MemoryType *mp = ptr ? RemoveAllocation(ptr) : NULL;
+   void *result = realloc(ptr, size);
+   if(mp) {
+      RemoveSite(mp->site, mp->size);
+      if(result) {
+         mp->site = GetSite(file, line);
+         mp->size = size;
+         mp->pointer = result;
+         AddSite(mp->site, size);
+         InsertAllocation(mp);
+      } else {
+         InsertAllocation(mp);
+         AddSite(mp->site, mp->size);
+      }
+   }
+   return result;
+}
+
+/** Release memory, dropping the record of a tracked allocation. */
+void SAMPLE_Release(void *ptr)
+{
+   MemoryType *mp = ptr ? RemoveAllocation(ptr) : NULL;
+   if(mp) {
+      RemoveSite(mp->site, mp->size);
+      free(mp);
+   }
+   free(ptr);
+}
+
 #endif
 
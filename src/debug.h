@@ -93,11 +93,43 @@ void Debug(const char *str, ...);
 #   define StartDebug()          ((void)0)
 #   define StopDebug()           ((void)0)
 
-#   define Allocate( x )         malloc( (x) )
-#   define Reallocate( x, y )    realloc( (x), (y) )
-#   define Release( x )          free( (x) )
+#   ifdef SAMPLE_ALLOCATIONS
+
+#      define Allocate( x ) \
+         SAMPLE_Allocate( (x), __FILE__, __LINE__ )
+#      define Reallocate( x, y ) \
+         SAMPLE_Reallocate( (x), (y), __FILE__, __LINE__ )
+#      define Release( x )       SAMPLE_Release( (x) )
+
+      void *SAMPLE_Allocate(size_t, const char*, unsigned int);
+      void *SAMPLE_Reallocate(void*, size_t, const char*, unsigned int);
+      void SAMPLE_Release(void*);
+
+#   else /* SAMPLE_ALLOCATIONS */
+
+#      define Allocate( x )      malloc( (x) )
+#      define Reallocate( x, y ) realloc( (x), (y) )
+#      define Release( x )       free( (x) )
+
+#   endif /* SAMPLE_ALLOCATIONS */
 
 #endif /* DEBUG */
 
+#if defined(DEBUG) || defined(SAMPLE_ALLOCATIONS)
+
+/** Show per-site allocation statistics.
+ * With sampling, only one in 64 allocations is tracked and the
+ * numbers shown are estimates.
+ */
+#   define ShowAllocations()     DEBUG_ShowAllocations()
+
+   void DEBUG_ShowAllocations(void);
+
+#else
+
+#   define ShowAllocations()     ((void)0)
+
+#endif
+
 #endif /* DEBUG_H */
 
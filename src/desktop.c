@@ -218,10 +218,7 @@ Menu *CreateDesktopMenu(unsigned int mask)
 
    for(x = settings.desktopCount - 1; x >= 0; x--) {
 
-      item = Allocate(sizeof(MenuItem));
-      item->type = MENU_ITEM_NORMAL;
-      item->iconName = NULL;
-      item->submenu = NULL;
+      item = CreateMenuItem(MENU_ITEM_NORMAL);
       item->next = menu->items;
       menu->items = item;
 
@@ -260,10 +257,7 @@ Menu *CreateSendtoMenu(void)
 
    for(x = settings.desktopCount - 1; x >= 0; x--) {
 
-      item = Allocate(sizeof(MenuItem));
-      item->type = MENU_ITEM_NORMAL;
-      item->iconName = NULL;
-      item->submenu = NULL;
+      item = CreateMenuItem(MENU_ITEM_NORMAL);
       item->next = menu->items;
       menu->items = item;
 
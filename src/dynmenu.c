@@ -0,0 +1,358 @@
+/**
+ * @file dynmenu.c
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Dynamic menu generation.
+ *
+ * Programs that generate menus are run in the background so that a slow
+ * program does not stall the window manager. The output of a program is
+ * kept while the menus are open or, if requested, until a time limit
+ * passes or a watched file changes.
+ *
+ */
+
+#include "jwm.h"
+#include "dynmenu.h"
+#include "menu.h"
+#include "parse.h"
+#include "command.h"
+#include "event.h"
+#include "timing.h"
+#include "error.h"
+#include "misc.h"
+
+/** Default number of seconds to wait for a program. */
+#define DEFAULT_TIMEOUT 10
+
+/** How often to check for programs that took too long (milliseconds). */
+#define CHECK_FREQUENCY 250
+
+/** Initial size of the buffer for program output. */
+#define BLOCK_SIZE 1024
+
+/** The state of a watched file. */
+typedef struct WatchState {
+   time_t mtime;        /**< Modification time. */
+   off_t size;          /**< Size. */
+   char exists;         /**< Set if the file exists. */
+} WatchState;
+
+/** A command used to generate a dynamic menu. */
+typedef struct DynamicNode {
+
+   char *command;       /**< The include command (including "exec:"). */
+   char *watch;         /**< File to watch (or NULL). */
+   unsigned int ttl;    /**< Seconds to keep the output (0 for none). */
+   unsigned int timeout;/**< Seconds to wait for the program. */
+
+   char *output;        /**< Output of the last run (or NULL). */
+   size_t outputLength; /**< Length of the output. */
+   TimeType generated;  /**< When the program was started. */
+   WatchState state;    /**< State of the watched file at that time. */
+   char failed;         /**< Set if the last run failed while the menus
+                         *   were open. */
+
+   pid_t pid;           /**< Process ID of the running program. */
+   int fd;              /**< Pipe from the running program (-1 for none). */
+   char *buffer;        /**< Output read so far. */
+   size_t length;       /**< Bytes in the buffer. */
+   size_t max;          /**< Size of the buffer. */
+
+   struct DynamicNode *next;
+
+} DynamicNode;
+
+static DynamicNode *nodes = NULL;
+static int running = 0;
+
+static DynamicNode *GetDynamicNode(const char *command);
+static Menu *CreatePlaceholder(void);
+static char IsFresh(const DynamicNode *np);
+static void ReadWatchState(const char *path, WatchState *state);
+static void StartProgram(DynamicNode *np);
+static void StopProgram(DynamicNode *np);
+static void HandleOutput(int fd, void *data);
+static void SignalDynamicMenus(const TimeType *now, int x, int y, Window w,
+                               void *data);
+
+/** Shutdown dynamic menus. */
+void ShutdownDynamicMenus(void)
+{
+   DynamicNode *np;
+   for(np = nodes; np; np = np->next) {
+      if(np->fd >= 0) {
+         kill(-np->pid, SIGKILL);
+         StopProgram(np);
+      }
+   }
+}
+
+/** Destroy dynamic menu data. */
+void DestroyDynamicMenus(void)
+{
+   while(nodes) {
+      DynamicNode *np = nodes->next;
+      Release(nodes->command);
+      if(nodes->watch) {
+         Release(nodes->watch);
+      }
+      if(nodes->output) {
+         Release(nodes->output);
+      }
+      Release(nodes);
+      nodes = np;
+   }
+}
+
+/** Set the caching options for a dynamic menu. */
+void SetDynamicMenuOptions(const char *command, unsigned int ttl,
+                           unsigned int timeout, const char *watch)
+{
+   DynamicNode *np;
+
+   if(JUNLIKELY(!command)) {
+      return;
+   }
+
+   np = GetDynamicNode(command);
+   np->ttl = ttl;
+   np->timeout = timeout ? timeout : DEFAULT_TIMEOUT;
+   if(np->watch) {
+      Release(np->watch);
+   }
+   np->watch = CopyString(watch);
+}
+
+/** Create a dynamic menu. */
+Menu *CreateDynamicMenu(const char *command)
+{
+   DynamicNode *np;
+   char *buffer;
+
+   if(strncmp(command, "exec:", 5)) {
+      return ParseDynamicMenu(command);
+   }
+
+   np = GetDynamicNode(command);
+   if(np->failed) {
+      return NULL;
+   } else if(np->fd >= 0) {
+      return CreatePlaceholder();
+   } else if(IsFresh(np)) {
+      buffer = Allocate(np->outputLength + 1);
+      memcpy(buffer, np->output, np->outputLength + 1);
+      return ParseMenuBuffer(buffer, command + 5);
+   }
+
+   StartProgram(np);
+   return np->failed ? NULL : CreatePlaceholder();
+}
+
+/** Discard program output that is only kept while menus are open. */
+void ExpireDynamicMenus(void)
+{
+   DynamicNode *np;
+   for(np = nodes; np; np = np->next) {
+      np->failed = 0;
+      if(np->output && ((!np->ttl && !np->watch) || !IsFresh(np))) {
+         Release(np->output);
+         np->output = NULL;
+      }
+   }
+}
+
+/** Get the node for a command, creating it if needed. */
+DynamicNode *GetDynamicNode(const char *command)
+{
+   DynamicNode *np;
+
+   for(np = nodes; np; np = np->next) {
+      if(!strcmp(np->command, command)) {
+         return np;
+      }
+   }
+
+   np = Allocate(sizeof(DynamicNode));
+   memset(np, 0, sizeof(DynamicNode));
+   np->command = CopyString(command);
+   np->timeout = DEFAULT_TIMEOUT;
+   np->fd = -1;
+   np->next = nodes;
+   nodes = np;
+   return np;
+}
+
+/** Create a menu to show while a program is running. */
+Menu *CreatePlaceholder(void)
+{
+   Menu *menu;
+   MenuItem *item;
+
+   menu = Allocate(sizeof(Menu));
+   menu->itemHeight = 0;
+   menu->items = NULL;
+   menu->label = NULL;
+
+   item = CreateMenuItem(MENU_ITEM_NORMAL);
+   item->name = CopyString(_("Loading..."));
+   menu->items = item;
+
+   return menu;
+}
+
+/** Determine if the output of a program can be used. */
+char IsFresh(const DynamicNode *np)
+{
+   if(!np->output) {
+      return 0;
+   }
+   if(np->watch) {
+      WatchState state;
+      ReadWatchState(np->watch, &state);
+      if(state.exists != np->state.exists
+         || state.mtime != np->state.mtime
+         || state.size != np->state.size) {
+         return 0;
+      }
+   }
+   if(np->ttl) {
+      TimeType now;
+      GetCurrentTime(&now);
+      if(now.seconds - np->generated.seconds >= np->ttl) {
+         return 0;
+      }
+   }
+   return 1;
+}
+
+/** Get the state of a watched file. */
+void ReadWatchState(const char *path, WatchState *state)
+{
+   struct stat sbuf;
+   if(stat(path, &sbuf) == 0) {
+      state->mtime = sbuf.st_mtime;
+      state->size = sbuf.st_size;
+      state->exists = 1;
+   } else {
+      state->mtime = 0;
+      state->size = 0;
+      state->exists = 0;
+   }
+}
+
+/** Start the program for a dynamic menu. */
+void StartProgram(DynamicNode *np)
+{
+   char *path;
+
+   path = CopyString(np->command + 5);
+   ExpandPath(&path);
+
+   /* Take the state before running so changes during the run count. */
+   GetCurrentTime(&np->generated);
+   if(np->watch) {
+      ReadWatchState(np->watch, &np->state);
+   }
+
+   np->fd = OpenCommand(path, &np->pid);
+   if(JUNLIKELY(np->fd < 0)) {
+      Warning(_("could not execute included program: %s"), path);
+      Release(path);
+      np->failed = 1;
+      return;
+   }
+   Release(path);
+
+   np->max = BLOCK_SIZE;
+   np->length = 0;
+   np->buffer = Allocate(np->max + 1);
+
+   RegisterFileCallback(np->fd, HandleOutput, np);
+   running += 1;
+   if(running == 1) {
+      RegisterCallback(CHECK_FREQUENCY, SignalDynamicMenus, NULL);
+   }
+}
+
+/** Stop waiting for the program for a dynamic menu. */
+void StopProgram(DynamicNode *np)
+{
+   UnregisterFileCallback(np->fd);
+   close(np->fd);
+   np->fd = -1;
+   np->pid = 0;
+   if(np->buffer) {
+      Release(np->buffer);
+      np->buffer = NULL;
+   }
+   running -= 1;
+   if(running == 0) {
+      UnregisterCallback(SignalDynamicMenus, NULL);
+   }
+}
+
+/** Read output from a program. */
+void HandleOutput(int fd, void *data)
+{
+   DynamicNode *np = (DynamicNode*)data;
+   ssize_t count;
+
+   for(;;) {
+      if(np->length == np->max) {
+         np->max *= 2;
+         np->buffer = Reallocate(np->buffer, np->max + 1);
+      }
+      count = read(fd, &np->buffer[np->length], np->max - np->length);
+      if(count > 0) {
+         np->length += count;
+      } else if(count < 0 && errno == EINTR) {
+         continue;
+      } else if(count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+         return;
+      } else {
+         break;
+      }
+   }
+
+   /* End of output (or a read error). */
+   if(JLIKELY(count == 0)) {
+      if(np->output) {
+         Release(np->output);
+      }
+      np->output = np->buffer;
+      np->output[np->length] = 0;
+      np->outputLength = np->length;
+      np->buffer = NULL;
+   } else {
+      Warning(_("could not read included program: %s"), np->command + 5);
+      np->failed = menuShown;
+   }
+   StopProgram(np);
+
+   if(menuShown) {
+      UpdateDynamicMenus(np->command);
+   } else if(!np->ttl && !np->watch && np->output) {
+      Release(np->output);
+      np->output = NULL;
+   }
+}
+
+/** Stop programs that are taking too long. */
+void SignalDynamicMenus(const TimeType *now, int x, int y, Window w,
+                        void *data)
+{
+   DynamicNode *np;
+   for(np = nodes; np; np = np->next) {
+      if(np->fd >= 0 && now->seconds - np->generated.seconds >= np->timeout) {
+         Warning(_("timeout running included program: %s"),
+                 np->command + 5);
+         kill(-np->pid, SIGKILL);
+         StopProgram(np);
+         if(menuShown) {
+            np->failed = 1;
+            UpdateDynamicMenus(np->command);
+         }
+      }
+   }
+}
@@ -0,0 +1,46 @@
+/**
+ * @file dynmenu.h
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Header for dynamic menu generation.
+ *
+ */
+
+#ifndef DYNMENU_H
+#define DYNMENU_H
+
+struct Menu;
+
+/*@{*/
+#define InitializeDynamicMenus() (void)(0)
+#define StartupDynamicMenus()    (void)(0)
+void ShutdownDynamicMenus(void);
+void DestroyDynamicMenus(void);
+/*@}*/
+
+/** Set the caching options for a dynamic menu.
+ * @param command The include command for the menu.
+ * @param ttl Seconds to keep the program output (0 for no limit).
+ * @param timeout Seconds to wait for the program (0 for the default).
+ * @param watch File whose modification invalidates the output (or NULL).
+ */
+void SetDynamicMenuOptions(const char *command, unsigned int ttl,
+                           unsigned int timeout, const char *watch);
+
+/** Create a dynamic menu.
+ * Menus generated by a program are created from the cached program
+ * output if it is still valid. Otherwise the program is started and
+ * a placeholder menu is returned; the menu is replaced when the program
+ * completes.
+ * @param command The include command for the menu.
+ * @return The menu (NULL if the menu could not be created).
+ */
+struct Menu *CreateDynamicMenu(const char *command);
+
+/** Discard program output that is only kept while menus are open.
+ * This is called when the menus are closed.
+ */
+void ExpireDynamicMenus(void);
+
+#endif /* DYNMENU_H */
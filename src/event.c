@@ -25,15 +25,23 @@
 #include "swallow.h"
 #include "taskbar.h"
 #include "timing.h"
+#include "misc.h"
 #include "winmenu.h"
 #include "settings.h"
 #include "tray.h"
 #include "popup.h"
 #include "pager.h"
 #include "grab.h"
+#include "pool.h"
+#include "capture.h"
 
 #define MIN_TIME_DELTA 50
 
+/** Determine if a callback runs more often than MIN_TIME_DELTA allows.
+ * These callbacks pace interactive updates and are run on time.
+ */
+#define IS_PACED(cp) ((cp)->freq > 0 && (cp)->freq < MIN_TIME_DELTA)
+
 Time eventTime = CurrentTime;
 
 typedef struct CallbackNode {
@@ -45,8 +53,22 @@ typedef struct CallbackNode {
 } CallbackNode;
 
 static CallbackNode *callbacks = NULL;
+static ObjectPool callbackPool = OBJECT_POOL("callbacks", CallbackNode);
+
+typedef struct FileCallbackNode {
+   int fd;
+   FileCallback callback;
+   void *data;
+   struct FileCallbackNode *next;
+} FileCallbackNode;
+
+static FileCallbackNode *fileCallbacks = NULL;
+
+static InputHandlerType inputHandler = NULL;
+static InputCancelType inputCancel = NULL;
 
 static void Signal(void);
+static void SignalFiles(fd_set *fds);
 static void DispatchBorderButtonEvent(const XButtonEvent *event,
                                       ClientNode *np);
 
@@ -77,6 +99,7 @@ static void HandleNetWMState(const XClientMessageEvent *event,
 static void HandleFrameExtentsRequest(const XClientMessageEvent *event);
 static void UpdateState(ClientNode *np);
 static void DiscardEnterEvents();
+static void TakeEvent(const XEvent *event);
 
 #ifdef USE_SHAPE
 static void HandleShapeEvent(const XShapeEvent *event);
@@ -88,9 +111,12 @@ char WaitForEvent(XEvent *event)
 
    struct timeval timeout;
    CallbackNode *cp;
+   FileCallbackNode *fp;
+   TimeType now;
    fd_set fds;
    long sleepTime;
-   int fd;
+   int fd, maxfd;
+   int count;
    char handled;
 
 #ifdef ConnectionNumber
@@ -99,23 +125,41 @@ char WaitForEvent(XEvent *event)
    fd = JXConnectionNumber(display);
 #endif
 
-   /* Compute how long we should sleep. */
-   sleepTime = 10 * 1000;  /* 10 seconds. */
-   for(cp = callbacks; cp; cp = cp->next) {
-      if(cp->freq > 0 && cp->freq < sleepTime) {
-         sleepTime = cp->freq;
-      }
-   }
-
    do {
 
       while(JXPending(display) == 0) {
+
+         /* Sleep until the next callback is due. */
+         GetCurrentTime(&now);
+         sleepTime = 10 * 1000;  /* 10 seconds. */
+         for(cp = callbacks; cp; cp = cp->next) {
+            if(cp->freq > 0) {
+               const long remaining = (long)cp->freq
+                                    - (long)GetTimeDifference(&now, &cp->last);
+               const long minimum = IS_PACED(cp) ? 1 : MIN_TIME_DELTA;
+               sleepTime = Min(sleepTime, Max(remaining, minimum));
+            }
+         }
+
          FD_ZERO(&fds);
          FD_SET(fd, &fds);
+         maxfd = fd;
+         for(fp = fileCallbacks; fp; fp = fp->next) {
+            FD_SET(fp->fd, &fds);
+            maxfd = Max(maxfd, fp->fd);
+         }
          timeout.tv_sec = sleepTime / 1000;
          timeout.tv_usec = (sleepTime % 1000) * 1000;
-         if(select(fd + 1, &fds, NULL, NULL, &timeout) <= 0) {
-            Signal();
+         count = select(maxfd + 1, &fds, NULL, NULL, &timeout);
+         if(count > 0 && fileCallbacks) {
+            SignalFiles(&fds);
+         }
+         Signal();
+         if(JUNLIKELY(shouldReport)) {
+            shouldReport = 0;
+            ShowAllocations();
+            ShowXRequests();
+            FlushTimeline();
          }
          if(JUNLIKELY(shouldExit)) {
             return 0;
@@ -125,7 +169,8 @@ char WaitForEvent(XEvent *event)
       Signal();
 
       JXNextEvent(display, event);
-      UpdateTime(event);
+      TakeEvent(event);
+      BeginSpanValue("WaitForEvent", event->type);
 
       switch(event->type) {
       case ConfigureRequest:
@@ -203,6 +248,11 @@ char WaitForEvent(XEvent *event)
          } else if(haveShape && event->type == shapeEvent) {
             HandleShapeEvent((XShapeEvent*)event);
             handled = 1;
+#endif
+#ifdef USE_XSYNC
+         } else if(haveSync && event->type == syncEvent + XSyncAlarmNotify) {
+            HandleResizeSync((XSyncAlarmNotifyEvent*)event);
+            handled = 1;
 #endif
          } else {
             handled = 0;
@@ -222,6 +272,7 @@ char WaitForEvent(XEvent *event)
       if(!handled) {
          handled = ProcessPopupEvent(event);
       }
+      EndSpan();
 
    } while(handled && !shouldExit);
 
@@ -235,30 +286,73 @@ void Signal(void)
 
    static TimeType last = ZERO_TIME;
 
-   CallbackNode *cp;   
+   CallbackNode *cp;
+   CallbackNode *next;
    TimeType now;
    Window w;
    int x, y;
+   char pacedOnly;
 
+   /* Only paced callbacks run more often than MIN_TIME_DELTA. */
    GetCurrentTime(&now);
-   if(GetTimeDifference(&now, &last) < MIN_TIME_DELTA) {
-      return;
+   pacedOnly = GetTimeDifference(&now, &last) < MIN_TIME_DELTA;
+   if(pacedOnly) {
+      for(cp = callbacks; cp; cp = cp->next) {
+         if(IS_PACED(cp) && GetTimeDifference(&now, &cp->last) >= cp->freq) {
+            break;
+         }
+      }
+      if(!cp) {
+         return;
+      }
+   } else {
+      last = now;
    }
-   last = now;
 
    GetMousePosition(&x, &y, &w);
-   for(cp = callbacks; cp; cp = cp->next) {
+   BeginSpan("Signal");
+   for(cp = callbacks; cp; cp = next) {
+      next = cp->next;
+      if(pacedOnly && !IS_PACED(cp)) {
+         continue;
+      }
       if(cp->freq == 0 || GetTimeDifference(&now, &cp->last) >= cp->freq) {
          cp->last = now;
          (cp->callback)(&now, x, y, w, cp->data);
       }
    }
+   EndSpan();
+
+}
 
+/** Run callbacks for readable file descriptors. */
+void SignalFiles(fd_set *fds)
+{
+   FileCallbackNode *fp;
+
+   /* Callbacks may change the list, so start over after each one. */
+   fp = fileCallbacks;
+   while(fp) {
+      if(FD_ISSET(fp->fd, fds)) {
+         FD_CLR(fp->fd, fds);
+         (fp->callback)(fp->fd, fp->data);
+         fp = fileCallbacks;
+      } else {
+         fp = fp->next;
+      }
+   }
 }
 
 /** Process an event. */
 void ProcessEvent(XEvent *event)
 {
+   if(inputHandler) {
+      BeginSpanValue("InputHandler", event->type);
+      (inputHandler)(event);
+      EndSpan();
+      return;
+   }
+   BeginSpanValue("ProcessEvent", event->type);
    switch(event->type) {
    case ButtonPress:
    case ButtonRelease:
@@ -274,8 +368,9 @@ void ProcessEvent(XEvent *event)
       HandleEnterNotify(&event->xcrossing);
       break;
    case MotionNotify:
-      while(JXCheckTypedEvent(display, MotionNotify, event));
-      UpdateTime(event);
+      while(JXCheckTypedEvent(display, MotionNotify, event)) {
+         TakeEvent(event);
+      }
       HandleMotionNotify(&event->xmotion);
       break;
    case LeaveNotify:
@@ -287,6 +382,37 @@ void ProcessEvent(XEvent *event)
       Debug("Unknown event type: %d", event->type);
       break;
    }
+   EndSpan();
+}
+
+/** Set the input handler. */
+void SetInputHandler(InputHandlerType handler, InputCancelType cancel)
+{
+   Assert(!inputHandler);
+   inputHandler = handler;
+   inputCancel = cancel;
+}
+
+/** Remove the input handler. */
+void ClearInputHandler(void)
+{
+   inputHandler = NULL;
+   inputCancel = NULL;
+}
+
+/** Abort the active modal operation. */
+void CancelInputHandler(void)
+{
+   if(inputCancel) {
+      (inputCancel)();
+   }
+   ClearInputHandler();
+}
+
+/** Determine if a modal operation is active. */
+char HasInputHandler(void)
+{
+   return inputHandler != NULL;
 }
 
 /** Discard motion events for the specified window. */
@@ -295,7 +421,7 @@ void DiscardMotionEvents(XEvent *event, Window w)
    XEvent temp;
    JXSync(display, False);
    while(JXCheckTypedEvent(display, MotionNotify, &temp)) {
-      UpdateTime(&temp);
+      TakeEvent(&temp);
       SetMousePosition(temp.xmotion.x_root, temp.xmotion.y_root,
                        temp.xmotion.window);
       if(temp.xmotion.window == w) {
@@ -309,7 +435,7 @@ void DiscardKeyEvents(XEvent *event, Window w)
 {
    JXSync(display, False);
    while(JXCheckTypedWindowEvent(display, w, KeyPress, event)) {
-      UpdateTime(event);
+      TakeEvent(event);
    }
 }
 
@@ -319,7 +445,7 @@ void DiscardEnterEvents()
    XEvent event;
    JXSync(display, False);
    while(JXCheckMaskEvent(display, EnterWindowMask, &event)) {
-      UpdateTime(&event);
+      TakeEvent(&event);
       SetMousePosition(event.xmotion.x_root, event.xmotion.y_root,
                        event.xmotion.window);
    }
@@ -351,7 +477,7 @@ void HandleButtonEvent(const XButtonEvent *event)
       }
       DispatchBorderButtonEvent(event, np);
    } else if(event->window == rootWindow && event->type == ButtonPress) {
-      if(!ShowRootMenu(event->button, event->x, event->y)) {
+      if(!ShowRootMenu(event->button, event->x, event->y, NULL)) {
          if(event->button == Button4) {
             LeftDesktop();
          } else if(event->button == Button5) {
@@ -759,13 +885,9 @@ char HandlePropertyNotify(const XPropertyEvent *event)
          changed = 1;
          break;
       case XA_WM_HINTS:
-         if(np->state.status & STAT_URGENT) {
-            UnregisterCallback(SignalUrgent, np);
-         }
+         RemoveUrgentClient(np);
          ReadWMHints(np->window, &np->state, 1);
-         if(np->state.status & STAT_URGENT) {
-            RegisterCallback(URGENCY_DELAY, SignalUrgent, np);
-         }
+         AddUrgentClient(np);
          break;
       case XA_WM_TRANSIENT_FOR:
          JXGetTransientForHint(display, np->window, &np->owner);
@@ -1403,7 +1525,7 @@ void HandleUnmapNotify(const XUnmapEvent *event)
       }
 
       if(JXCheckTypedWindowEvent(display, np->window, DestroyNotify, &e)) {
-         UpdateTime(&e);
+         TakeEvent(&e);
          RemoveClient(np);
       } else if((np->state.status & STAT_MAPPED) || event->send_event) {
          np->state.status &= ~STAT_MAPPED;
@@ -1442,6 +1564,7 @@ void DispatchBorderButtonEvent(const XButtonEvent *event,
 
    static Time lastClickTime = 0;
    static int lastX = 0, lastY = 0;
+   static int lastClientX = 0, lastClientY = 0;
    static char doubleClickActive = 0;
    BorderActionType action;
    int bsize;
@@ -1479,18 +1602,21 @@ void DispatchBorderButtonEvent(const XButtonEvent *event,
                && event->time != lastClickTime
                && event->time - lastClickTime <= settings.doubleClickSpeed
                && abs(event->x - lastX) <= settings.doubleClickDelta
-               && abs(event->y - lastY) <= settings.doubleClickDelta) {
+               && abs(event->y - lastY) <= settings.doubleClickDelta
+               && np->x == lastClientX && np->y == lastClientY) {
                MaximizeClientDefault(np);
                doubleClickActive = 0;
             } else {
-               if(MoveClient(np, event->x, event->y)) {
-                  doubleClickActive = 0;
-               } else {
-                  doubleClickActive = 1;
-                  lastClickTime = event->time;
-                  lastX = event->x;
-                  lastY = event->y;
-               }
+               /* The move runs from the event loop, so a click that
+                * moved the window is detected by its position on the
+                * next press. */
+               doubleClickActive = 1;
+               lastClickTime = event->time;
+               lastX = event->x;
+               lastY = event->y;
+               lastClientX = np->x;
+               lastClientY = np->y;
+               MoveClient(np, event->x, event->y);
             }
          }
       } else if(event->button == Button3) {
@@ -1575,13 +1701,9 @@ void UpdateState(ClientNode *np)
 
    /* Read the state (and new layer). */
    alreadyMapped = (np->state.status & STAT_MAPPED) ? 1 : 0;
-   if(np->state.status & STAT_URGENT) {
-      UnregisterCallback(SignalUrgent, np);
-   }
+   RemoveUrgentClient(np);
    np->state = ReadWindowState(np->window, alreadyMapped);
-   if(np->state.status & STAT_URGENT) {
-      RegisterCallback(URGENCY_DELAY, SignalUrgent, np);
-   }
+   AddUrgentClient(np);
 
    /* We don't handle mapping the window, so restore its mapped state. */
    if(!alreadyMapped) {
@@ -1600,6 +1722,16 @@ void UpdateState(ClientNode *np)
 
 }
 
+/** Record an event removed from the queue and update the event time.
+ * This is used for every event JWM takes from the queue so that a
+ * capture contains the same events JWM processed.
+ */
+void TakeEvent(const XEvent *event)
+{
+   CaptureEvent(event);
+   UpdateTime(event);
+}
+
 /** Update the last event time. */
 void UpdateTime(const XEvent *event)
 {
@@ -1647,7 +1779,7 @@ void UpdateTime(const XEvent *event)
 void RegisterCallback(int freq, SignalCallback callback, void *data)
 {
    CallbackNode *cp;
-   cp = Allocate(sizeof(CallbackNode));
+   cp = AllocateObject(&callbackPool);
    cp->last.seconds = 0;
    cp->last.ms = 0;
    cp->freq = freq;
@@ -1657,6 +1789,20 @@ void RegisterCallback(int freq, SignalCallback callback, void *data)
    callbacks = cp;
 }
 
+/** Set the delay before the next run of a callback. */
+void SetCallbackDelay(SignalCallback callback, void *data, int delay)
+{
+   CallbackNode *cp;
+   for(cp = callbacks; cp; cp = cp->next) {
+      if(cp->callback == callback && cp->data == data) {
+         GetCurrentTime(&cp->last);
+         cp->freq = delay;
+         return;
+      }
+   }
+   Assert(0);
+}
+
 /** Unregister a callback. */
 void UnregisterCallback(SignalCallback callback, void *data)
 {
@@ -1665,6 +1811,33 @@ void UnregisterCallback(SignalCallback callback, void *data)
       if((*cp)->callback == callback && (*cp)->data == data) {
          CallbackNode *temp = *cp;
          *cp = (*cp)->next;
+         ReleaseObject(&callbackPool, temp);
+         return;
+      }
+   }
+   Assert(0);
+}
+
+/** Register a file descriptor callback. */
+void RegisterFileCallback(int fd, FileCallback callback, void *data)
+{
+   FileCallbackNode *fp;
+   fp = Allocate(sizeof(FileCallbackNode));
+   fp->fd = fd;
+   fp->callback = callback;
+   fp->data = data;
+   fp->next = fileCallbacks;
+   fileCallbacks = fp;
+}
+
+/** Unregister a file descriptor callback. */
+void UnregisterFileCallback(int fd)
+{
+   FileCallbackNode **fp;
+   for(fp = &fileCallbacks; *fp; fp = &(*fp)->next) {
+      if((*fp)->fd == fd) {
+         FileCallbackNode *temp = *fp;
+         *fp = (*fp)->next;
          Release(temp);
          return;
       }
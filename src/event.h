@@ -17,6 +17,18 @@ typedef void (*SignalCallback)(const struct TimeType *now,
                                Window w,
                                void *data);
 
+/** Callback for a readable file descriptor. */
+typedef void (*FileCallback)(int fd, void *data);
+
+/** Handler for input events during a modal operation (move, resize, menu).
+ * While a handler is set, all events not handled by WaitForEvent are
+ * passed to it instead of the normal event processing.
+ */
+typedef void (*InputHandlerType)(XEvent *event);
+
+/** Callback to abort the modal operation owning the input handler. */
+typedef void (*InputCancelType)(void);
+
 /** Last event time. */
 extern Time eventTime;
 
@@ -30,6 +42,27 @@ char WaitForEvent(XEvent *event);
  */
 void ProcessEvent(XEvent *event);
 
+/** Set the input handler.
+ * Modal operations use this to receive input from the main event loop
+ * rather than running an event loop of their own.
+ * @param handler The handler for input events.
+ * @param cancel Callback to abort the operation (for example, on exit).
+ */
+void SetInputHandler(InputHandlerType handler, InputCancelType cancel);
+
+/** Remove the input handler.
+ * This is called by the modal operation once it is finished.
+ */
+void ClearInputHandler(void);
+
+/** Abort the modal operation owning the input handler (if any). */
+void CancelInputHandler(void);
+
+/** Determine if a modal operation is active.
+ * @return 1 if an input handler is set, 0 otherwise.
+ */
+char HasInputHandler(void);
+
 /** Discard excess motion events.
  * @param event The event to return.
  * @param w The window whose events to discard.
@@ -48,17 +81,42 @@ void DiscardKeyEvents(XEvent *event, Window w);
 void UpdateTime(const XEvent *event);
 
 /** Register a callback.
+ * Callbacks run at most every 50 milliseconds unless the frequency is
+ * shorter than that, in which case they run on time.
  * @param freq The frequency in milliseconds.
  * @param callback The callback function.
  * @param data Data to pass to the callback.
  */
 void RegisterCallback(int freq, SignalCallback callback, void *data);
 
+/** Set the delay before the next run of a callback.
+ * The callback then runs with this delay as its frequency until the
+ * delay is set again, so a callback can schedule its own next run.
+ * @param callback The callback.
+ * @param data The data passed to the register function.
+ * @param delay The delay in milliseconds.
+ */
+void SetCallbackDelay(SignalCallback callback, void *data, int delay);
+
 /** Unregister a callback.
+ * A callback may unregister itself.
  * @param callback The callback to remove.
  * @param data The data passed to the register function.
  */
 void UnregisterCallback(SignalCallback callback, void *data);
 
+/** Register a callback to run when a file descriptor is readable.
+ * @param fd The file descriptor.
+ * @param callback The callback function.
+ * @param data Data to pass to the callback.
+ */
+void RegisterFileCallback(int fd, FileCallback callback, void *data);
+
+/** Unregister a file descriptor callback.
+ * A callback may unregister itself.
+ * @param fd The file descriptor passed to the register function.
+ */
+void UnregisterFileCallback(int fd);
+
 #endif /* EVENT_H */
 
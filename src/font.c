@@ -24,15 +24,86 @@
 
 #ifdef USE_XFT
 static const char *DEFAULT_FONT = "FreeSans-9";
+static const char *ELLIPSIS = "\xe2\x80\xa6";
 #else
 static const char *DEFAULT_FONT = "fixed";
+static const char *ELLIPSIS = "...";
 #endif
 
+/** Number of strings to keep in the text cache. */
+#define TEXT_CACHE_SIZE    256
+
+/** Number of buckets in the text cache hash table (power of 2). */
+#define TEXT_HASH_SIZE     128
+
+/** Visual-order text and its width for a font and string. */
+typedef struct TextNode {
+   char *str;                 /**< The string as passed in (key). */
+   char *logical;             /**< The logical-order UTF-8 string. */
+   int length;                /**< Length of logical in bytes. */
+   char *output;              /**< The visual-order UTF-8 string (the
+                               *   same as logical without bidi). */
+   int outputLength;          /**< Length of output in bytes. */
+   int width;                 /**< Width of output in pixels (-1 if not
+                               *   measured yet). */
+   int fitWidth;              /**< Available width of the last fit
+                               *   (INT_MIN if none). */
+   char *fitOutput;           /**< Visual-order text shown at fitWidth
+                               *   (output or an ellipsized copy). */
+   int fitLength;             /**< Length of fitOutput in bytes. */
+   int fitPixels;             /**< Width of fitOutput in pixels. */
+   FontType font;             /**< The font (key). */
+   struct TextNode *bucket;   /**< Next node in the hash bucket. */
+   struct TextNode *prev;     /**< More recently used node. */
+   struct TextNode *next;     /**< Less recently used node. */
+} TextNode;
+
+/** Number of drawables to keep rendering state for. */
+#define DRAW_CACHE_SIZE    16
+
+/** Rendering state kept for a drawable. */
+typedef struct DrawNode {
+   Drawable drawable;         /**< The drawable (None if unused). */
+   unsigned long lastUsed;    /**< Use counter for replacement. */
+#ifdef USE_XFT
+   XftDraw *xd;               /**< Xft draw handle. */
+#else
+   GC gc;                     /**< GC for the drawable. */
+   Font fid;                  /**< Font currently set on the GC. */
+#endif
+} DrawNode;
+
 static char *GetUTF8String(const char *str);
 static void ReleaseUTF8String(char *utf8String);
 
+static DrawNode *GetDrawNode(const VisualData *visual, Drawable d);
+static void ReleaseDrawNode(DrawNode *dp);
+
+static TextNode *GetText(FontType font, const char *str);
+static TextNode *CreateText(FontType font, const char *str);
+#ifdef USE_FRIBIDI
+static char *ReorderText(const char *str, int len);
+#endif
+static void SetFit(TextNode *tp, char *output, int length, int pixels);
+static int GetTextWidth(TextNode *tp);
+static void FitText(TextNode *tp, int width);
+static int MeasureText(FontType font, const char *str, int len);
+static void RemoveText(TextNode *tp);
+static void ClearTextCache(void);
+static unsigned int GetTextHash(FontType font, const char *str);
+
 static char *fontNames[FONT_COUNT];
 
+static TextNode *textHash[TEXT_HASH_SIZE];
+static TextNode *textHead = NULL;
+static TextNode *textTail = NULL;
+static unsigned int textCount = 0;
+static unsigned long textHits = 0;
+static unsigned long textMisses = 0;
+
+static DrawNode drawCache[DRAW_CACHE_SIZE];
+static unsigned long drawCounter = 0;
+
 #ifdef USE_ICONV
 static const char *UTF8_CODESET = "UTF-8";
 static iconv_t fromUTF8 = (iconv_t)-1;
@@ -57,6 +128,12 @@ void InitializeFonts(void)
       fonts[x] = NULL;
       fontNames[x] = NULL;
    }
+   for(x = 0; x < TEXT_HASH_SIZE; x++) {
+      textHash[x] = NULL;
+   }
+   for(x = 0; x < DRAW_CACHE_SIZE; x++) {
+      drawCache[x].drawable = None;
+   }
 
    /* Allocate a conversion descriptor if we're not using UTF-8. */
 #ifdef USE_ICONV
@@ -137,6 +214,12 @@ void StartupFonts(void)
 void ShutdownFonts(void)
 {
    unsigned int x;
+   Debug("text cache: %lu hits, %lu misses, %u entries",
+         textHits, textMisses, textCount);
+   ClearTextCache();
+   for(x = 0; x < DRAW_CACHE_SIZE; x++) {
+      ReleaseDrawNode(&drawCache[x]);
+   }
    for(x = 0; x < FONT_COUNT; x++) {
       if(fonts[x]) {
 #ifdef USE_XFT
@@ -240,59 +323,18 @@ void ReleaseUTF8String(char *utf8String)
 /** Get the width of a string. */
 int GetStringWidth(FontType ft, const char *str)
 {
-#ifdef USE_XFT
-   XGlyphInfo extents;
-#endif
-#ifdef USE_FRIBIDI
-   FriBidiChar *temp_i;
-   FriBidiChar *temp_o;
-   FriBidiParType type = FRIBIDI_PAR_ON;
-   int unicodeLength;
-#endif
-   int len;
-   char *output;
-   int result;
-   char *utf8String;
-
-   /* Convert to UTF-8 if necessary. */
-   utf8String = GetUTF8String(str);
-
-   /* Length of the UTF-8 string. */
-   len = strlen(utf8String);
-
-   /* Apply the bidi algorithm if requested. */
-#ifdef USE_FRIBIDI
-   temp_i = AllocateStack((len + 1) * sizeof(FriBidiChar));
-   temp_o = AllocateStack((len + 1) * sizeof(FriBidiChar));
-   unicodeLength = fribidi_charset_to_unicode(FRIBIDI_CHAR_SET_UTF8,
-                                              utf8String, len, temp_i);
-   fribidi_log2vis(temp_i, unicodeLength, &type, temp_o, NULL, NULL, NULL);
-   output = AllocateStack(4 * len + 1);
-   fribidi_unicode_to_charset(FRIBIDI_CHAR_SET_UTF8, temp_o, unicodeLength,
-                              (char*)output);
-   len = strlen(output);
-#else
-   output = utf8String;
-#endif
-
-   /* Get the width of the string. */
-#ifdef USE_XFT
-   JXftTextExtentsUtf8(display, fonts[ft], (const unsigned char*)output,
-                       len, &extents);
-   result = extents.xOff;
-#else
-   result = XTextWidth(fonts[ft], output, len);
-#endif
-
-   /* Clean up. */
-#ifdef USE_FRIBIDI
-   ReleaseStack(temp_i);
-   ReleaseStack(temp_o);
-   ReleaseStack(output);
-#endif
-   ReleaseUTF8String(utf8String);
+   return GetTextWidth(GetText(ft, str));
+}
 
-   return result;
+/** Get the width of a string as rendered in a limited width. */
+int GetFittedStringWidth(FontType ft, const char *str, int max)
+{
+   TextNode *tp = GetText(ft, str);
+   FitText(tp, max);
+   if(tp->fitOutput != tp->output) {
+      return max;
+   }
+   return tp->fitPixels;
 }
 
 /** Get the height of a string. */
@@ -321,105 +363,437 @@ void RenderString(const VisualData *visual, Drawable d,
                   int x, int y, int width, const char *str)
 {
    XRectangle rect;
-   Region renderRegion;
-   int len;
-   char *output;
-#ifdef USE_FRIBIDI
-   FriBidiChar *temp_i;
-   FriBidiChar *temp_o;
-   FriBidiParType type = FRIBIDI_PAR_ON;
-   int unicodeLength;
-#endif
-#ifdef USE_XFT
-   XftDraw *xd;
-   XGlyphInfo extents;
-#else
-   XGCValues gcValues;
-   unsigned long gcMask;
-   GC gc;
-#endif
-   char *utf8String;
+   TextNode *tp;
+   DrawNode *dp;
 
    /* Early return for empty strings. */
    if(!str || !str[0]) {
       return;
    }
 
-   /* Convert to UTF-8 if necessary. */
-   utf8String = GetUTF8String(str);
+   tp = GetText(font, str);
+   dp = GetDrawNode(visual, d);
+
+   /* Determine how much of the string fits. */
+   FitText(tp, width);
+
+   /* Get the bounds for the string based on the specified width. */
+   rect.x = x;
+   rect.y = y;
+   rect.height = GetStringHeight(font);
+   rect.width = Max(width, 0) + 2;
+
+   /* Display the string. */
+#ifdef USE_XFT
+   JXftDrawSetClipRectangles(dp->xd, 0, 0, &rect, 1);
+   JXftDrawStringUtf8(dp->xd, GetXftColor(color), fonts[font],
+                      x, y + fonts[font]->ascent,
+                      (const unsigned char*)tp->fitOutput, tp->fitLength);
+#else
+   JXSetForeground(display, dp->gc, colors[color]);
+   JXSetClipRectangles(display, dp->gc, 0, 0, &rect, 1, Unsorted);
+   if(dp->fid != fonts[font]->fid) {
+      JXSetFont(display, dp->gc, fonts[font]->fid);
+      dp->fid = fonts[font]->fid;
+   }
+   JXDrawString(display, d, dp->gc, x, y + fonts[font]->ascent,
+                tp->fitOutput, tp->fitLength);
+#endif
+
+}
+
+/** Release the rendering state kept for a drawable. */
+void ReleaseStringDrawable(Drawable d)
+{
+   unsigned int x;
+   for(x = 0; x < DRAW_CACHE_SIZE; x++) {
+      if(drawCache[x].drawable == d) {
+         ReleaseDrawNode(&drawCache[x]);
+         break;
+      }
+   }
+}
+
+/** Get the rendering state for a drawable, creating it if needed.
+ * When the cache is full, the least recently used entry is replaced.
+ */
+DrawNode *GetDrawNode(const VisualData *visual, Drawable d)
+{
+
+   DrawNode *dp;
+   unsigned int x;
+#ifndef USE_XFT
+   XGCValues gcValues;
+#endif
 
-   /* Get the length of the UTF-8 string. */
-   len = strlen(utf8String);
+   drawCounter += 1;
 
+   dp = &drawCache[0];
+   for(x = 0; x < DRAW_CACHE_SIZE; x++) {
+      if(drawCache[x].drawable == d) {
+         drawCache[x].lastUsed = drawCounter;
+         return &drawCache[x];
+      }
+      if(drawCache[x].drawable == None) {
+         if(dp->drawable != None) {
+            dp = &drawCache[x];
+         }
+      } else if(dp->drawable != None
+                && drawCache[x].lastUsed < dp->lastUsed) {
+         dp = &drawCache[x];
+      }
+   }
+
+   ReleaseDrawNode(dp);
+   dp->drawable = d;
+   dp->lastUsed = drawCounter;
 #ifdef USE_XFT
-   xd = XftDrawCreate(display, d, visual->visual, rootColormap);
+   dp->xd = JXftDrawCreate(display, d, visual->visual, rootColormap);
 #else
-   gcMask = GCGraphicsExposures;
    gcValues.graphics_exposures = False;
-   gc = JXCreateGC(display, d, gcMask, &gcValues);
+   dp->gc = JXCreateGC(display, d, GCGraphicsExposures, &gcValues);
+   dp->fid = None;
 #endif
+   return dp;
+
+}
+
+/** Free the rendering state held by a cache entry. */
+void ReleaseDrawNode(DrawNode *dp)
+{
+   if(dp->drawable != None) {
+#ifdef USE_XFT
+      JXftDrawDestroy(dp->xd);
+#else
+      JXFreeGC(display, dp->gc);
+#endif
+      dp->drawable = None;
+   }
+}
+
+/** Get the visual-order text and width for a string.
+ * Results are kept in a small LRU cache since the same strings
+ * (titles, menu labels, the clock) are measured and drawn repeatedly.
+ */
+TextNode *GetText(FontType font, const char *str)
+{
+
+   const unsigned int index = GetTextHash(font, str);
+   TextNode *tp;
+
+   for(tp = textHash[index]; tp; tp = tp->bucket) {
+      if(tp->font == font && !strcmp(tp->str, str)) {
+         break;
+      }
+   }
 
+   if(tp) {
+      textHits += 1;
+      if(tp == textHead) {
+         return tp;
+      }
+      /* Unlink so the node can be moved to the front. */
+      tp->prev->next = tp->next;
+      if(tp->next) {
+         tp->next->prev = tp->prev;
+      } else {
+         textTail = tp->prev;
+      }
+   } else {
+      textMisses += 1;
+      if(textCount >= TEXT_CACHE_SIZE) {
+         RemoveText(textTail);
+      }
+      tp = CreateText(font, str);
+      tp->bucket = textHash[index];
+      textHash[index] = tp;
+      textCount += 1;
+   }
+
+   /* Make this the most recently used node. */
+   tp->prev = NULL;
+   tp->next = textHead;
+   if(textHead) {
+      textHead->prev = tp;
+   } else {
+      textTail = tp;
+   }
+   textHead = tp;
+
+   return tp;
+
+}
+
+/** Convert a string for the text cache. */
+TextNode *CreateText(FontType font, const char *str)
+{
+   TextNode *tp;
+   char *utf8String;
+
+   tp = Allocate(sizeof(TextNode));
+   tp->str = CopyString(str);
+   tp->font = font;
+
+   /* Convert to UTF-8 if necessary. */
+   utf8String = GetUTF8String(str);
+   tp->logical = CopyString(utf8String);
+   tp->length = strlen(tp->logical);
+   ReleaseUTF8String(utf8String);
 
    /* Apply the bidi algorithm if requested. */
 #ifdef USE_FRIBIDI
+   tp->output = ReorderText(tp->logical, tp->length);
+   tp->outputLength = strlen(tp->output);
+#else
+   tp->output = tp->logical;
+   tp->outputLength = tp->length;
+#endif
+
+   /* The width is measured when first needed. */
+   tp->width = -1;
+   tp->fitWidth = INT_MIN;
+   tp->fitOutput = tp->output;
+   tp->fitLength = tp->outputLength;
+   tp->fitPixels = 0;
+
+   return tp;
+
+}
+
+#ifdef USE_FRIBIDI
+/** Convert the first len bytes of a logical-order UTF-8 string to
+ * visual order.
+ */
+char *ReorderText(const char *str, int len)
+{
+   char *result;
+   FriBidiChar *temp_i;
+   FriBidiChar *temp_o;
+   FriBidiParType type = FRIBIDI_PAR_ON;
+   int unicodeLength;
+
    temp_i = AllocateStack((len + 1) * sizeof(FriBidiChar));
    temp_o = AllocateStack((len + 1) * sizeof(FriBidiChar));
    unicodeLength = fribidi_charset_to_unicode(FRIBIDI_CHAR_SET_UTF8,
-                                              utf8String, len, temp_i);
+                                              (char*)str, len, temp_i);
    fribidi_log2vis(temp_i, unicodeLength, &type, temp_o, NULL, NULL, NULL);
-   output = AllocateStack(4 * len + 1);
+   result = Allocate(4 * len + 1);
    fribidi_unicode_to_charset(FRIBIDI_CHAR_SET_UTF8, temp_o, unicodeLength,
-                              (char*)output);
-   len = strlen(output);
-#else
-   output = utf8String;
-#endif
+                              result);
+   ReleaseStack(temp_i);
+   ReleaseStack(temp_o);
+   return result;
+}
+#endif /* USE_FRIBIDI */
 
-   /* Get the bounds for the string based on the specified width. */
-   rect.x = x;
-   rect.y = y;
-   rect.height = GetStringHeight(font);
-#ifdef USE_XFT
-   JXftTextExtentsUtf8(display, fonts[font], (const unsigned char*)output,
-                       len, &extents);
-   rect.width = extents.xOff;
-#else
-   rect.width = XTextWidth(fonts[font], output, len);
+/** Get the width of cached text. */
+int GetTextWidth(TextNode *tp)
+{
+   if(tp->width < 0) {
+      tp->width = MeasureText(tp->font, tp->output, tp->outputLength);
+   }
+   return tp->width;
+}
+
+/** Set the text shown at the current fit width. */
+void SetFit(TextNode *tp, char *output, int length, int pixels)
+{
+   if(tp->fitOutput != tp->output) {
+      Release(tp->fitOutput);
+   }
+   tp->fitOutput = output;
+   tp->fitLength = length;
+   tp->fitPixels = pixels;
+}
+
+/** Determine how much of a string can be shown in the specified width.
+ * If the whole string does not fit, the longest logical-order prefix
+ * that fits along with an ellipsis is reordered for display, so right
+ * to left text loses its end rather than its start. Prefixes are
+ * measured with an exponential then binary search that stops at the
+ * first prefix wider than the available width, so only about as much
+ * text as can be shown is ever measured.
+ */
+void FitText(TextNode *tp, int width)
+{
+
+   const char *str = tp->logical;
+   const int ellipsisLength = strlen(ELLIPSIS);
+   char *output;
+#ifdef USE_FRIBIDI
+   char *temp;
 #endif
-   rect.width = Min(rect.width, width) + 2;
+   int low, high, lowPixels;
+   int chars, advance;
+   int pos, x, pixels;
+   int ellipsis;
+
+   if(tp->fitWidth == width) {
+      return;
+   }
+   tp->fitWidth = width;
 
-   /* Combine the width bounds with the region to use. */
-   renderRegion = XCreateRegion();
-   XUnionRectWithRegion(&rect, renderRegion, renderRegion);
+   /* Short cut if the width is already known. */
+   if(tp->width >= 0 && tp->width <= width) {
+      SetFit(tp, tp->output, tp->outputLength, tp->width);
+      return;
+   }
 
-   /* Display the string. */
+   ellipsis = MeasureText(tp->font, ELLIPSIS, ellipsisLength);
+
+   /* Measure prefixes, starting with the number of characters that must
+    * fit and doubling, until one is wider than the available width or
+    * the whole string fits. Remember the longest prefix that fits along
+    * with an ellipsis (low) and the shortest that does not (high). */
 #ifdef USE_XFT
-   JXftDrawSetClip(xd, renderRegion);
-   JXftDrawStringUtf8(xd, GetXftColor(color), fonts[font],
-                      x, y + fonts[font]->ascent,
-                      (const unsigned char*)output, len);
-   JXftDrawChange(xd, rootWindow);
+   advance = fonts[tp->font]->max_advance_width;
 #else
-   JXSetForeground(display, gc, colors[color]);
-   JXSetRegion(display, gc, renderRegion);
-   JXSetFont(display, gc, fonts[font]->fid);
-   JXDrawString(display, d, gc, x, y + fonts[font]->ascent, output, len);
+   advance = fonts[tp->font]->max_bounds.width;
 #endif
+   chars = width / Max(advance, 1);
+   chars = Max(chars, 1);
+   low = 0;
+   lowPixels = 0;
+   high = -1;
+   pos = 0;
+   for(;;) {
+
+      /* Advance pos to the end of the chars-th character. */
+      for(x = 0; x < chars && pos < tp->length; x++) {
+         pos += 1;
+         while(pos < tp->length && (str[pos] & 0xC0) == 0x80) {
+            pos += 1;
+         }
+      }
 
-   /* Free any memory used for UTF conversion. */
+      if(pos >= tp->length) {
+         pixels = GetTextWidth(tp);
+         if(pixels <= width) {
+            SetFit(tp, tp->output, tp->outputLength, pixels);
+            return;
+         }
+      } else {
+         pixels = MeasureText(tp->font, str, pos);
+      }
+      if(pixels + ellipsis <= width) {
+         low = pos;
+         lowPixels = pixels;
+      } else if(high < 0) {
+         high = pos;
+      }
+      if(pixels > width || pos >= tp->length) {
+         break;
+      }
+      chars *= 2;
+
+   }
+
+   /* Binary search for the longest prefix that fits with an ellipsis. */
+   for(;;) {
+      pos = (low + high) / 2;
+      while(pos > low && (str[pos] & 0xC0) == 0x80) {
+         pos -= 1;
+      }
+      if(pos == low) {
+         /* Try the character following low. */
+         pos += 1;
+         while(pos < high && (str[pos] & 0xC0) == 0x80) {
+            pos += 1;
+         }
+         if(pos >= high) {
+            break;
+         }
+      }
+      pixels = MeasureText(tp->font, str, pos);
+      if(pixels + ellipsis > width) {
+         high = pos;
+      } else {
+         low = pos;
+         lowPixels = pixels;
+      }
+   }
+
+   /* Add the ellipsis in logical order and reorder the result. */
+   output = Allocate(low + ellipsisLength + 1);
+   memcpy(output, str, low);
+   memcpy(&output[low], ELLIPSIS, ellipsisLength);
+   output[low + ellipsisLength] = 0;
 #ifdef USE_FRIBIDI
-   ReleaseStack(temp_i);
-   ReleaseStack(temp_o);
-   ReleaseStack(output);
+   temp = output;
+   output = ReorderText(temp, low + ellipsisLength);
+   Release(temp);
 #endif
-   ReleaseUTF8String(utf8String);
+   SetFit(tp, output, strlen(output), lowPixels + ellipsis);
 
-   XDestroyRegion(renderRegion);
+}
 
+/** Measure the width of the first len bytes of a string. */
+int MeasureText(FontType font, const char *str, int len)
+{
 #ifdef USE_XFT
-   XftDrawDestroy(xd);
+   XGlyphInfo extents;
+   JXftTextExtentsUtf8(display, fonts[font], (const unsigned char*)str,
+                       len, &extents);
+   return extents.xOff;
 #else
-   JXFreeGC(display, gc);
+   return XTextWidth(fonts[font], str, len);
 #endif
+}
 
+/** Remove a node from the text cache. */
+void RemoveText(TextNode *tp)
+{
+
+   TextNode **bp;
+
+   bp = &textHash[GetTextHash(tp->font, tp->str)];
+   while(*bp != tp) {
+      bp = &(*bp)->bucket;
+   }
+   *bp = tp->bucket;
+
+   if(tp->prev) {
+      tp->prev->next = tp->next;
+   } else {
+      textHead = tp->next;
+   }
+   if(tp->next) {
+      tp->next->prev = tp->prev;
+   } else {
+      textTail = tp->prev;
+   }
+
+   SetFit(tp, NULL, 0, 0);
+   if(tp->output != tp->logical) {
+      Release(tp->output);
+   }
+   Release(tp->logical);
+   Release(tp->str);
+   Release(tp);
+   textCount -= 1;
+
+}
+
+/** Remove everything from the text cache.
+ * Cached widths depend on the loaded fonts, so this is done whenever
+ * the fonts are released.
+ */
+void ClearTextCache(void)
+{
+   while(textHead) {
+      RemoveText(textHead);
+   }
+   textHits = 0;
+   textMisses = 0;
+}
+
+/** Get the text cache hash for a font and string. */
+unsigned int GetTextHash(FontType font, const char *str)
+{
+   unsigned int hash = font;
+   unsigned int x;
+   for(x = 0; str[x]; x++) {
+      hash = (hash + (hash << 5)) ^ (unsigned int)str[x];
+   }
+   return hash & (TEXT_HASH_SIZE - 1);
 }
@@ -51,6 +51,13 @@ void RenderString(const struct VisualData *visual, Drawable d,
                   FontType font, ColorType color,
                   int x, int y, int width, const char *str);
 
+/** Release the rendering state kept for a drawable.
+ * RenderString keeps per-drawable state between calls; this should be
+ * called before freeing a drawable that strings were rendered to.
+ * @param d The drawable.
+ */
+void ReleaseStringDrawable(Drawable d);
+
 /** Get the width of a string.
  * @param ft The font used to determine the width.
  * @param str The string whose width to get.
@@ -58,6 +65,16 @@ void RenderString(const struct VisualData *visual, Drawable d,
  */
 int GetStringWidth(FontType ft, const char *str);
 
+/** Get the width of a string as rendered in a limited width.
+ * Only as much of the string as fits is measured, so this is cheaper
+ * than GetStringWidth for long strings in a small space.
+ * @param ft The font used to determine the width.
+ * @param str The string whose width to get.
+ * @param max The maximum width allowed.
+ * @return The width of the string if it fits, otherwise max.
+ */
+int GetFittedStringWidth(FontType ft, const char *str, int max);
+
 /** Get the height of a string.
  * @param ft The font used to determine the height.
  * @return The height in pixels.
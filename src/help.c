@@ -64,6 +64,9 @@ void DisplayCompileOptions(void)
 #endif
 #ifdef USE_XRENDER
           "xrender "
+#endif
+#ifdef USE_XSYNC
+          "xsync "
 #endif
           "\nsystem configuration: " SYSTEM_CONFIG "\n");
 }
@@ -72,7 +75,8 @@ void DisplayCompileOptions(void)
 void DisplayHelp(void)
 {
    DisplayUsage();
-   printf("  -display X  Set the X display to use\n"
+   printf("  -capture F  Record the X events received to file F\n"
+          "  -display X  Set the X display to use\n"
           "  -exit       Exit JWM (send _JWM_EXIT to the root)\n"
           "  -f file     Use specified configuration file\n"
           "  -h          Display this help message\n"
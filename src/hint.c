@@ -154,6 +154,9 @@ static const AtomNode atomList[] = {
    { &atoms[ATOM_NET_WM_STRUT],              "_NET_WM_STRUT"               },
    { &atoms[ATOM_NET_WM_WINDOW_OPACITY],     &opacityAtom[0]               },
    { &atoms[ATOM_NET_WM_MOVERESIZE],         "_NET_WM_MOVERESIZE"          },
+   { &atoms[ATOM_NET_WM_SYNC_REQUEST],       "_NET_WM_SYNC_REQUEST"        },
+   { &atoms[ATOM_NET_WM_SYNC_REQUEST_COUNTER],
+      "_NET_WM_SYNC_REQUEST_COUNTER"},
    { &atoms[ATOM_NET_SYSTEM_TRAY_OPCODE],    "_NET_SYSTEM_TRAY_OPCODE"     },
 
    { &atoms[ATOM_MOTIF_WM_HINTS],            "_MOTIF_WM_HINTS"             },
@@ -180,6 +183,7 @@ void StartupHints(void)
    Window win;
    unsigned int x;
    unsigned int count;
+   unsigned int supportedCount;
 
    /* Determine how much space we will need on the stack and allocate it. */
    count = 0;
@@ -205,9 +209,16 @@ void StartupHints(void)
    for(x = FIRST_NET_ATOM; x <= LAST_NET_ATOM; x++) {
       supported[x - FIRST_NET_ATOM] = atoms[x];
    }
+   supportedCount = LAST_NET_ATOM - FIRST_NET_ATOM + 1;
+#ifdef USE_XSYNC
+   if(haveSync) {
+      supported[supportedCount++] = atoms[ATOM_NET_WM_SYNC_REQUEST];
+      supported[supportedCount++] = atoms[ATOM_NET_WM_SYNC_REQUEST_COUNTER];
+   }
+#endif
    JXChangeProperty(display, rootWindow, atoms[ATOM_NET_SUPPORTED],
                     XA_ATOM, 32, PropModeReplace, (unsigned char*)supported,
-                    LAST_NET_ATOM - FIRST_NET_ATOM + 1);
+                    supportedCount);
 
    /* _NET_NUMBER_OF_DESKTOPS */
    SetCardinalAtom(rootWindow, ATOM_NET_NUMBER_OF_DESKTOPS,
@@ -772,6 +783,7 @@ void ReadWMProtocols(Window w, ClientState *state)
 
    state->status &= ~STAT_TAKEFOCUS;
    state->status &= ~STAT_DELETE;
+   state->status &= ~STAT_SYNC;
    status = JXGetWindowProperty(display, w, atoms[ATOM_WM_PROTOCOLS],
                                 0, 32, False, XA_ATOM, &realType, &realFormat,
                                 &count, &extra, &temp);
@@ -785,6 +797,8 @@ void ReadWMProtocols(Window w, ClientState *state)
          state->status |= STAT_DELETE;
       } else if(p[x] == atoms[ATOM_WM_TAKE_FOCUS]) {
          state->status |= STAT_TAKEFOCUS;
+      } else if(p[x] == atoms[ATOM_NET_WM_SYNC_REQUEST]) {
+         state->status |= STAT_SYNC;
       }
    }
 
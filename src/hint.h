@@ -102,6 +102,8 @@ typedef enum {
    ATOM_NET_WM_WINDOW_OPACITY,
    ATOM_NET_WM_STRUT,
    ATOM_NET_WM_MOVERESIZE,
+   ATOM_NET_WM_SYNC_REQUEST,
+   ATOM_NET_WM_SYNC_REQUEST_COUNTER,
 
    ATOM_NET_SYSTEM_TRAY_OPCODE,
 
@@ -16,6 +16,7 @@
 #include "misc.h"
 #include "hint.h"
 #include "color.h"
+#include "pool.h"
 
 IconNode emptyIcon;
 
@@ -26,12 +27,20 @@ IconNode emptyIcon;
 /* Must be a power of two. */
 #define HASH_SIZE 128
 
+/** Size of the storage kept for scaling icons. */
+#define ICON_ARENA_SIZE 65536
+
 /** Linked list of icon paths. */
 typedef struct IconPathNode {
    char *path;
    struct IconPathNode *next;
 } IconPathNode;
 
+static PoolStats iconArenaStats = POOL_STATS("icon scaling");
+static ObjectPool iconPool = OBJECT_POOL("icons", IconNode);
+ObjectPool scaledIconPool = OBJECT_POOL("scaled icons", ScaledIconNode);
+MemoryArena iconArena = MEMORY_ARENA(&iconArenaStats, ICON_ARENA_SIZE);
+
 static int iconSize = 0;
 static IconNode **iconHash;
 static IconPathNode *iconPaths;
@@ -46,8 +55,10 @@ static IconNode *GetDefaultIcon(void);
 static IconNode *CreateIconFromData(const char *name, char **data);
 static IconNode *CreateIconFromFile(const char *fileName,
                                     char save, char preserveAspect);
+#ifndef BENCHMARK
 static IconNode *CreateIconFromBinary(const unsigned long *data,
                                       unsigned int length);
+#endif
 static IconNode *LoadNamedIconHelper(const char *name, const char *path,
                                      char save, char preserveAspect);
 
@@ -56,8 +67,10 @@ static IconNode *LoadSuffixedIcon(const char *path, const char *name,
                                   const char *suffix);
 #endif
 
+#ifndef BENCHMARK
 static ScaledIconNode *GetScaledIcon(IconNode *icon, long fg,
                                      int width, int height);
+#endif
 
 static void InsertIcon(IconNode *icon);
 static IconNode *FindIcon(const char *name);
@@ -115,6 +128,7 @@ void DestroyIcons(void)
       Release(iconHash);
       iconHash = NULL;
    }
+   DestroyArena(&iconArena);
 }
 
 /** Set the preferred icon sizes on the root window. */
@@ -249,7 +263,9 @@ void LoadIcon(ClientNode *np)
    np->icon = NULL;
 
    /* Attempt to read _NET_WM_ICON for an icon */
+   BeginSpan("ReadNetWMIcon");
    ReadNetWMIcon(np);
+   EndSpan();
    if(np->icon) {
       return;
    }
@@ -321,7 +337,9 @@ IconNode *LoadSuffixedIcon(const char *path, const char *name,
       return result;
    }
 
+   BeginSpan("LoadImage");
    image = LoadImage(iconName);
+   EndSpan();
    if(image) {
       result = CreateIcon();
       result->name = iconName;
@@ -451,7 +469,9 @@ IconNode *CreateIconFromFile(const char *fileName,
       return result;
    }
 
+   BeginSpan("LoadImage");
    image = LoadImage(fileName);
+   EndSpan();
    if(image) {
       result = CreateIcon();
       result->preserveAspect = preserveAspect;
@@ -542,7 +562,7 @@ ScaledIconNode *GetScaledIcon(IconNode *icon, long fg,
 #endif
 
    /* Create a new ScaledIconNode the old-fashioned way. */
-   np = Allocate(sizeof(ScaledIconNode));
+   np = AllocateObject(&scaledIconPool);
    np->fg = fg;
    np->width = nwidth;
    np->height = nheight;
@@ -562,13 +582,14 @@ ScaledIconNode *GetScaledIcon(IconNode *icon, long fg,
    /* Create a temporary XImage for scaling. */
    image = JXCreateImage(display, rootVisual.visual, rootVisual.depth,
                          ZPixmap, 0, NULL, nwidth, nheight, 8, 0);
-   image->data = Allocate(sizeof(unsigned long) * nwidth * nheight);
+   image->data = AllocateArena(&iconArena,
+                               sizeof(unsigned long) * nwidth * nheight);
 
    /* Determine the scale factor. */
    scalex = (icon->image->width << 16) / nwidth;
    scaley = (icon->image->height << 16) / nheight;
 
-   points = Allocate(sizeof(XPoint) * nwidth);
+   points = AllocateArena(&iconArena, sizeof(XPoint) * nwidth);
    data = icon->image->data;
    srcy = 0;
    for(y = 0; y < nheight; y++) {
@@ -608,7 +629,6 @@ ScaledIconNode *GetScaledIcon(IconNode *icon, long fg,
       JXDrawPoints(display, np->mask, maskGC, points, pindex, CoordModeOrigin);
       srcy += scaley;
    }
-   Release(points);
 
    /* Release the mask GC. */
    JXFreeGC(display, maskGC);
@@ -620,9 +640,9 @@ ScaledIconNode *GetScaledIcon(IconNode *icon, long fg,
    /* Render the image to the color data pixmap. */
    JXPutImage(display, np->image, rootGC, image, 0, 0, 0, 0, nwidth, nheight);   
    /* Release the XImage. */
-   Release(image->data);
    image->data = NULL;
    JXDestroyImage(image);
+   ResetArena(&iconArena);
 
    return np;
 
@@ -682,7 +702,7 @@ IconNode *CreateIconFromBinary(const unsigned long *input,
 IconNode *CreateIcon(void)
 {
    IconNode *icon;
-   icon = Allocate(sizeof(IconNode));
+   icon = AllocateObject(&iconPool);
    icon->name = NULL;
    icon->image = NULL;
    icon->nodes = NULL;
@@ -716,7 +736,7 @@ void DoDestroyIcon(int index, IconNode *icon)
             JXFreePixmap(display, icon->nodes->mask);
          }
 
-         Release(icon->nodes);
+         ReleaseObject(&scaledIconPool, icon->nodes);
          icon->nodes = np;
       }
 
@@ -733,7 +753,7 @@ void DoDestroyIcon(int index, IconNode *icon)
       if(icon->next) {
          icon->next->prev = icon->prev;
       }
-      Release(icon);
+      ReleaseObject(&iconPool, icon);
    }
 }
 
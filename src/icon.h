@@ -48,6 +48,14 @@ typedef struct IconNode {
 
 extern IconNode emptyIcon;
 
+/** Pool for scaled icons. */
+extern struct ObjectPool scaledIconPool;
+
+/** Storage for image data while an icon is being scaled.
+ * This is reset after each scaled icon is created.
+ */
+extern struct MemoryArena iconArena;
+
 #ifdef USE_ICONS
 
 /*@{*/
@@ -96,6 +104,30 @@ IconNode *LoadNamedIcon(const char *name, char save, char preserveAspect);
  */
 void DestroyIcon(IconNode *icon);
 
+#ifdef BENCHMARK
+
+/* These are only exported for the microbenchmarks. */
+
+/** Create an icon from _NET_WM_ICON data.
+ * @param data The icon data (width, height, then ARGB pixels).
+ * @param length The number of elements in data.
+ * @return The icon (NULL if the data is invalid).
+ */
+IconNode *CreateIconFromBinary(const unsigned long *data,
+                               unsigned int length);
+
+/** Get a scaled version of an icon, creating it if needed.
+ * @param icon The icon.
+ * @param fg The foreground color.
+ * @param width The width.
+ * @param height The height.
+ * @return The scaled icon.
+ */
+ScaledIconNode *GetScaledIcon(IconNode *icon, long fg,
+                              int width, int height);
+
+#endif /* BENCHMARK */
+
 #else
 
 #define ICON_DUMMY_FUNCTION ((void)0)
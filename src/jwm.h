@@ -18,6 +18,7 @@
 #  include <stdlib.h>
 #  include <ctype.h>
 #  include <limits.h>
+#  include <errno.h>
 
    /* Ideally png.h would be included in image.c, which is the only
     * file that references it. Unfortunately, if setjmp.h is included
@@ -58,6 +59,18 @@
 #  ifdef HAVE_SYS_SELECT_H
 #     include <sys/select.h>
 #  endif
+#  ifdef HAVE_FCNTL_H
+#     include <fcntl.h>
+#  endif
+#  ifdef HAVE_SYS_STAT_H
+#     include <sys/stat.h>
+#  endif
+#  ifdef HAVE_SYS_MMAN_H
+#     include <sys/mman.h>
+#  endif
+#  ifdef HAVE_SPAWN_H
+#     include <spawn.h>
+#  endif
 
 #  include <X11/Xlib.h>
 #  ifdef HAVE_X11_XUTIL_H
@@ -83,6 +96,10 @@
 #     include <X11/extensions/shape.h>
 #  endif
 
+#  ifdef USE_XSYNC
+#     include <X11/extensions/sync.h>
+#  endif
+
 #  ifdef USE_XMU
 #     include <X11/Xmu/Xmu.h>
 #  endif
@@ -123,6 +140,10 @@
 #define MOVE_DELTA         3     /**< Pixels before trigging a move. */
 #define RESTART_DELAY      1000  /**< Max timeout in ms before restarting. */
 #define URGENCY_DELAY      500   /**< Flash timeout in ms for urgency. */
+#define SYNC_TIMEOUT       1000  /**< Max time in ms to wait for a client
+                                  *   to acknowledge a sync request. */
+#define CONFIGURE_DELAY    100   /**< Pointer idle time in ms before a
+                                  *   move/resize sends ConfigureNotify. */
 
 #define SHELL_NAME "/bin/sh"
 
@@ -142,6 +163,7 @@
 #endif
 
 #include "debug.h"
+#include "timeline.h"
 #include "jxlib.h"
 
 #endif /* JWM_H */
@@ -0,0 +1,243 @@
+/**
+ * @file jxlib.c
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief X call accounting.
+ *
+ * With -DTRACE_X, the JX macros report each call here. Calls are
+ * counted by X function and by source location so that the code
+ * generating traffic can be found. Calls that wait for a reply are
+ * timed, as is the time the server is held grabbed.
+ *
+ */
+
+#include "jwm.h"
+
+#ifdef TRACE_X
+
+/** Number of call site buckets (must be a power of two). */
+#define XTRACE_HASH_SIZE 512
+
+/** Statistics for an X function called at one place in the code. */
+typedef struct XTraceSite {
+   const char *name;          /**< X function. */
+   const char *file;
+   unsigned int line;
+   int kind;                  /**< XTRACE_REQUEST, XTRACE_REPLY, etc. */
+   unsigned long calls;       /**< Calls since the last report. */
+   double waited;             /**< Seconds waiting for replies. */
+   double held;               /**< Seconds the server was held grabbed. */
+   struct XTraceSite *next;
+} XTraceSite;
+
+static XTraceSite *sites[XTRACE_HASH_SIZE];
+static unsigned int siteCount = 0;
+static XTraceSite *waiting = NULL;
+static struct timeval waitStart;
+static XTraceSite *grabbing = NULL;
+static struct timeval grabStart;
+static struct timeval lastReport;
+
+static XTraceSite *GetTraceSite(const char *name, int kind,
+                                const char *file, unsigned int line);
+static double GetElapsed(const struct timeval *start);
+static void StopWaiting(void);
+static int CompareSiteCalls(const void *a, const void *b);
+static int CompareSiteNames(const void *a, const void *b);
+
+/** Count a call. */
+void XTRACE_Call(const char *name, int kind,
+                 const char *file, unsigned int line)
+{
+   XTraceSite *sp = GetTraceSite(name, kind, file, line);
+   sp->calls += 1;
+   switch(kind) {
+   case XTRACE_REPLY:
+      StopWaiting();
+      BeginSpan(name);
+      waiting = sp;
+      gettimeofday(&waitStart, NULL);
+      break;
+   case XTRACE_GRAB:
+      if(!grabbing) {
+         grabbing = sp;
+         gettimeofday(&grabStart, NULL);
+      }
+      break;
+   case XTRACE_UNGRAB:
+      if(grabbing) {
+         grabbing->held += GetElapsed(&grabStart);
+         grabbing = NULL;
+      }
+      break;
+   default:
+      break;
+   }
+}
+
+/** Stop timing a call that returns an integer. */
+int XTRACE_ReplyInt(int result)
+{
+   StopWaiting();
+   return result;
+}
+
+/** Stop timing a call that returns an XID. */
+unsigned long XTRACE_ReplyLong(unsigned long result)
+{
+   StopWaiting();
+   return result;
+}
+
+/** Stop timing a call that returns a pointer. */
+void *XTRACE_ReplyPointer(void *result)
+{
+   StopWaiting();
+   return result;
+}
+
+/** Show statistics collected since the last report and reset them. */
+void XTRACE_Show(void)
+{
+   XTraceSite **list;
+   XTraceSite *sp;
+   unsigned long calls, replies;
+   double waited, held, elapsed;
+   unsigned int x, count, first;
+
+   elapsed = lastReport.tv_sec ? GetElapsed(&lastReport) : 0.0;
+   gettimeofday(&lastReport, NULL);
+
+   list = Allocate((siteCount + 1) * sizeof(XTraceSite*));
+   count = 0;
+   calls = 0;
+   replies = 0;
+   waited = 0.0;
+   held = 0.0;
+   for(x = 0; x < XTRACE_HASH_SIZE; x++) {
+      for(sp = sites[x]; sp; sp = sp->next) {
+         if(sp->calls > 0) {
+            list[count++] = sp;
+            calls += sp->calls;
+            replies += sp->kind == XTRACE_REPLY ? sp->calls : 0;
+            waited += sp->waited;
+            held += sp->held;
+         }
+      }
+   }
+
+   fprintf(stderr, "XTRACE: %lu calls, %lu round trips in %.1f s\n",
+           calls, replies, elapsed);
+   fprintf(stderr, "XTRACE: %.1f ms waiting, %.1f ms grabbed\n",
+           waited * 1000.0, held * 1000.0);
+
+   /* Totals by X function. */
+   qsort(list, count, sizeof(XTraceSite*), CompareSiteNames);
+   fprintf(stderr, "XTRACE: %10s %10s %10s  function\n",
+           "calls", "wait ms", "grab ms");
+   first = 0;
+   while(first < count) {
+      calls = 0;
+      waited = 0.0;
+      held = 0.0;
+      for(x = first; x < count; x++) {
+         if(strcmp(list[x]->name, list[first]->name)) {
+            break;
+         }
+         calls += list[x]->calls;
+         waited += list[x]->waited;
+         held += list[x]->held;
+      }
+      fprintf(stderr, "XTRACE: %10lu %10.1f %10.1f  %s%s\n",
+              calls, waited * 1000.0, held * 1000.0, list[first]->name,
+              list[first]->kind == XTRACE_REPLY ? " (round trip)" : "");
+      first = x;
+   }
+
+   /* Calls by source location. */
+   qsort(list, count, sizeof(XTraceSite*), CompareSiteCalls);
+   fprintf(stderr, "XTRACE: %10s %10s %10s  site\n",
+           "calls", "wait ms", "grab ms");
+   for(x = 0; x < count; x++) {
+      sp = list[x];
+      fprintf(stderr, "XTRACE: %10lu %10.1f %10.1f  %s[%u]: %s\n",
+              sp->calls, sp->waited * 1000.0, sp->held * 1000.0,
+              sp->file, sp->line, sp->name);
+      sp->calls = 0;
+      sp->waited = 0.0;
+      sp->held = 0.0;
+   }
+
+   Release(list);
+}
+
+/** Get the statistics for an X function called from a location. */
+XTraceSite *GetTraceSite(const char *name, int kind,
+                         const char *file, unsigned int line)
+{
+   XTraceSite *sp;
+   size_t hash;
+
+   hash = ((size_t)file >> 3) ^ (line * 2654435761u);
+   hash = (hash ^ (hash >> 13)) & (XTRACE_HASH_SIZE - 1);
+   for(sp = sites[hash]; sp; sp = sp->next) {
+      if(sp->line == line && sp->name == name && sp->file == file) {
+         return sp;
+      }
+   }
+
+   /* These are kept for the life of the process (they are never
+    * released so that they do not show up as leaks). */
+   sp = malloc(sizeof(XTraceSite));
+   Assert(sp);
+   memset(sp, 0, sizeof(XTraceSite));
+   sp->name = name;
+   sp->kind = kind;
+   sp->file = file;
+   sp->line = line;
+   sp->next = sites[hash];
+   sites[hash] = sp;
+   siteCount += 1;
+   return sp;
+}
+
+/** Get the seconds elapsed since a time. */
+double GetElapsed(const struct timeval *start)
+{
+   struct timeval now;
+   gettimeofday(&now, NULL);
+   return (double)(now.tv_sec - start->tv_sec)
+        + (double)(now.tv_usec - start->tv_usec) / 1000000.0;
+}
+
+/** Stop timing the call waiting for a reply. */
+void StopWaiting(void)
+{
+   if(waiting) {
+      waiting->waited += GetElapsed(&waitStart);
+      waiting = NULL;
+      EndSpan();
+   }
+}
+
+/** Order sites by number of calls, most first. */
+int CompareSiteCalls(const void *a, const void *b)
+{
+   const XTraceSite *sa = *(const XTraceSite**)a;
+   const XTraceSite *sb = *(const XTraceSite**)b;
+   if(sa->calls != sb->calls) {
+      return sa->calls < sb->calls ? 1 : -1;
+   }
+   return sa->waited < sb->waited ? 1 : (sa->waited > sb->waited ? -1 : 0);
+}
+
+/** Order sites by X function. */
+int CompareSiteNames(const void *a, const void *b)
+{
+   const XTraceSite *sa = *(const XTraceSite**)a;
+   const XTraceSite *sb = *(const XTraceSite**)b;
+   return strcmp(sa->name, sb->name);
+}
+
+#endif /* TRACE_X */
@@ -5,467 +5,637 @@
  *
  * @brief Macros to wrap X calls for debugging.
  *
+ * When compiled with -DTRACE_X, each call is counted by X function and
+ * by source location. Calls that wait for a reply from the server are
+ * timed, as is the time the server is held grabbed.
+ *
  */
 
 #ifndef JXLIB_H
 #define JXLIB_H
 
+#ifdef TRACE_X
+
+/** Kinds of traced calls. */
+#  define XTRACE_REQUEST   0  /**< Call that does not wait. */
+#  define XTRACE_REPLY     1  /**< Call that waits for a reply. */
+#  define XTRACE_GRAB      2  /**< Server grab. */
+#  define XTRACE_UNGRAB    3  /**< Server ungrab. */
+
+#  define XTRACE_CALL( n, k ) \
+      ( SetCheckpoint(), XTRACE_Call( n, k, __FILE__, __LINE__ ) )
+
+/* Count a call (the name is a string so it is not expanded). */
+#  define JXTRACE( f )                XTRACE_CALL( #f, XTRACE_REQUEST )
+#  define JXTRACE_REPLY( f )          XTRACE_CALL( #f, XTRACE_REPLY )
+#  define JXTRACE_GRAB( f )           XTRACE_CALL( #f, XTRACE_GRAB )
+#  define JXTRACE_UNGRAB( f )         XTRACE_CALL( #f, XTRACE_UNGRAB )
+
+/* Stop timing a call that waits for a reply, passing its result. */
+#  define JXTRACE_INT( x )            XTRACE_ReplyInt( x )
+#  define JXTRACE_LONG( x )           XTRACE_ReplyLong( x )
+#  define JXTRACE_POINTER( t, x )     ((t)XTRACE_ReplyPointer( x ))
+
+/** Show X call statistics collected since the last time. */
+#  define ShowXRequests()             XTRACE_Show()
+
+   void XTRACE_Call(const char*, int, const char*, unsigned int);
+   int XTRACE_ReplyInt(int);
+   unsigned long XTRACE_ReplyLong(unsigned long);
+   void *XTRACE_ReplyPointer(void*);
+   void XTRACE_Show(void);
+
+#else /* TRACE_X */
+
+#  define JXTRACE( f )                SetCheckpoint()
+#  define JXTRACE_REPLY( f )          SetCheckpoint()
+#  define JXTRACE_GRAB( f )           SetCheckpoint()
+#  define JXTRACE_UNGRAB( f )         SetCheckpoint()
+
+#  define JXTRACE_INT( x )            ( x )
+#  define JXTRACE_LONG( x )           ( x )
+#  define JXTRACE_POINTER( t, x )     ( x )
+
+#  define ShowXRequests()             ((void)0)
+
+#endif /* TRACE_X */
+
 #define JXAddToSaveSet( a, b ) \
-   ( SetCheckpoint(), XAddToSaveSet( a, b ) )
+   ( JXTRACE( XAddToSaveSet ), XAddToSaveSet( a, b ) )
 
 #define JXAllocColor( a, b, c ) \
-   ( SetCheckpoint(), XAllocColor( a, b, c ) )
+   ( JXTRACE_REPLY( XAllocColor ), JXTRACE_INT( XAllocColor( a, b, c ) ) )
 
 #define JXGetRGBColormaps( a, b, c, d, e ) \
-   ( SetCheckpoint(), XGetRGBColormaps( a, b, c, d, e ) )
+   ( \
+      JXTRACE_REPLY( XGetRGBColormaps ), \
+      JXTRACE_INT( XGetRGBColormaps( a, b, c, d, e ) ) \
+   )
 
 #define JXQueryColor( a, b, c ) \
-   ( SetCheckpoint(), XQueryColor( a, b, c ) )
+   ( JXTRACE_REPLY( XQueryColor ), JXTRACE_INT( XQueryColor( a, b, c ) ) )
 
 #define JXAllowEvents( a, b, c ) \
-   ( SetCheckpoint(), XAllowEvents( a, b, c ) )
+   ( JXTRACE( XAllowEvents ), XAllowEvents( a, b, c ) )
 
 #define JXChangeProperty( a, b, c, d, e, f, g, h ) \
-   ( SetCheckpoint(), XChangeProperty( a, b, c, d, e, f, g, h ) )
+   ( JXTRACE( XChangeProperty ), XChangeProperty( a, b, c, d, e, f, g, h ) )
 
 #define JXDeleteProperty( a, b, c ) \
-   ( SetCheckpoint(), XDeleteProperty( a, b, c ) )
+   ( JXTRACE( XDeleteProperty ), XDeleteProperty( a, b, c ) )
 
 #define JXChangeWindowAttributes( a, b, c, d ) \
-   ( SetCheckpoint(), XChangeWindowAttributes( a, b, c, d ) )
+   ( \
+      JXTRACE( XChangeWindowAttributes ), \
+      XChangeWindowAttributes( a, b, c, d ) \
+   )
 
 #define JXCheckTypedEvent( a, b, c ) \
-   ( SetCheckpoint(), XCheckTypedEvent( a, b, c ) )
+   ( JXTRACE( XCheckTypedEvent ), XCheckTypedEvent( a, b, c ) )
 
 #define JXCheckTypedWindowEvent( a, b, c, d ) \
-   ( SetCheckpoint(), XCheckTypedWindowEvent( a, b, c, d ) )
+   ( JXTRACE( XCheckTypedWindowEvent ), XCheckTypedWindowEvent( a, b, c, d ) )
 
 #define JXClearWindow( a, b ) \
-   ( SetCheckpoint(), XClearWindow( a, b ) )
+   ( JXTRACE( XClearWindow ), XClearWindow( a, b ) )
 
 #define JXClearArea( a, b, c, d, e, f, g ) \
-   ( SetCheckpoint(), XClearArea( a, b, c, d, e, f, g ) )
+   ( JXTRACE( XClearArea ), XClearArea( a, b, c, d, e, f, g ) )
 
 #define JXCloseDisplay( a ) \
-   ( SetCheckpoint(), XCloseDisplay( a ) )
+   ( JXTRACE( XCloseDisplay ), XCloseDisplay( a ) )
 
 #define JXConfigureWindow( a, b, c, d ) \
-   ( SetCheckpoint(), XConfigureWindow( a, b, c, d ) )
+   ( JXTRACE( XConfigureWindow ), XConfigureWindow( a, b, c, d ) )
 
 #define JXConnectionNumber( a ) \
-   ( SetCheckpoint(), XConnectionNumber( a ) )
+   ( JXTRACE( XConnectionNumber ), XConnectionNumber( a ) )
 
 #define JXCopyArea( a, b, c, d, e, f, g, h, i, j ) \
-   ( SetCheckpoint(), XCopyArea( a, b, c, d, e, f, g, h, i, j ) )
+   ( JXTRACE( XCopyArea ), XCopyArea( a, b, c, d, e, f, g, h, i, j ) )
 
 #define JXCopyPlane( a, b, c, d, e, f, g, h, i, j, k ) \
-   ( SetCheckpoint(), XCopyPlane( a, b, c, d, e, f, g, h, i, j, k ) )
+   ( JXTRACE( XCopyPlane ), XCopyPlane( a, b, c, d, e, f, g, h, i, j, k ) )
 
 #define JXCreateFontCursor( a, b ) \
-   ( SetCheckpoint(), XCreateFontCursor( a, b ) )
+   ( JXTRACE( XCreateFontCursor ), XCreateFontCursor( a, b ) )
 
 #define JXCreateGC( a, b, c, d ) \
-   ( SetCheckpoint(), XCreateGC( a, b, c, d ) )
+   ( JXTRACE( XCreateGC ), XCreateGC( a, b, c, d ) )
 
 #define JXCreateImage( a, b, c, d, e, f, g, h, i, j ) \
-   ( \
-      SetCheckpoint(), \
-      XCreateImage( a, b, c, d, e, f, g, h, i, j ) \
-   )
+   ( JXTRACE( XCreateImage ), XCreateImage( a, b, c, d, e, f, g, h, i, j ) )
 
 #define JXCreatePixmap( a, b, c, d, e ) \
-   ( SetCheckpoint(), XCreatePixmap( a, b, c, d, e ) )
+   ( JXTRACE( XCreatePixmap ), XCreatePixmap( a, b, c, d, e ) )
 
 #define JXCreatePixmapFromBitmapData( a, b, c, d, e, f, g, h ) \
    ( \
-      SetCheckpoint(), \
+      JXTRACE( XCreatePixmapFromBitmapData ), \
       XCreatePixmapFromBitmapData( a, b, c, d, e, f, g, h ) \
    )
 
 #define JXCreateBitmapFromData( a, b, c, d, e ) \
-   ( SetCheckpoint(), XCreateBitmapFromData( a, b, c, d, e ) )
+   ( JXTRACE( XCreateBitmapFromData ), XCreateBitmapFromData( a, b, c, d, e ) )
 
 #define JXCreateSimpleWindow( a, b, c, d, e, f, g, h, i ) \
    ( \
-      SetCheckpoint(), \
+      JXTRACE( XCreateSimpleWindow ), \
       XCreateSimpleWindow( a, b, c, d, e, f, g, h, i ) \
    )
 
 #define JXCreateWindow( a, b, c, d, e, f, g, h, i, j, k, l ) \
    ( \
-      SetCheckpoint(), \
+      JXTRACE( XCreateWindow ), \
       XCreateWindow( a, b, c, d, e, f, g, h, i, j, k, l ) \
    )
 
 #define JXDefineCursor( a, b, c ) \
-   ( SetCheckpoint(), XDefineCursor( a, b, c ) )
+   ( JXTRACE( XDefineCursor ), XDefineCursor( a, b, c ) )
 
 #define JXDestroyImage( a ) \
-   ( SetCheckpoint(), XDestroyImage( a ) )
+   ( JXTRACE( XDestroyImage ), XDestroyImage( a ) )
 
 #define JXDestroyWindow( a, b ) \
-   ( SetCheckpoint(), XDestroyWindow( a, b ) )
+   ( JXTRACE( XDestroyWindow ), XDestroyWindow( a, b ) )
 
 #define JXDrawPoint( a, b, c, d, e ) \
-   ( SetCheckpoint(), XDrawPoint( a, b, c, d, e ) )
+   ( JXTRACE( XDrawPoint ), XDrawPoint( a, b, c, d, e ) )
 
 #define JXDrawPoints( a, b, c, d, e, f ) \
-   ( SetCheckpoint(), XDrawPoints( a, b, c, d, e, f ) )
+   ( JXTRACE( XDrawPoints ), XDrawPoints( a, b, c, d, e, f ) )
 
 #define JXDrawLine( a, b, c, d, e, f, g ) \
-   ( SetCheckpoint(), XDrawLine( a, b, c, d, e, f, g ) )
+   ( JXTRACE( XDrawLine ), XDrawLine( a, b, c, d, e, f, g ) )
 
 #define JXDrawSegments( a, b, c, d, e ) \
-   ( SetCheckpoint(), XDrawSegments( a, b, c, d, e ) )
+   ( JXTRACE( XDrawSegments ), XDrawSegments( a, b, c, d, e ) )
 
 #define JXDrawRectangle( a, b, c, d, e, f, g ) \
-   ( SetCheckpoint(), XDrawRectangle( a, b, c, d, e, f, g ) )
+   ( JXTRACE( XDrawRectangle ), XDrawRectangle( a, b, c, d, e, f, g ) )
 
 #define JXFillRectangles( a, b, c, d, e ) \
-   ( SetCheckpoint(), XFillRectangles( a, b, c, d, e ) )
+   ( JXTRACE( XFillRectangles ), XFillRectangles( a, b, c, d, e ) )
 
 #define JXDrawArcs( a, b, c, d, e ) \
-   ( SetCheckpoint(), XDrawArcs( a, b, c, d, e ) )
+   ( JXTRACE( XDrawArcs ), XDrawArcs( a, b, c, d, e ) )
 
 #define JXFillArcs( a, b, c, d, e ) \
-   ( SetCheckpoint(), XFillArcs( a, b, c, d, e ) )
+   ( JXTRACE( XFillArcs ), XFillArcs( a, b, c, d, e ) )
 
 #define JXSetLineAttributes( a, b, c, d, e, f ) \
-   ( SetCheckpoint(), XSetLineAttributes( a, b, c, d, e, f ) )
+   ( JXTRACE( XSetLineAttributes ), XSetLineAttributes( a, b, c, d, e, f ) )
 
 #define JXDrawString( a, b, c, d, e, f, g ) \
-   ( SetCheckpoint(), XDrawString( a, b, c, d, e, f, g ) )
+   ( JXTRACE( XDrawString ), XDrawString( a, b, c, d, e, f, g ) )
 
 #define JXFetchName( a, b, c ) \
-   ( SetCheckpoint(), XFetchName( a, b, c ) )
+   ( JXTRACE_REPLY( XFetchName ), JXTRACE_INT( XFetchName( a, b, c ) ) )
 
 #define JXFillRectangle( a, b, c, d, e, f, g ) \
-   ( SetCheckpoint(), XFillRectangle( a, b, c, d, e, f, g ) )
+   ( JXTRACE( XFillRectangle ), XFillRectangle( a, b, c, d, e, f, g ) )
 
 #define JXFlush( a ) \
-   ( SetCheckpoint(), XFlush( a ) )
+   ( JXTRACE( XFlush ), XFlush( a ) )
 
 #define JXFree( a ) \
-   ( SetCheckpoint(), XFree( a ) )
+   ( JXTRACE( XFree ), XFree( a ) )
 
 #define JXFreeColors( a, b, c, d, e ) \
-   ( SetCheckpoint(), XFreeColors( a, b, c, d, e ) )
+   ( JXTRACE( XFreeColors ), XFreeColors( a, b, c, d, e ) )
 
 #define JXFreeCursor( a, b ) \
-   ( SetCheckpoint(), XFreeCursor( a, b ) )
+   ( JXTRACE( XFreeCursor ), XFreeCursor( a, b ) )
 
 #define JXFreeFont( a, b ) \
-   ( SetCheckpoint(), XFreeFont( a, b ) )
+   ( JXTRACE( XFreeFont ), XFreeFont( a, b ) )
 
 #define JXFreeGC( a, b ) \
-   ( SetCheckpoint(), XFreeGC( a, b ) )
+   ( JXTRACE( XFreeGC ), XFreeGC( a, b ) )
 
 #define JXFreeModifiermap( a ) \
-   ( SetCheckpoint(), XFreeModifiermap( a ) )
+   ( JXTRACE( XFreeModifiermap ), XFreeModifiermap( a ) )
 
 #define JXFreePixmap( a, b ) \
-   ( SetCheckpoint(), XFreePixmap( a, b ) )
+   ( JXTRACE( XFreePixmap ), XFreePixmap( a, b ) )
 
 #define JXGetAtomName( a, b ) \
-   ( SetCheckpoint(), XGetAtomName( a, b ) )
+   ( \
+      JXTRACE_REPLY( XGetAtomName ), \
+      JXTRACE_POINTER( char*, XGetAtomName( a, b ) ) \
+   )
 
 #define JXGetModifierMapping( a ) \
-   ( SetCheckpoint(), XGetModifierMapping( a ) )
+   ( \
+      JXTRACE_REPLY( XGetModifierMapping ), \
+      JXTRACE_POINTER( XModifierKeymap*, XGetModifierMapping( a ) ) \
+   )
 
 #define JXGetSubImage( a, b, c, d, e, f, g, h, i, j, k ) \
-   ( SetCheckpoint(), XGetSubImage( a, b, c, d, e, f, g, h, i, j, k ) )
+   ( \
+      JXTRACE_REPLY( XGetSubImage ), \
+      JXTRACE_POINTER( XImage*, \
+         XGetSubImage( a, b, c, d, e, f, g, h, i, j, k ) ) \
+   )
 
 #define JXGetTransientForHint( a, b, c ) \
-   ( SetCheckpoint(), XGetTransientForHint( a, b, c ) )
+   ( \
+      JXTRACE_REPLY( XGetTransientForHint ), \
+      JXTRACE_INT( XGetTransientForHint( a, b, c ) ) \
+   )
 
 #define JXGetClassHint( a, b, c ) \
-   ( SetCheckpoint(), XGetClassHint( a, b, c ) )
+   ( JXTRACE_REPLY( XGetClassHint ), JXTRACE_INT( XGetClassHint( a, b, c ) ) )
 
 #define JXGetWindowAttributes( a, b, c ) \
-   ( SetCheckpoint(), XGetWindowAttributes( a, b, c ) )
+   ( \
+      JXTRACE_REPLY( XGetWindowAttributes ), \
+      JXTRACE_INT( XGetWindowAttributes( a, b, c ) ) \
+   )
 
 #define JXGetWindowProperty( a, b, c, d, e, f, g, h, i, j, k, l ) \
-   ( SetCheckpoint(), \
-   XGetWindowProperty( a, b, c, d, e, f, g, h, i, j, k, l ) )
+   ( \
+      JXTRACE_REPLY( XGetWindowProperty ), \
+      JXTRACE_INT( XGetWindowProperty( a, b, c, d, e, f, g, h, i, j, k, l ) ) \
+   )
+
+#define JXListProperties( a, b, c ) \
+   ( \
+      JXTRACE_REPLY( XListProperties ), \
+      JXTRACE_POINTER( Atom*, XListProperties( a, b, c ) ) \
+   )
 
 #define JXGetWMColormapWindows( a, b, c, d ) \
-   ( SetCheckpoint(), XGetWMColormapWindows( a, b, c, d ) )
+   ( \
+      JXTRACE_REPLY( XGetWMColormapWindows ), \
+      JXTRACE_INT( XGetWMColormapWindows( a, b, c, d ) ) \
+   )
 
 #define JXGetWMNormalHints( a, b, c, d ) \
-   ( SetCheckpoint(), XGetWMNormalHints( a, b, c, d ) )
+   ( \
+      JXTRACE_REPLY( XGetWMNormalHints ), \
+      JXTRACE_INT( XGetWMNormalHints( a, b, c, d ) ) \
+   )
 
 #define JXSetIconSizes( a, b, c, d ) \
-   ( SetCheckpoint(), XSetIconSizes( a, b, c, d ) )
+   ( JXTRACE( XSetIconSizes ), XSetIconSizes( a, b, c, d ) )
 
 #define JXSetWindowBorder( a, b, c ) \
-   ( SetCheckpoint(), XSetWindowBorder( a, b, c ) )
+   ( JXTRACE( XSetWindowBorder ), XSetWindowBorder( a, b, c ) )
 
 #define JXGetWMHints( a, b ) \
-   ( SetCheckpoint(), XGetWMHints( a, b ) )
+   ( \
+      JXTRACE_REPLY( XGetWMHints ), \
+      JXTRACE_POINTER( XWMHints*, XGetWMHints( a, b ) ) \
+   )
 
 #define JXGrabButton( a, b, c, d, e, f, g, h, i, j ) \
-   ( SetCheckpoint(), XGrabButton( a, b, c, d, e, f, g, h, i, j ) )
+   ( JXTRACE( XGrabButton ), XGrabButton( a, b, c, d, e, f, g, h, i, j ) )
 
 #define JXKeycodeToKeysym( a, b, c ) \
-   ( SetCheckpoint(), XKeycodeToKeysym( a, b, c ) )
+   ( JXTRACE( XKeycodeToKeysym ), XKeycodeToKeysym( a, b, c ) )
 
 #define JXGrabKey( a, b, c, d, e, f, g ) \
-   ( SetCheckpoint(), XGrabKey( a, b, c, d, e, f, g ) )
+   ( JXTRACE( XGrabKey ), XGrabKey( a, b, c, d, e, f, g ) )
 
 #define JXUngrabKey( a, b, c, d ) \
-   ( SetCheckpoint(), XUngrabKey( a, b, c, d ) )
+   ( JXTRACE( XUngrabKey ), XUngrabKey( a, b, c, d ) )
 
 #define JXGrabKeyboard( a, b, c, d, e, f ) \
-   ( SetCheckpoint(), XGrabKeyboard( a, b, c, d, e, f ) )
+   ( \
+      JXTRACE_REPLY( XGrabKeyboard ), \
+      JXTRACE_INT( XGrabKeyboard( a, b, c, d, e, f ) ) \
+   )
 
 #define JXGrabPointer( a, b, c, d, e, f, g, h, i ) \
-   ( SetCheckpoint(), XGrabPointer( a, b, c, d, e, f, g, h, i ) )
+   ( \
+      JXTRACE_REPLY( XGrabPointer ), \
+      JXTRACE_INT( XGrabPointer( a, b, c, d, e, f, g, h, i ) ) \
+   )
 
 #define JXGrabServer( a ) \
-   ( SetCheckpoint(), XGrabServer( a ) )
+   ( JXTRACE_GRAB( XGrabServer ), XGrabServer( a ) )
 
 #define JXInstallColormap( a, b ) \
-   ( SetCheckpoint(), XInstallColormap( a, b ) )
+   ( JXTRACE( XInstallColormap ), XInstallColormap( a, b ) )
 
 #define JXInternAtom( a, b, c ) \
-   ( SetCheckpoint(), XInternAtom( a, b, c ) )
+   ( JXTRACE_REPLY( XInternAtom ), JXTRACE_LONG( XInternAtom( a, b, c ) ) )
 
 #define JXKeysymToKeycode( a, b ) \
-   ( SetCheckpoint(), XKeysymToKeycode( a, b ) )
+   ( JXTRACE( XKeysymToKeycode ), XKeysymToKeycode( a, b ) )
 
 #define JXKillClient( a, b ) \
-   ( SetCheckpoint(), XKillClient( a, b ) )
+   ( JXTRACE( XKillClient ), XKillClient( a, b ) )
 
 #define JXLoadQueryFont( a, b ) \
-   ( SetCheckpoint(), XLoadQueryFont( a, b ) )
+   ( \
+      JXTRACE_REPLY( XLoadQueryFont ), \
+      JXTRACE_POINTER( XFontStruct*, XLoadQueryFont( a, b ) ) \
+   )
 
 #define JXMapRaised( a, b ) \
-   ( SetCheckpoint(), XMapRaised( a, b ) )
+   ( JXTRACE( XMapRaised ), XMapRaised( a, b ) )
 
 #define JXMapWindow( a, b ) \
-   ( SetCheckpoint(), XMapWindow( a, b ) )
+   ( JXTRACE( XMapWindow ), XMapWindow( a, b ) )
 
 #define JXMoveResizeWindow( a, b, c, d, e, f ) \
-   ( SetCheckpoint(), XMoveResizeWindow( a, b, c, d, e, f ) )
+   ( JXTRACE( XMoveResizeWindow ), XMoveResizeWindow( a, b, c, d, e, f ) )
 
 #define JXMoveWindow( a, b, c, d ) \
-   ( SetCheckpoint(), XMoveWindow( a, b, c, d ) )
+   ( JXTRACE( XMoveWindow ), XMoveWindow( a, b, c, d ) )
 
 #define JXNextEvent( a, b ) \
-   ( SetCheckpoint(), XNextEvent( a, b ) )
+   ( JXTRACE( XNextEvent ), XNextEvent( a, b ) )
 
 #define JXMaskEvent( a, b, c ) \
-   ( SetCheckpoint(), XMaskEvent( a, b, c ) )
+   ( JXTRACE( XMaskEvent ), XMaskEvent( a, b, c ) )
 
 #define JXCheckMaskEvent( a, b, c ) \
-   ( SetCheckpoint(), XCheckMaskEvent( a, b, c ) )
+   ( JXTRACE( XCheckMaskEvent ), XCheckMaskEvent( a, b, c ) )
 
 #define JXOpenDisplay( a ) \
-   ( SetCheckpoint(), XOpenDisplay( a ) )
+   ( JXTRACE( XOpenDisplay ), XOpenDisplay( a ) )
 
 #define JXParseColor( a, b, c, d ) \
-   ( SetCheckpoint(), XParseColor( a, b, c, d ) )
+   ( JXTRACE_REPLY( XParseColor ), JXTRACE_INT( XParseColor( a, b, c, d ) ) )
 
 #define JXPending( a ) \
-   ( SetCheckpoint(), XPending( a ) )
+   ( JXTRACE( XPending ), XPending( a ) )
 
 #define JXPutBackEvent( a, b ) \
-   ( SetCheckpoint(), XPutBackEvent( a, b ) )
+   ( JXTRACE( XPutBackEvent ), XPutBackEvent( a, b ) )
 
 #define JXGetImage( a, b, c, d, e, f, g, h ) \
-   ( SetCheckpoint(), XGetImage( a, b, c, d, e, f, g, h ) )
+   ( \
+      JXTRACE_REPLY( XGetImage ), \
+      JXTRACE_POINTER( XImage*, XGetImage( a, b, c, d, e, f, g, h ) ) \
+   )
 
 #define JXPutImage( a, b, c, d, e, f, g, h, i, j ) \
-   ( SetCheckpoint(), XPutImage( a, b, c, d, e, f, g, h, i, j ) )
+   ( JXTRACE( XPutImage ), XPutImage( a, b, c, d, e, f, g, h, i, j ) )
 
 #define JXQueryPointer( a, b, c, d, e, f, g, h, i ) \
-   ( SetCheckpoint(), XQueryPointer( a, b, c, d, e, f, g, h, i ) )
+   ( \
+      JXTRACE_REPLY( XQueryPointer ), \
+      JXTRACE_INT( XQueryPointer( a, b, c, d, e, f, g, h, i ) ) \
+   )
 
 #define JXQueryTree( a, b, c, d, e, f ) \
-   ( SetCheckpoint(), XQueryTree( a, b, c, d, e, f ) )
+   ( \
+      JXTRACE_REPLY( XQueryTree ), \
+      JXTRACE_INT( XQueryTree( a, b, c, d, e, f ) ) \
+   )
 
 #define JXReparentWindow( a, b, c, d, e ) \
-   ( SetCheckpoint(), XReparentWindow( a, b, c, d, e ) )
+   ( JXTRACE( XReparentWindow ), XReparentWindow( a, b, c, d, e ) )
 
 #define JXRemoveFromSaveSet( a, b ) \
-   ( SetCheckpoint(), XRemoveFromSaveSet( a, b ) )
+   ( JXTRACE( XRemoveFromSaveSet ), XRemoveFromSaveSet( a, b ) )
 
 #define JXResizeWindow( a, b, c, d ) \
-   ( SetCheckpoint(), XResizeWindow( a, b, c, d ) )
+   ( JXTRACE( XResizeWindow ), XResizeWindow( a, b, c, d ) )
 
 #define JXRestackWindows( a, b, c ) \
-   ( SetCheckpoint(), XRestackWindows( a, b, c ) )
+   ( JXTRACE( XRestackWindows ), XRestackWindows( a, b, c ) )
 
 #define JXRaiseWindow( a, b ) \
-   ( SetCheckpoint(), XRaiseWindow( a, b ) )
+   ( JXTRACE( XRaiseWindow ), XRaiseWindow( a, b ) )
 
 #define JXSelectInput( a, b, c ) \
-   ( SetCheckpoint(), XSelectInput( a, b, c ) )
+   ( JXTRACE( XSelectInput ), XSelectInput( a, b, c ) )
 
 #define JXSendEvent( a, b, c, d, e ) \
-   ( SetCheckpoint(), XSendEvent( a, b, c, d, e ) )
+   ( JXTRACE( XSendEvent ), XSendEvent( a, b, c, d, e ) )
 
 #define JXSetBackground( a, b, c ) \
-   ( SetCheckpoint(), XSetBackground( a, b, c ) )
+   ( JXTRACE( XSetBackground ), XSetBackground( a, b, c ) )
 
 #define JXSetClipMask( a, b, c ) \
-   ( SetCheckpoint(), XSetClipMask( a, b, c ) )
+   ( JXTRACE( XSetClipMask ), XSetClipMask( a, b, c ) )
 
 #define JXSetClipOrigin( a, b, c, d ) \
-   ( SetCheckpoint(), XSetClipOrigin( a, b, c, d) )
+   ( JXTRACE( XSetClipOrigin ), XSetClipOrigin( a, b, c, d) )
 
 #define JXSetClipRectangles( a, b, c, d, e, f, g ) \
-   ( SetCheckpoint(), XSetClipRectangles( a, b, c, d, e, f, g ) )
+   ( JXTRACE( XSetClipRectangles ), XSetClipRectangles( a, b, c, d, e, f, g ) )
 
 #define JXSetErrorHandler( a ) \
-   ( SetCheckpoint(), XSetErrorHandler( a ) )
+   ( JXTRACE( XSetErrorHandler ), XSetErrorHandler( a ) )
 
 #define JXSetFont( a, b, c ) \
-   ( SetCheckpoint(), XSetFont( a, b, c ) )
+   ( JXTRACE( XSetFont ), XSetFont( a, b, c ) )
 
 #define JXSetForeground( a, b, c ) \
-   ( SetCheckpoint(), XSetForeground( a, b, c ) )
+   ( JXTRACE( XSetForeground ), XSetForeground( a, b, c ) )
 
 #define JXGetInputFocus( a, b, c ) \
-   ( SetCheckpoint(), XGetInputFocus( a, b, c ) )
+   ( \
+      JXTRACE_REPLY( XGetInputFocus ), \
+      JXTRACE_INT( XGetInputFocus( a, b, c ) ) \
+   )
 
 #define JXSetInputFocus( a, b, c, d ) \
-   ( SetCheckpoint(), XSetInputFocus( a, b, c, d ) )
+   ( JXTRACE( XSetInputFocus ), XSetInputFocus( a, b, c, d ) )
 
 #define JXSetWindowBackground( a, b, c ) \
-   ( SetCheckpoint(), XSetWindowBackground( a, b, c ) )
+   ( JXTRACE( XSetWindowBackground ), XSetWindowBackground( a, b, c ) )
 
 #define JXSetWindowBorderWidth( a, b, c ) \
-   ( SetCheckpoint(), XSetWindowBorderWidth( a, b, c ) )
+   ( JXTRACE( XSetWindowBorderWidth ), XSetWindowBorderWidth( a, b, c ) )
 
 #define JXSetWMNormalHints( a, b, c ) \
-   ( SetCheckpoint(), XSetWMNormalHints( a, b, c ) )
+   ( JXTRACE( XSetWMNormalHints ), XSetWMNormalHints( a, b, c ) )
 
 #define JXShapeCombineRectangles( a, b, c, d, e, f, g, h, i ) \
-   ( SetCheckpoint(), XShapeCombineRectangles( a, b, c, d, e, f, g, h, i ) )
+   ( \
+      JXTRACE( XShapeCombineRectangles ), \
+      XShapeCombineRectangles( a, b, c, d, e, f, g, h, i ) \
+   )
 
 #define JXShapeCombineShape( a, b, c, d, e, f, g, h ) \
-   ( SetCheckpoint(), XShapeCombineShape( a, b, c, d, e, f, g, h ) )
+   ( \
+      JXTRACE( XShapeCombineShape ), \
+      XShapeCombineShape( a, b, c, d, e, f, g, h ) \
+   )
 
 #define JXShapeCombineMask( a, b, c, d, e, f, g ) \
-   ( SetCheckpoint(), XShapeCombineMask( a, b, c, d, e, f, g ) )
+   ( JXTRACE( XShapeCombineMask ), XShapeCombineMask( a, b, c, d, e, f, g ) )
 
 #define JXShapeQueryExtension( a, b, c ) \
-   ( SetCheckpoint(), XShapeQueryExtension( a, b, c ) )
+   ( \
+      JXTRACE_REPLY( XShapeQueryExtension ), \
+      JXTRACE_INT( XShapeQueryExtension( a, b, c ) ) \
+   )
 
 #define JXQueryExtension( a, b, c, d, e ) \
-   ( SetCheckpoint(), XQueryExtension( a, b, c, d, e ) )
+   ( \
+      JXTRACE_REPLY( XQueryExtension ), \
+      JXTRACE_INT( XQueryExtension( a, b, c, d, e ) ) \
+   )
 
 #define JXShapeQueryExtents( a, b, c, d, e, f, g, h, i, j, k, l ) \
-   ( SetCheckpoint(), \
-   XShapeQueryExtents( a, b, c, d, e, f, g, h, i, j, k, l ) )
+   ( \
+      JXTRACE_REPLY( XShapeQueryExtents ), \
+      JXTRACE_INT( XShapeQueryExtents( a, b, c, d, e, f, g, h, i, j, k, l ) ) \
+   )
 
 #define JXShapeGetRectangles( a, b, c, d, e ) \
-   ( SetCheckpoint(), XShapeGetRectangles( a, b, c, d, e ) )
+   ( \
+      JXTRACE_REPLY( XShapeGetRectangles ), \
+      JXTRACE_POINTER( XRectangle*, XShapeGetRectangles( a, b, c, d, e ) ) \
+   )
 
 #define JXShapeSelectInput( a, b, c ) \
-   ( SetCheckpoint(), XShapeSelectInput( a, b, c ) )
+   ( JXTRACE( XShapeSelectInput ), XShapeSelectInput( a, b, c ) )
 
 #define JXStoreName( a, b, c ) \
-   ( SetCheckpoint(), XStoreName( a, b, c ) )
+   ( JXTRACE( XStoreName ), XStoreName( a, b, c ) )
 
 #define JXStringToKeysym( a ) \
-   ( SetCheckpoint(), XStringToKeysym( a ) )
+   ( JXTRACE( XStringToKeysym ), XStringToKeysym( a ) )
 
 #define JXSync( a, b ) \
-   ( SetCheckpoint(), XSync( a, b ) )
+   ( JXTRACE_REPLY( XSync ), JXTRACE_INT( XSync( a, b ) ) )
 
 #define JXTextWidth( a, b, c ) \
-   ( SetCheckpoint(), XTextWidth( a, b, c ) )
+   ( JXTRACE( XTextWidth ), XTextWidth( a, b, c ) )
 
 #define JXUngrabButton( a, b, c, d ) \
-   ( SetCheckpoint(), XUngrabButton( a, b, c, d ) )
+   ( JXTRACE( XUngrabButton ), XUngrabButton( a, b, c, d ) )
 
 #define JXUngrabKeyboard( a, b ) \
-   ( SetCheckpoint(), XUngrabKeyboard( a, b ) )
+   ( JXTRACE( XUngrabKeyboard ), XUngrabKeyboard( a, b ) )
 
 #define JXUngrabPointer( a, b ) \
-   ( SetCheckpoint(), XUngrabPointer( a, b ) )
+   ( JXTRACE( XUngrabPointer ), XUngrabPointer( a, b ) )
 
 #define JXUngrabServer( a ) \
-   ( SetCheckpoint(), XUngrabServer( a ) )
+   ( JXTRACE_UNGRAB( XUngrabServer ), XUngrabServer( a ) )
 
 #define JXUnmapWindow( a, b ) \
-   ( SetCheckpoint(), XUnmapWindow( a, b ) )
+   ( JXTRACE( XUnmapWindow ), XUnmapWindow( a, b ) )
 
 #define JXWarpPointer( a, b, c, d, e, f, g, h, i ) \
-   ( SetCheckpoint(), XWarpPointer( a, b, c, d, e, f, g, h, i ) )
+   ( JXTRACE( XWarpPointer ), XWarpPointer( a, b, c, d, e, f, g, h, i ) )
 
 #define JXSetSelectionOwner( a, b, c, d ) \
-   ( SetCheckpoint(), XSetSelectionOwner( a, b, c, d ) )
+   ( JXTRACE( XSetSelectionOwner ), XSetSelectionOwner( a, b, c, d ) )
 
 #define JXGetSelectionOwner( a, b ) \
-   ( SetCheckpoint(), XGetSelectionOwner( a, b ) )
+   ( \
+      JXTRACE_REPLY( XGetSelectionOwner ), \
+      JXTRACE_LONG( XGetSelectionOwner( a, b ) ) \
+   )
 
 #define JXSetRegion( a, b, c ) \
-   ( SetCheckpoint(), XSetRegion( a, b, c ) )
+   ( JXTRACE( XSetRegion ), XSetRegion( a, b, c ) )
+
+/* XSync */
+
+#define JXSyncQueryExtension( a, b, c ) \
+   ( \
+      JXTRACE_REPLY( XSyncQueryExtension ), \
+      JXTRACE_INT( XSyncQueryExtension( a, b, c ) ) \
+   )
+
+#define JXSyncInitialize( a, b, c ) \
+   ( \
+      JXTRACE_REPLY( XSyncInitialize ), \
+      JXTRACE_INT( XSyncInitialize( a, b, c ) ) \
+   )
+
+#define JXSyncQueryCounter( a, b, c ) \
+   ( \
+      JXTRACE_REPLY( XSyncQueryCounter ), \
+      JXTRACE_INT( XSyncQueryCounter( a, b, c ) ) \
+   )
+
+#define JXSyncCreateAlarm( a, b, c ) \
+   ( JXTRACE( XSyncCreateAlarm ), XSyncCreateAlarm( a, b, c ) )
+
+#define JXSyncChangeAlarm( a, b, c, d ) \
+   ( JXTRACE( XSyncChangeAlarm ), XSyncChangeAlarm( a, b, c, d ) )
+
+#define JXSyncDestroyAlarm( a, b ) \
+   ( JXTRACE( XSyncDestroyAlarm ), XSyncDestroyAlarm( a, b ) )
 
 /* XFT */
 
 #define JXftFontOpenName( a, b, c ) \
-   ( SetCheckpoint(), XftFontOpenName( a, b, c ) )
+   ( \
+      JXTRACE_REPLY( XftFontOpenName ), \
+      JXTRACE_POINTER( XftFont*, XftFontOpenName( a, b, c ) ) \
+   )
 
 #define JXftFontOpenXlfd( a, b, c ) \
-   ( SetCheckpoint(), XftFontOpenXlfd( a, b, c ) )
+   ( \
+      JXTRACE_REPLY( XftFontOpenXlfd ), \
+      JXTRACE_POINTER( XftFont*, XftFontOpenXlfd( a, b, c ) ) \
+   )
 
 #define JXftDrawCreate( a, b, c, d ) \
-   ( SetCheckpoint(), XftDrawCreate( a, b, c, d ) )
+   ( JXTRACE( XftDrawCreate ), XftDrawCreate( a, b, c, d ) )
 
 #define JXftDrawDestroy( a ) \
-   ( SetCheckpoint(), XftDrawDestroy( a ) )
+   ( JXTRACE( XftDrawDestroy ), XftDrawDestroy( a ) )
 
 #define JXftTextExtentsUtf8( a, b, c, d, e ) \
-   ( SetCheckpoint(), XftTextExtentsUtf8( a, b, c, d, e ) )
+   ( JXTRACE( XftTextExtentsUtf8 ), XftTextExtentsUtf8( a, b, c, d, e ) )
 
 #define JXftDrawChange( a, b ) \
-   ( SetCheckpoint(), XftDrawChange( a, b ) )
+   ( JXTRACE( XftDrawChange ), XftDrawChange( a, b ) )
 
 #define JXftDrawSetClipRectangles( a, b, c, d, e ) \
-   ( SetCheckpoint(), XftDrawSetClipRectangles( a, b, c, d, e ) )
+   ( \
+      JXTRACE( XftDrawSetClipRectangles ), \
+      XftDrawSetClipRectangles( a, b, c, d, e ) \
+   )
 
 #define JXftDrawStringUtf8( a, b, c, d, e, f, g ) \
-   ( SetCheckpoint(), XftDrawStringUtf8( a, b, c, d, e, f, g ) )
+   ( JXTRACE( XftDrawStringUtf8 ), XftDrawStringUtf8( a, b, c, d, e, f, g ) )
 
 #define JXftColorFree( a, b, c, d ) \
-   ( SetCheckpoint(), XftColorFree( a, b, c, d ) )
+   ( JXTRACE( XftColorFree ), XftColorFree( a, b, c, d ) )
 
 #define JXftColorAllocValue( a, b, c, d, e ) \
-   ( SetCheckpoint(), XftColorAllocValue( a, b, c, d, e ) )
+   ( JXTRACE( XftColorAllocValue ), XftColorAllocValue( a, b, c, d, e ) )
 
 #define JXftFontClose( a, b ) \
-   ( SetCheckpoint(), XftFontClose( a, b ) )
+   ( JXTRACE( XftFontClose ), XftFontClose( a, b ) )
 
 #define JXftDrawSetClip( a, b ) \
-   ( SetCheckpoint(), XftDrawSetClip( a, b ) )
+   ( JXTRACE( XftDrawSetClip ), XftDrawSetClip( a, b ) )
 
 /* Xrender */
 
 #define JXRenderQueryExtension( a, b, c ) \
-   ( SetCheckpoint(), XRenderQueryExtension( a, b, c ) )
+   ( \
+      JXTRACE_REPLY( XRenderQueryExtension ), \
+      JXTRACE_INT( XRenderQueryExtension( a, b, c ) ) \
+   )
 
 #define JXRenderFindVisualFormat( a, b ) \
-   ( SetCheckpoint(), XRenderFindVisualFormat( a, b ) )
+   ( JXTRACE( XRenderFindVisualFormat ), XRenderFindVisualFormat( a, b ) )
 
 #define JXRenderFindFormat( a, b, c, d ) \
-   ( SetCheckpoint(), XRenderFindFormat( a, b, c, d ) )
+   ( JXTRACE( XRenderFindFormat ), XRenderFindFormat( a, b, c, d ) )
 
 #define JXRenderFindStandardFormat( a, b ) \
-   ( SetCheckpoint(), XRenderFindStandardFormat( a, b ) )
+   ( JXTRACE( XRenderFindStandardFormat ), XRenderFindStandardFormat( a, b ) )
 
 #define JXRenderCreatePicture( a, b, c, d, e ) \
-   ( SetCheckpoint(), XRenderCreatePicture( a, b, c, d, e ) )
+   ( JXTRACE( XRenderCreatePicture ), XRenderCreatePicture( a, b, c, d, e ) )
 
 #define JXRenderFreePicture( a, b ) \
-   ( SetCheckpoint(), XRenderFreePicture( a, b ) )
+   ( JXTRACE( XRenderFreePicture ), XRenderFreePicture( a, b ) )
 
 #define JXRenderComposite( a, b, c, d, e, f, g, h, i, j, k, l, m ) \
-   ( SetCheckpoint(), \
-     XRenderComposite( a, b, c, d, e, f, g, h, i, j, k, l, m) )
+   ( \
+      JXTRACE( XRenderComposite ), \
+      XRenderComposite( a, b, c, d, e, f, g, h, i, j, k, l, m ) \
+   )
 
 #endif /* JXLIB_H */
 
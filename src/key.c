@@ -256,7 +256,7 @@ void ShowKeyMenu(const XKeyEvent *event)
       if(np->state == state && np->code == event->keycode) {
          button = (unsigned int)atoi(np->command);
          if(JLIKELY(button <= 9)) {
-            ShowRootMenu(button, 0, 0);
+            ShowRootMenu(button, 0, 0, NULL);
          }
          return;
       }
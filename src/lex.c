@@ -11,9 +11,7 @@
 #include "lex.h"
 #include "error.h"
 #include "misc.h"
-
-/** Amount to increase allocations by when reading text. */
-static const int BLOCK_SIZE = 16;
+#include "pool.h"
 
 /** Literal names for tokens.
  * This order is important. It must match the order of the enumeration
@@ -89,47 +87,132 @@ static const char *TOKEN_MAP[] = {
    "WindowStyle"
 };
 
-static TokenNode *head;
+/** Minimum size of a block of token storage. */
+#define TOKEN_BLOCK_SIZE   16384
 
+/** Storage for a token list.
+ * Nodes are allocated from an arena that is released at once and
+ * names and values point into the buffer that was tokenized, which is
+ * kept until the token list is released.
+ */
+typedef struct TokenArena {
+   TokenNode head;            /**< The top-level node (must be first). */
+   MemoryArena storage;       /**< Storage for the other nodes. */
+   char *buffer;              /**< The buffer that was tokenized. */
+   char hasHead;              /**< Set once the top-level node exists. */
+} TokenArena;
+
+/** A string in the buffer that still needs to be terminated.
+ * Terminators are written after tokenizing since the character
+ * following a string is needed to find the next token.
+ */
+typedef struct TokenSlice {
+   char *start;
+   char *end;
+} TokenSlice;
+
+static TokenArena *arena;
+static PoolStats tokenStats = POOL_STATS("tokens");
+static TokenSlice *slices;
+static unsigned int sliceCount;
+static unsigned int sliceMax;
+
+static void ReleaseArena(TokenArena *ap);
+static void *AllocateToken(size_t size);
+static char *CopyToken(const char *str, unsigned int length);
+static char *AddSlice(char *start, unsigned int length);
+static void AppendValue(TokenNode *np, char *value, unsigned int length);
 static TokenNode *CreateNode(TokenNode *current,
                              const char *file,
                              unsigned int line);
 static AttributeNode *CreateAttribute(TokenNode *np); 
 
+static unsigned int SkipPast(const char *line,
+                             unsigned int x,
+                             const char *token,
+                             unsigned int *lineNumber);
 static char IsElementEnd(char ch);
 static char IsValueEnd(char ch);
 static char IsAttributeEnd(char ch);
-static char *ReadElementName(const char *line);
-static char *ReadValue(const char *line,
+static unsigned int GetElementNameLength(const char *line);
+static char *ReadValue(char *line,
                        const char *file,
                        char (*IsEnd)(char),
                        unsigned int *offset,
+                       unsigned int *length,
                        unsigned int *lineNumber);
-static char *ReadElementValue(const char *line,
-                              const char *file,
-                              unsigned int *offset,
-                              unsigned int *lineNumber);
-static char *ReadAttributeValue(const char *line,
-                                const char *file,
-                                unsigned int *offset,
-                                unsigned int *lineNumber);
 static int ParseEntity(const char *entity, char *ch,
                        const char *file, unsigned int line);
-static TokenType LookupType(const char *name, TokenNode *np);
+static TokenType LookupType(const char *name, unsigned int length);
+
+/** Tokenize a file. */
+char TokenizeFile(const char *fileName, TokenNode **tokens)
+{
+   struct stat st;
+   char *buffer;
+   size_t length, max;
+   ssize_t count;
+   int fd;
+
+   fd = open(fileName, O_RDONLY);
+   if(fd < 0) {
+      return 0;
+   }
+   if(fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+      st.st_size = 0;
+   }
+
+   /* Read the file. The size is only a hint since the file could
+    * change while it is being read. The file is not mapped since an
+    * editor could truncate or extend it while it is being tokenized. */
+   max = st.st_size > 0 ? st.st_size + 1 : 1024;
+   buffer = Allocate(max + 1);
+   length = 0;
+   for(;;) {
+      count = read(fd, buffer + length, max - length);
+      if(count <= 0) {
+         break;
+      }
+      length += count;
+      if(length == max) {
+         max *= 2;
+         buffer = Reallocate(buffer, max + 1);
+      }
+   }
+   buffer[length] = 0;
+   close(fd);
+
+   *tokens = Tokenize(buffer, fileName);
+   return 1;
+}
 
-/** Tokenize data. */
-TokenNode *Tokenize(const char *line, const char *fileName)
+/** Tokenize a buffer, taking ownership of it. */
+TokenNode *Tokenize(char *line, const char *fileName)
 {
    AttributeNode *ap;
    TokenNode *current;
-   char *temp;
+   char *file;
+   char *value;
    unsigned int x;
+   unsigned int len;
    unsigned int offset;
    unsigned int lineNumber;
    char inElement;
    char found;
 
-   head = NULL;
+   arena = Allocate(sizeof(TokenArena));
+   InitializeArena(&arena->storage, &tokenStats, TOKEN_BLOCK_SIZE);
+   arena->buffer = line;
+   arena->hasHead = 0;
+
+   /* All nodes share one copy of the file name. */
+   len = strlen(fileName);
+   file = CopyToken(fileName, len);
+
+   sliceCount = 0;
+   sliceMax = 256;
+   slices = Allocate(sliceMax * sizeof(TokenSlice));
+
    current = NULL;
    inElement = 0;
    lineNumber = 1;
@@ -141,17 +224,8 @@ TokenNode *Tokenize(const char *line, const char *fileName)
    }
 
    /* Skip any XML stuff. */
-   if(!strncmp(line + x, "<?", 2)) {
-      while(line[x]) {
-         if(line[x] == '\n') {
-            lineNumber += 1;
-         }
-         if(!strncmp(line + x, "?>", 2)) {
-            x += 2;
-            break;
-         }
-         x += 1;
-      }
+   if(line[x] == '<' && line[x + 1] == '?') {
+      x = SkipPast(line, x, "?>", &lineNumber);
    }
 
    /* Process the XML data. */
@@ -167,18 +241,10 @@ TokenNode *Tokenize(const char *line, const char *fileName)
 
          /* Skip comments */
          found = 0;
-         if(!strncmp(line + x, "<!--", 4)) {
-            while(line[x]) {
-               if(line[x] == '\n') {
-                  lineNumber += 1;
-               }
-               if(!strncmp(line + x, "-->", 3)) {
-                  x += 3;
-                  found = 1;
-                  break;
-               }
-               x += 1;
-            }
+         if(line[x] == '<' && line[x + 1] == '!'
+            && line[x + 2] == '-' && line[x + 3] == '-') {
+            x = SkipPast(line, x, "-->", &lineNumber);
+            found = 1;
          }
 
       } while(found);
@@ -190,13 +256,13 @@ TokenNode *Tokenize(const char *line, const char *fileName)
 
             /* Close tag. */
             x += 1;
-            temp = ReadElementName(line + x);
+            len = GetElementNameLength(line + x);
             if(current) {
-               if(JLIKELY(temp)) {
-                  if(JUNLIKELY(current->type != LookupType(temp, NULL))) {
-                     Warning(_("%s[%u]: close tag \"%s\" does not "
+               if(JLIKELY(len > 0)) {
+                  if(JUNLIKELY(current->type != LookupType(line + x, len))) {
+                     Warning(_("%s[%u]: close tag \"%.*s\" does not "
                              "match open tag \"%s\""),
-                             fileName, lineNumber, temp,
+                             fileName, lineNumber, (int)len, line + x,
                              GetTokenName(current));
                   }
                } else {
@@ -205,30 +271,28 @@ TokenNode *Tokenize(const char *line, const char *fileName)
                }
                current = current->parent;
             } else {
-               if(temp) {
-                  Warning(_("%s[%u]: close tag \"%s\" without open tag"),
-                          fileName, lineNumber, temp);
+               if(len > 0) {
+                  Warning(_("%s[%u]: close tag \"%.*s\" without open tag"),
+                          fileName, lineNumber, (int)len, line + x);
                } else {
                   Warning(_("%s[%u]: invalid close tag"), fileName, lineNumber);
                }
             }
-            if(temp) {
-               x += strlen(temp);
-               Release(temp);
-            }
+            x += len;
 
          } else {
 
             /* Open tag. */
-            current = CreateNode(current, fileName, lineNumber);
-            temp = ReadElementName(line + x);
-            if(JLIKELY(temp)) {
-               x += strlen(temp);
-               LookupType(temp, current);
-               Release(temp);
-            } else {
-               Warning(_("%s[%u]: invalid open tag"), fileName, lineNumber);
+            current = CreateNode(current, file, lineNumber);
+            len = GetElementNameLength(line + x);
+            current->type = LookupType(line + x, len);
+            if(JUNLIKELY(current->type == TOK_INVALID)) {
+               current->invalidName = CopyToken(line + x, len);
+               if(len == 0) {
+                  Warning(_("%s[%u]: invalid open tag"), fileName, lineNumber);
+               }
             }
+            x += len;
 
          }
          inElement = 1;
@@ -263,53 +327,77 @@ ReadDefault:
 
             /* In the open tag; read attributes. */
             ap = CreateAttribute(current);
-            ap->name = ReadElementName(line + x);
-            if(ap->name) {
-               x += strlen(ap->name);
-               if(line[x] == '=') {
-                  x += 1;
-               }
-               if(line[x] == '\"') {
-                  x += 1;
-               }
-               ap->value = ReadAttributeValue(line + x, fileName,
-                                              &offset, &lineNumber);
-               x += offset;
-               if(line[x] == '\"') {
-                  x += 1;
-               }
+            len = GetElementNameLength(line + x);
+            value = line + x;
+            x += len;
+            if(line[x] == '=') {
+               x += 1;
+            }
+            if(line[x] == '\"') {
+               x += 1;
+            }
+            if(JLIKELY(value + len < line + x)) {
+               ap->name = AddSlice(value, len);
+            } else {
+               /* The character after the name starts the value. */
+               ap->name = CopyToken(value, len);
+            }
+            value = ReadValue(line + x, fileName, IsAttributeEnd,
+                              &offset, &len, &lineNumber);
+            ap->value = AddSlice(value, len);
+            x += offset;
+            if(line[x] == '\"') {
+               x += 1;
             }
 
          } else {
 
             /* In tag body; read text. */
-            temp = ReadElementValue(line + x, fileName, &offset, &lineNumber);
+            value = ReadValue(line + x, fileName, IsValueEnd,
+                              &offset, &len, &lineNumber);
             x += offset;
-            if(temp) {
-               if(current) {
-                  if(current->value) {
-                     current->value = Reallocate(current->value,
-                                                 strlen(current->value) +
-                                                 strlen(temp) + 1);
-                     strcat(current->value, temp);
-                     Release(temp);
-                  } else {
-                     current->value = temp;
-                  }
-               } else {
-                  if(JUNLIKELY(temp[0])) {
-                     Warning(_("%s[%u]: unexpected text: \"%s\""),
-                             fileName, lineNumber, temp);
-                  }
-                  Release(temp);
-               }
+            if(current) {
+               AppendValue(current, value, len);
+            } else if(JUNLIKELY(len > 0)) {
+               Warning(_("%s[%u]: unexpected text: \"%.*s\""),
+                       fileName, lineNumber, (int)len, value);
             }
          }
          break;
       }
    }
 
-   return head;
+   /* Terminate the strings now that the buffer has been read. */
+   for(x = 0; x < sliceCount; x++) {
+      *slices[x].end = 0;
+   }
+   Release(slices);
+   slices = NULL;
+
+   if(arena->hasHead) {
+      return &arena->head;
+   } else {
+      ReleaseArena(arena);
+      return NULL;
+   }
+}
+
+/** Skip past the next occurrence of token, counting lines. */
+unsigned int SkipPast(const char *line, unsigned int x,
+                      const char *token, unsigned int *lineNumber)
+{
+   const char *start = line + x;
+   const char *stop = strstr(start, token);
+   if(stop) {
+      stop += strlen(token);
+   } else {
+      stop = start + strlen(start);
+   }
+   while((start = memchr(start, '\n', stop - start))) {
+      *lineNumber += 1;
+      start += 1;
+   }
+   return stop - line;
 }
 
 /** Parse an entity reference.
@@ -319,8 +407,6 @@ ReadDefault:
 int ParseEntity(const char *entity, char *ch, const char *file,
                 unsigned int line)
 {
-   char *temp;
-
    if(!strncmp("&quot;", entity, 6)) {
       *ch = '\"';
       return 6;
@@ -343,11 +429,8 @@ int ParseEntity(const char *entity, char *ch, const char *file,
             break;
          }
       }
-      temp = AllocateStack(x + 2);
-      strncpy(temp, entity, x + 1);
-      temp[x + 1] = 0;
-      Warning(_("%s[%d]: invalid entity: \"%.8s\""), file, line, temp);
-      ReleaseStack(temp);
+      Warning(_("%s[%d]: invalid entity: \"%.*s\""), file, line,
+              (int)Min(x + 1, 8), entity);
       *ch = '&';
       return 1;
    }
@@ -397,110 +480,73 @@ char IsValueEnd(char ch)
    }
 }
 
-/** Get the name of the next element. */
-char *ReadElementName(const char *line)
+/** Get the length of the next element name. */
+unsigned int GetElementNameLength(const char *line)
 {
-
-   char *buffer;
    unsigned int len;
-
-   /* Get the length of the element. */
    for(len = 0; !IsElementEnd(line[len]); len++);
-
-   /* Allocate space for the element. */
-   buffer = Allocate(len + 1);
-   memcpy(buffer, line, len);
-   buffer[len] = 0;
-
-   return buffer;
-
+   return len;
 }
 
-/** Read the value of an element or attribute. */
-char *ReadValue(const char *line,
+/** Read the value of an element or attribute.
+ * Entities are decoded in place and the result is trimmed. The
+ * return value points into line and is not terminated; its length
+ * is returned in length and the number of characters read in offset.
+ */
+char *ReadValue(char *line,
                 const char *file,
                 char (*IsEnd)(char),
                 unsigned int *offset,
+                unsigned int *length,
                 unsigned int *lineNumber)
 {
-   char *buffer;
    char ch;
-   unsigned int len, max;
+   unsigned int len;
+   unsigned int start;
    unsigned int x;
+   unsigned int temp;
 
    len = 0;
-   max = BLOCK_SIZE;
-   buffer = Allocate(max + 1);
-
    for(x = 0; !(IsEnd)(line[x]); x++) {
       if(line[x] == '&') {
          x += ParseEntity(line + x, &ch, file, *lineNumber) - 1;
-         if(ch) {
-            buffer[len] = ch;
-         } else {
-            buffer[len] = line[x];
-         }
+         line[len] = ch;
       } else {
          if(line[x] == '\n') {
             *lineNumber += 1;
          }
-         buffer[len] = line[x];
-      }
-      len += 1;
-      if(len >= max) {
-         max += BLOCK_SIZE;
-         buffer = Reallocate(buffer, max + 1);
-         if(JUNLIKELY(buffer == NULL)) {
-            FatalError(_("out of memory"));
+         if(len != x) {
+            line[len] = line[x];
          }
       }
+      len += 1;
    }
-   buffer[len] = 0;
-   Trim(buffer);
    *offset = x;
 
-   return buffer;
-}
-
-/** Get the value of the current element. */
-char *ReadElementValue(const char *line,
-                       const char *file,
-                       unsigned int *offset,
-                       unsigned int *lineNumber)
-{
-   return ReadValue(line, file, IsValueEnd, offset, lineNumber);
-}
+   /* Trim white space. */
+   temp = 0;
+   for(start = 0; start < len && IsSpace(line[start], &temp); start++);
+   while(len > start && IsSpace(line[len - 1], &temp)) {
+      len -= 1;
+   }
 
-/** Get the value of the current attribute. */
-char *ReadAttributeValue(const char *line,
-                         const char *file,
-                         unsigned int *offset,
-                         unsigned int *lineNumber)
-{
-   return ReadValue(line, file, IsAttributeEnd, offset, lineNumber);
+   *length = len - start;
+   return line + start;
 }
 
 /** Get the token for a tag name. */
-TokenType LookupType(const char *name, TokenNode *np)
+TokenType LookupType(const char *name, unsigned int length)
 {
    unsigned int x;
 
-   Assert(name);
-
    for(x = 0; x < sizeof(TOKEN_MAP) / sizeof(char*); x++) {
-      if(!strcmp(name, TOKEN_MAP[x])) {
-         if(np) {
-            np->type = x;
-         }
+      const char *str = TOKEN_MAP[x];
+      if(str[0] == name[0] && !strncmp(name, str, length)
+         && str[length] == 0) {
          return x;
       }
    }
 
-   if(JUNLIKELY(np)) {
-      np->type = TOK_INVALID;
-      np->invalidName = CopyString(name);
-   }
-
    return TOK_INVALID;
 
 }
@@ -522,13 +568,85 @@ const char *GetTokenTypeName(TokenType type) {
    return TOKEN_MAP[type];
 }
 
+/** Allocate storage for the token list being created. */
+void *AllocateToken(size_t size)
+{
+   return AllocateArena(&arena->storage, size);
+}
+
+/** Copy a string into token storage. */
+char *CopyToken(const char *str, unsigned int length)
+{
+   char *result = AllocateToken(length + 1);
+   memcpy(result, str, length);
+   result[length] = 0;
+   return result;
+}
+
+/** Record a string in the buffer to be terminated. */
+char *AddSlice(char *start, unsigned int length)
+{
+   if(JUNLIKELY(sliceCount >= sliceMax)) {
+      sliceMax *= 2;
+      slices = Reallocate(slices, sliceMax * sizeof(TokenSlice));
+   }
+   slices[sliceCount].start = start;
+   slices[sliceCount].end = start + length;
+   sliceCount += 1;
+   return start;
+}
+
+/** Add text to the body of a tag. */
+void AppendValue(TokenNode *np, char *value, unsigned int length)
+{
+   char *result;
+   unsigned int previous;
+   unsigned int x;
+
+   if(JLIKELY(np->value == NULL)) {
+      np->value = AddSlice(value, length);
+      return;
+   }
+
+   /* The body was split by a comment or subnodes. Slices are not
+    * terminated yet, so find the length of the existing text. */
+   previous = 0;
+   for(x = sliceCount; x > 0; x--) {
+      if(slices[x - 1].start == np->value) {
+         previous = slices[x - 1].end - slices[x - 1].start;
+         break;
+      }
+   }
+   if(x == 0) {
+      previous = strlen(np->value);
+   }
+
+   result = AllocateToken(previous + length + 1);
+   memcpy(result, np->value, previous);
+   memcpy(result + previous, value, length);
+   result[previous + length] = 0;
+   np->value = result;
+}
+
 /** Create an empty XML tag node. */
 TokenNode *CreateNode(TokenNode *current, const char *file,
                       unsigned int line)
 {
    TokenNode *np;
 
-   np = Allocate(sizeof(TokenNode));
+   if(current) {
+      np = AllocateToken(sizeof(TokenNode));
+   } else if(!arena->hasHead) {
+      np = &arena->head;
+      arena->hasHead = 1;
+   } else {
+      /* A duplicate top-level node.
+       * This is probably a configuration error.
+       */
+      TokenNode *head = &arena->head;
+      return head->subnodeTail ? head->subnodeTail : head;
+   }
+
    np->type = TOK_INVALID;
    np->value = NULL;
    np->attributes = NULL;
@@ -536,9 +654,7 @@ TokenNode *CreateNode(TokenNode *current, const char *file,
    np->subnodeTail = NULL;
    np->parent = current;
    np->next = NULL;
-
-   np->fileName = Allocate(strlen(file) + 1);
-   strcpy(np->fileName, file);
+   np->fileName = (char*)file;
    np->line = line;
    np->invalidName = NULL;
 
@@ -552,19 +668,6 @@ TokenNode *CreateNode(TokenNode *current, const char *file,
       }
       current->subnodeTail = np;
 
-   } else if(!head) {
-
-      /* The top-level node. */
-      head = np;
-
-   } else {
-
-      /* A duplicate top-level node.
-       * This is probably a configuration error.
-       */
-      ReleaseTokens(np);
-      np = head->subnodeTail ? head->subnodeTail : head;
-
    }
 
    return np;
@@ -574,54 +677,31 @@ TokenNode *CreateNode(TokenNode *current, const char *file,
 AttributeNode *CreateAttribute(TokenNode *np)
 {
    AttributeNode *ap;
-   ap = Allocate(sizeof(AttributeNode));
+   ap = AllocateToken(sizeof(AttributeNode));
    ap->name = NULL;
    ap->value = NULL;
-   ap->next = np->attributes;
-   np->attributes = ap;
+   if(JLIKELY(np)) {
+      ap->next = np->attributes;
+      np->attributes = ap;
+   } else {
+      /* Attributes on a stray close tag are read and dropped. */
+      ap->next = NULL;
+   }
    return ap;
 }
 
 /** Release a token list. */
 void ReleaseTokens(TokenNode *np)
 {
-
-   AttributeNode *ap;
-   TokenNode *tp;
-
-   while(np) {
-      tp = np->next;
-
-      while(np->attributes) {
-         ap = np->attributes->next;
-         if(np->attributes->name) {
-            Release(np->attributes->name);
-         }
-         if(np->attributes->value) {
-            Release(np->attributes->value);
-         }
-         Release(np->attributes);
-         np->attributes = ap;
-      }
-
-      if(np->subnodeHead) {
-         ReleaseTokens(np->subnodeHead);
-      }
-
-      if(np->value) {
-         Release(np->value);
-      }
-
-      if(np->invalidName) {
-         Release(np->invalidName);
-      }
-
-      if(np->fileName) {
-         Release(np->fileName);
-      }
-
-      Release(np);
-      np = tp;
+   if(np) {
+      ReleaseArena((TokenArena*)np);
    }
+}
 
+/** Release token storage and the buffer it refers to. */
+void ReleaseArena(TokenArena *ap)
+{
+   DestroyArena(&ap->storage);
+   Release(ap->buffer);
+   Release(ap);
 }
@@ -113,11 +113,20 @@ typedef struct TokenNode {
 } TokenNode;
 
 /** Tokenize a buffer.
- * @param line The buffer to tokenize.
+ * Names and values in the returned tokens point into the buffer, which
+ * is modified and is released along with the tokens.
+ * @param buffer The buffer to tokenize (allocated with Allocate).
  * @param fileName The name of the file for error reporting.
  * @return A linked list of tokens from the buffer.
  */
-TokenNode *Tokenize(const char *line, const char *fileName);
+TokenNode *Tokenize(char *buffer, const char *fileName);
+
+/** Tokenize a file.
+ * @param fileName The file to tokenize.
+ * @param tokens Location to store the linked list of tokens.
+ * @return 1 if the file was read, 0 if it could not be opened.
+ */
+char TokenizeFile(const char *fileName, TokenNode **tokens);
 
 /** Get a string represention of a token.
  * This is identical to GetTokenTypeName if tp is a valid token.
@@ -133,6 +142,7 @@ const char *GetTokenName(const TokenNode *tp);
 const char *GetTokenTypeName(TokenType type);
 
 /** Release token nodes.
+ * All tokens returned by Tokenize or TokenizeFile are released at once.
  * @param np The top-level token to release.
  */
 void ReleaseTokens(TokenNode *np);
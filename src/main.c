@@ -36,11 +36,20 @@
 #include "place.h"
 #include "clock.h"
 #include "dock.h"
+#include "dynmenu.h"
 #include "misc.h"
 #include "background.h"
 #include "settings.h"
 #include "timing.h"
 #include "grab.h"
+#include "pool.h"
+#include "capture.h"
+
+/* SIGUSR1 requests reports if any statistics are compiled in. */
+#if defined(DEBUG) || defined(SAMPLE_ALLOCATIONS) \
+   || defined(TRACE_X) || defined(TRACE_TIMELINE)
+#  define USE_REPORT_SIGNAL
+#endif
 
 Display *display = NULL;
 Window rootWindow;
@@ -58,6 +67,7 @@ char shouldRestart = 0;
 char isRestarting = 0;
 char initializing = 0;
 char shouldReload = 0;
+char shouldReport = 0;
 
 unsigned int currentDesktop = 0;
 
@@ -73,6 +83,10 @@ int shapeEvent;
 #ifdef USE_XRENDER
 char haveRender;
 #endif
+#ifdef USE_XSYNC
+char haveSync;
+int syncEvent;
+#endif
 
 static const char *CONFIG_FILE = "/.jwmrc";
 
@@ -88,6 +102,9 @@ static void StartupConnection(void);
 static void ShutdownConnection(void);
 static void EventLoop(void);
 static void HandleExit(int sig);
+#ifdef USE_REPORT_SIGNAL
+static void HandleReport(int sig);
+#endif
 static void DoExit(int code);
 static void SendRestart(void);
 static void SendExit(void);
@@ -95,6 +112,7 @@ static void SendReload(void);
 static void SendJWMMessage(const char *message);
 
 static char *displayString = NULL;
+static const char *capturePath = NULL;
 
 char *configPath = NULL;
 
@@ -142,6 +160,8 @@ int main(int argc, char *argv[])
          action = ACTION_RELOAD;
       } else if(!strcmp(argv[x], "-display") && x + 1 < argc) {
          displayString = argv[++x];
+      } else if(!strcmp(argv[x], "-capture") && x + 1 < argc) {
+         capturePath = argv[++x];
       } else if(!strcmp(argv[x], "-f") && x + 1 < argc) {
          Release(configPath);
          configPath = CopyString(argv[++x]);
@@ -155,7 +175,7 @@ int main(int argc, char *argv[])
    switch(action) {
    case ACTION_PARSE:
       Initialize();
-      ParseConfig(configPath);
+      CheckConfig(configPath);
       DoExit(0);
    case ACTION_RESTART:
       SendRestart();
@@ -180,6 +200,9 @@ int main(int argc, char *argv[])
 
    /* The main loop. */
    StartupConnection();
+   if(capturePath) {
+      OpenCapture(capturePath);
+   }
    do {
 
       isRestarting = shouldRestart;
@@ -206,7 +229,10 @@ int main(int argc, char *argv[])
       Destroy();
 
    } while(shouldRestart);
+   CloseCapture();
    ShutdownConnection();
+   ShowXRequests();
+   FlushTimeline();
 
    /* If we have a command to execute on shutdown, run it now. */
    if(exitCommand) {
@@ -255,6 +281,9 @@ void EventLoop(void)
       }
    }
 
+   /* Abort any active move, resize, or menu. */
+   CancelInputHandler();
+
    /* Process events one last time. */
    GetCurrentTime(&start);
    for(;;) {
@@ -327,6 +356,10 @@ void StartupConnection(void)
 #ifdef USE_XRENDER
    int renderEvent;
    int renderError;
+#endif
+#ifdef USE_XSYNC
+   int syncError;
+   int syncMajor, syncMinor;
 #endif
    struct sigaction sa;
    char name[32];
@@ -407,6 +440,11 @@ void StartupConnection(void)
    sigaction(SIGINT, &sa, NULL);
    sigaction(SIGHUP, &sa, NULL);
 
+#ifdef USE_REPORT_SIGNAL
+   sa.sa_handler = HandleReport;
+   sigaction(SIGUSR1, &sa, NULL);
+#endif
+
    sa.sa_flags = SA_NOCLDWAIT;
    sa.sa_handler = SIG_DFL;
    sigaction(SIGCHLD, &sa, NULL);
@@ -429,6 +467,16 @@ void StartupConnection(void)
    }
 #endif
 
+#ifdef USE_XSYNC
+   haveSync = JXSyncQueryExtension(display, &syncEvent, &syncError)
+           && JXSyncInitialize(display, &syncMajor, &syncMinor);
+   if(haveSync) {
+      Debug("sync extension enabled");
+   } else {
+      Debug("sync extension disabled");
+   }
+#endif
+
    /* Make sure we have input focus. */
    win = None;
    JXGetInputFocus(display, &win, &revert);
@@ -459,6 +507,14 @@ void HandleExit(int sig)
    shouldExit = 1;
 }
 
+#ifdef USE_REPORT_SIGNAL
+/** Signal handler to request statistics and the timeline. */
+void HandleReport(int sig)
+{
+   shouldReport = 1;
+}
+#endif
+
 /** Initialize data structures.
  * This is called before the X connection is opened.
  */
@@ -477,6 +533,7 @@ void Initialize(void)
    InitializeDialogs();
 #endif
    InitializeDock();
+   InitializeDynamicMenus();
    InitializeFonts();
    InitializeGroups();
    InitializeHints();
@@ -521,6 +578,7 @@ void Startup(void)
    StartupTaskBar();
    StartupTrayButtons();
    StartupDock();
+   StartupDynamicMenus();
    StartupTray();
    StartupKeys();
    StartupDesktops();
@@ -579,6 +637,7 @@ void Shutdown(void)
    ShutdownPager();
    ShutdownRootMenu();
    ShutdownDock();
+   ShutdownDynamicMenus();
    ShutdownTray();
    ShutdownTrayButtons();
    ShutdownTaskBar();
@@ -620,6 +679,7 @@ void Destroy(void)
    DestroyDialogs();
 #endif
    DestroyDock();
+   DestroyDynamicMenus();
    DestroyFonts();
    DestroyGroups();
    DestroyHints();
@@ -635,6 +695,9 @@ void Destroy(void)
    DestroyTaskBar();
    DestroyTray();
    DestroyTrayButtons();
+
+   /* Pools are last since the other components release objects to them. */
+   DestroyPools();
 }
 
 /** Send _JWM_RESTART to the root window. */
@@ -34,6 +34,7 @@ extern char shouldExit;
 extern char shouldRestart;
 extern char isRestarting;
 extern char shouldReload;
+extern char shouldReport;
 extern char initializing;
 
 extern XContext clientContext;
@@ -46,6 +47,10 @@ extern int shapeEvent;
 #ifdef USE_XRENDER
 extern char haveRender;
 #endif
+#ifdef USE_XSYNC
+extern char haveSync;
+extern int syncEvent;
+#endif
 
 extern char *configPath;
 
@@ -20,41 +20,67 @@
 #include "settings.h"
 #include "desktop.h"
 #include "parse.h"
+#include "misc.h"
+#include "dynmenu.h"
+#include "tray.h"
+#include "pool.h"
 
 #define BASE_ICON_OFFSET   3
 #define MENU_BORDER_SIZE   1
 
+/** Number of rendered rows to keep for scrolling menus. */
+#define ROW_CACHE_SIZE     64
+
 typedef unsigned char MenuSelectionType;
 #define MENU_NOSELECTION   0
 #define MENU_LEAVE         1
 #define MENU_SUBSELECT     2
 
-static char ShowSubmenu(Menu *menu, Menu *parent,
-                        RunMenuCommandType runner,
-                        int x, int y);
+static void ShowSubmenu(Menu *menu, Menu *parent, int x, int y);
+static void HideSubmenu(void);
+static void CloseMenu(void);
+static void CancelMenu(void);
+static void SelectMenuItem(const MenuItem *ip);
 
 static void PatchMenu(Menu *menu);
 static void UnpatchMenu(Menu *menu);
 static void CreateMenu(Menu *menu, int x, int y);
+static void RefreshMenu(Menu *menu, int lastIndex);
 static void HideMenu(Menu *menu);
+static void DestroyMenuWindow(Menu *menu);
 static void DrawMenu(Menu *menu);
 
-static char MenuLoop(Menu *menu, RunMenuCommandType runner);
-static MenuSelectionType UpdateMotion(Menu *menu,
-                                      RunMenuCommandType runner,
-                                      XEvent *event);
+static void HandleMenuEvent(XEvent *event);
+static MenuSelectionType UpdateMotion(Menu *menu, XEvent *event);
 
 static void UpdateMenu(Menu *menu);
 static void DrawMenuItem(Menu *menu, MenuItem *item, int index);
+static void RenderMenuItem(Menu *menu, MenuItem *item, int index,
+                           Drawable d, int y);
+static void DrawMenuRows(Menu *menu, int top, int bottom);
+static void CopyMenuRow(Menu *menu, int index);
+static void ScrollMenu(Menu *menu, int scroll);
+static int GetRowHeight(const Menu *menu, const MenuItem *item);
 static MenuItem *GetMenuItem(Menu *menu, int index);
 static int GetNextMenuIndex(Menu *menu);
 static int GetPreviousMenuIndex(Menu *menu);
 static int GetMenuIndex(Menu *menu, int index);
 static void SetPosition(Menu *tp, int index);
 static char IsMenuValid(const Menu *menu);
+static char IsMenuOpen(const Menu *menu);
+static void UpdateDynamicMenu(Menu *menu, const char *command);
 
 int menuShown = 0;
 
+/* State of the open menu. */
+static Menu *activeMenu = NULL;
+static ObjectPool itemPool = OBJECT_POOL("menu items", MenuItem);
+static RunMenuCommandType menuRunner;
+static MenuCloseType menuCloser;
+static MenuAction selection;
+static int pressx, pressy;
+static char hadMotion;
+
 /** Initialize a menu. */
 void InitializeMenu(Menu *menu)
 {
@@ -98,6 +124,7 @@ void InitializeMenu(Menu *menu)
    menu->width = 5;
    menu->parent = NULL;
    menu->parentOffset = 0;
+   menu->window = None;
 
    /* Make sure the menu is wide enough for a label if it is labeled. */
    if(menu->label) {
@@ -113,6 +140,7 @@ void InitializeMenu(Menu *menu)
    }
 
    /* Nothing else to do if there is nothing in the menu. */
+   menu->offsets = NULL;
    if(JUNLIKELY(menu->itemCount == 0)) {
       return;
    }
@@ -138,8 +166,10 @@ void InitializeMenu(Menu *menu)
          np->icon = &emptyIcon;
       }
       if(np->submenu) {
+         /* Submenus are initialized when they are first shown. */
          hasSubmenu = (menu->itemHeight + 3) / 4;
-         InitializeMenu(np->submenu);
+         np->submenu->offsets = NULL;
+         np->submenu->window = None;
       }
    }
    menu->width += hasSubmenu + menu->textOffset;
@@ -148,16 +178,17 @@ void InitializeMenu(Menu *menu)
 }
 
 /** Show a menu. */
-void ShowMenu(Menu *menu, RunMenuCommandType runner, int x, int y)
+void ShowMenu(Menu *menu, RunMenuCommandType runner, MenuCloseType closer,
+              int x, int y)
 {
 
    int mouseStatus, keyboardStatus;
 
    /* Don't show the menu if there isn't anything to show. */
-   if(JUNLIKELY(!IsMenuValid(menu))) {
-      return;
-   }
-   if(JUNLIKELY(shouldExit)) {
+   if(JUNLIKELY(!IsMenuValid(menu) || shouldExit || HasInputHandler())) {
+      if(closer) {
+         (closer)(menu);
+      }
       return;
    }
 
@@ -165,15 +196,61 @@ void ShowMenu(Menu *menu, RunMenuCommandType runner, int x, int y)
    keyboardStatus = JXGrabKeyboard(display, rootWindow, False,
                                    GrabModeAsync, GrabModeAsync, CurrentTime);
    if(JUNLIKELY(!mouseStatus || keyboardStatus != GrabSuccess)) {
+      if(closer) {
+         (closer)(menu);
+      }
       return;
    }
 
-   ShowSubmenu(menu, NULL, runner, x, y);
-   UnpatchMenu(menu);
+   menuRunner = runner;
+   menuCloser = closer;
+   selection.type = MA_NONE;
+
+   ShowSubmenu(menu, NULL, x, y);
+   SetInputHandler(HandleMenuEvent, CancelMenu);
+
+}
+
+/** Close all open menus and run the selected action (if any). */
+void CloseMenu(void)
+{
+
+   Menu *menu = NULL;
+
+   while(activeMenu) {
+      menu = activeMenu;
+      HideSubmenu();
+   }
 
+   ClearInputHandler();
    JXUngrabKeyboard(display, CurrentTime);
    JXUngrabPointer(display, CurrentTime);
+   AutoHideTrays();
+
+   /* The selection is a copy, so temporary menus can go away first. */
+   UnpatchMenu(menu);
+   if(menuCloser) {
+      (menuCloser)(menu);
+   }
+
+   if(selection.type != MA_NONE) {
+      (menuRunner)(&selection);
+      switch(selection.type) {
+      case MA_EXECUTE:
+      case MA_EXIT:
+      case MA_DYNAMIC:
+         if(selection.data.str) {
+            Release(selection.data.str);
+         }
+         break;
+      default:
+         break;
+      }
+      selection.type = MA_NONE;
+   }
+
    RefocusClient();
+   ExpireDynamicMenus();
 
    if(shouldReload) {
       ReloadMenu();
@@ -181,6 +258,48 @@ void ShowMenu(Menu *menu, RunMenuCommandType runner, int x, int y)
 
 }
 
+/** Close the open menus without making a selection. */
+void CancelMenu(void)
+{
+   selection.type = MA_NONE;
+   CloseMenu();
+}
+
+/** Record the action of a menu item to run once the menu is closed. */
+void SelectMenuItem(const MenuItem *ip)
+{
+   if(ip == NULL) {
+      return;
+   }
+   selection = ip->action;
+   switch(selection.type) {
+   case MA_EXECUTE:
+   case MA_EXIT:
+   case MA_DYNAMIC:
+      if(selection.data.str) {
+         selection.data.str = CopyString(selection.data.str);
+      }
+      break;
+   default:
+      break;
+   }
+}
+
+/** Create a menu item. */
+MenuItem *CreateMenuItem(MenuItemType type)
+{
+   MenuItem *item = AllocateObject(&itemPool);
+   item->type = type;
+   item->name = NULL;
+   item->action.type = MA_NONE;
+   item->action.data.str = NULL;
+   item->iconName = NULL;
+   item->submenu = NULL;
+   item->next = NULL;
+   item->icon = NULL;
+   return item;
+}
+
 /** Destroy a menu. */
 void DestroyMenu(Menu *menu)
 {
@@ -208,7 +327,7 @@ void DestroyMenu(Menu *menu)
          if(menu->items->submenu) {
             DestroyMenu(menu->items->submenu);
          }
-         Release(menu->items);
+         ReleaseObject(&itemPool, menu->items);
          menu->items = np;
       }
       if(menu->label) {
@@ -217,32 +336,123 @@ void DestroyMenu(Menu *menu)
       if(menu->offsets) {
          Release(menu->offsets);
       }
+      if(menu->window != None) {
+         DestroyMenuWindow(menu);
+      }
       Release(menu);
    }
 }
 
 /** Show a submenu. */
-char ShowSubmenu(Menu *menu, Menu *parent,
-                 RunMenuCommandType runner,
-                 int x, int y)
+void ShowSubmenu(Menu *menu, Menu *parent, int x, int y)
 {
 
-   char status;
+   Window w;
 
+   if(!menu->offsets) {
+      InitializeMenu(menu);
+   }
    PatchMenu(menu);
    menu->parent = parent;
    CreateMenu(menu, x, y);
 
    menuShown += 1;
-   status = MenuLoop(menu, runner);
-   menuShown -= 1;
+   activeMenu = menu;
+
+   hadMotion = 0;
+   GetMousePosition(&pressx, &pressy, &w);
 
+}
+
+/** Hide the innermost open menu. */
+void HideSubmenu(void)
+{
+   Menu *menu = activeMenu;
    HideMenu(menu);
+   menuShown -= 1;
+   activeMenu = menu->parent;
+   if(activeMenu) {
+      UpdateMenu(activeMenu);
+      hadMotion = 1;
+      pressx = -100;
+      pressy = -100;
+   }
+}
+
+/** Replace the dynamic menus for a command in the open menus. */
+void UpdateDynamicMenus(const char *command)
+{
+   Menu *mp = activeMenu;
+   while(mp && mp->parent) {
+      mp = mp->parent;
+   }
+   if(mp) {
+      UpdateDynamicMenu(mp, command);
+   }
+}
+
+/** Replace the dynamic menus for a command in a menu and its submenus. */
+void UpdateDynamicMenu(Menu *menu, const char *command)
+{
+
+   MenuItem *ip;
+   int index = 0;
+
+   for(ip = menu->items; ip; ip = ip->next, index++) {
+
+      if(ip->action.type != MA_DYNAMIC
+         || strcmp(ip->action.data.str, command)) {
+         if(ip->submenu) {
+            UpdateDynamicMenu(ip->submenu, command);
+         }
+         continue;
+      }
+
+      /* Close the old menu if it is open. */
+      if(IsMenuOpen(ip->submenu)) {
+         while(activeMenu != menu) {
+            HideSubmenu();
+         }
+      }
+
+      DestroyMenu(ip->submenu);
+      ip->submenu = CreateDynamicMenu(command);
+      if(ip->submenu) {
+         InitializeMenu(ip->submenu);
+      }
+
+      if(IsMenuOpen(menu)) {
+         if(menu->rows != None) {
+            menu->rowIndex[index % ROW_CACHE_SIZE] = -1;
+         }
+         DrawMenuItem(menu, ip, index);
+         CopyMenuRow(menu, index);
+      }
+
+      /* Show the new menu if its item is still selected. */
+      if(activeMenu == menu && menu->currentIndex == index
+         && IsMenuValid(ip->submenu)) {
+         ShowSubmenu(ip->submenu, menu,
+                     menu->x + menu->width + MENU_BORDER_SIZE,
+                     menu->y + menu->offsets[index] - menu->scroll);
+      }
 
-   return status;
+   }
 
 }
 
+/** Determine if a menu is open. */
+char IsMenuOpen(const Menu *menu)
+{
+   Menu *mp;
+   for(mp = activeMenu; mp; mp = mp->parent) {
+      if(mp == menu) {
+         return 1;
+      }
+   }
+   return 0;
+}
+
 /** Prepare a menu to be shown. */
 void PatchMenu(Menu *menu)
 {
@@ -258,7 +468,7 @@ void PatchMenu(Menu *menu)
          break;
       case MA_DYNAMIC:
          if(!item->submenu) {
-            submenu = ParseDynamicMenu(item->action.data.str);
+            submenu = CreateDynamicMenu(item->action.data.str);
          }
          break;
       default:
@@ -292,99 +502,82 @@ void UnpatchMenu(Menu *menu)
    }
 }
 
-/** Menu process loop.
- * Returns 0 if no selection was made or 1 if a selection was made.
- */
-char MenuLoop(Menu *menu, RunMenuCommandType runner)
+/** Handle an event for the open menus. */
+void HandleMenuEvent(XEvent *event)
 {
 
-   XEvent event;
-   MenuItem *ip;
-   Window pressw;
-   int pressx, pressy;
-   char hadMotion;
-
-   hadMotion = 0;
-
-   GetMousePosition(&pressx, &pressy, &pressw);
-
-   for(;;) {
+   MenuSelectionType status;
 
-      WaitForEvent(&event);
-
-      switch(event.type) {
-      case Expose:
-         if(event.xexpose.count == 0) {
-            Menu *mp = menu;
-            while(mp) {
-               if(mp->window == event.xexpose.window) {
-                  DrawMenu(mp);
-                  break;
-               }
-               mp = mp->parent;
+   switch(event->type) {
+   case Expose:
+      if(event->xexpose.count == 0) {
+         Menu *mp = activeMenu;
+         while(mp) {
+            if(mp->window == event->xexpose.window) {
+               DrawMenu(mp);
+               break;
             }
+            mp = mp->parent;
          }
-         break;
+      }
+      break;
 
-      case ButtonPress:
+   case ButtonPress:
 
-         pressx = -100;
-         pressy = -100;
+      pressx = -100;
+      pressy = -100;
 
-      case KeyPress:
-      case MotionNotify:
-         hadMotion = 1;
-         switch(UpdateMotion(menu, runner, &event)) {
-         case MENU_NOSELECTION: /* no selection */
-            break;
-         case MENU_LEAVE: /* mouse left the menu */
-            JXPutBackEvent(display, &event);
-            return 0;
-         case MENU_SUBSELECT: /* selection made */
-            return 1;
-         }
-         break;
+   case KeyPress:
+   case MotionNotify:
+      hadMotion = 1;
+      status = UpdateMotion(activeMenu, event);
+      while(status == MENU_LEAVE) {
+         /* The mouse left the menu; give the event to the parent. */
+         HideSubmenu();
+         status = UpdateMotion(activeMenu, event);
+      }
+      if(status == MENU_SUBSELECT) {
+         CloseMenu();
+      }
+      break;
 
-      case ButtonRelease:
+   case ButtonRelease:
 
-         if(event.xbutton.button == Button4) {
-            break;
-         }
-         if(event.xbutton.button == Button5) {
-            break;
-         }
-         if(!hadMotion) {
+      if(event->xbutton.button == Button4) {
+         break;
+      }
+      if(event->xbutton.button == Button5) {
+         break;
+      }
+      if(!hadMotion) {
+         break;
+      }
+      if(abs(event->xbutton.x_root - pressx) < settings.doubleClickDelta) {
+         if(abs(event->xbutton.y_root - pressy) < settings.doubleClickDelta) {
             break;
          }
-         if(abs(event.xbutton.x_root - pressx) < settings.doubleClickDelta) {
-            if(abs(event.xbutton.y_root - pressy) < settings.doubleClickDelta) {
-               break;
-            }
-         }
-            
-         ip = GetMenuItem(menu, menu->currentIndex);
-         if(ip != NULL) {
-            (runner)(&ip->action);
-         }
-         return 1;
-      default:
-         break;
       }
 
+      SelectMenuItem(GetMenuItem(activeMenu, activeMenu->currentIndex));
+      CloseMenu();
+      break;
+   default:
+      break;
    }
+
 }
 
-/** Create and map a menu. */
+/** Create a menu window or reuse the one kept from the last time the
+ * menu was shown.
+ */
 void CreateMenu(Menu *menu, int x, int y)
 {
 
    XSetWindowAttributes attr;
    unsigned long attrMask;
+   int visibleHeight;
    int temp;
 
-   menu->lastIndex = -1;
-   menu->currentIndex = -1;
-
    if(x + menu->width > rootWidth) {
       if(menu->parent) {
          x = menu->parent->x - menu->width;
@@ -399,10 +592,36 @@ void CreateMenu(Menu *menu, int x, int y)
    if(y < 0) {
       y = 0;
    }
+   menu->parentOffset = temp - y;
+
+   /* Menus taller than the screen scroll; only the visible rows
+    * are rendered. */
+   visibleHeight = Min(menu->height, rootHeight);
+
+   /* Reuse the window unless the screen size changed. */
+   if(menu->window != None) {
+      if(menu->visibleHeight == visibleHeight) {
+         temp = menu->lastIndex;
+         if(x != menu->x || y != menu->y) {
+            JXMoveWindow(display, menu->window, x, y);
+            menu->x = x;
+            menu->y = y;
+         }
+         RefreshMenu(menu, temp);
+         JXMapRaised(display, menu->window);
+         return;
+      }
+      DestroyMenuWindow(menu);
+   }
 
    menu->x = x;
    menu->y = y;
-   menu->parentOffset = temp - y;
+   menu->lastIndex = -1;
+   menu->currentIndex = -1;
+   menu->visibleHeight = visibleHeight;
+   menu->scroll = 0;
+   menu->rows = None;
+   menu->rowIndex = NULL;
 
    attrMask = 0;
 
@@ -419,58 +638,152 @@ void CreateMenu(Menu *menu, int x, int y)
    attr.border_pixel = colors[COLOR_MENU_OUTLINE];
 
    menu->window = JXCreateWindow(display, rootWindow, x, y,
-                                 menu->width, menu->height,
+                                 menu->width, menu->visibleHeight,
                                  MENU_BORDER_SIZE,
                                  CopyFromParent, InputOutput,
                                  CopyFromParent, attrMask, &attr);
    menu->pixmap = JXCreatePixmap(display, menu->window,
-                                 menu->width, menu->height, rootVisual.depth);
+                                 menu->width, menu->visibleHeight,
+                                 rootVisual.depth);
+   if(menu->visibleHeight < menu->height) {
+      menu->rows = JXCreatePixmap(display, menu->window, menu->width,
+                                  menu->itemHeight * ROW_CACHE_SIZE,
+                                  rootVisual.depth);
+      menu->rowIndex = Allocate(sizeof(int) * ROW_CACHE_SIZE);
+      for(temp = 0; temp < ROW_CACHE_SIZE; temp++) {
+         menu->rowIndex[temp] = -1;
+      }
+   }
 
    if(settings.menuOpacity < UINT_MAX) {
       SetCardinalAtom(menu->window, ATOM_NET_WM_WINDOW_OPACITY,
                       settings.menuOpacity);
    }
 
-   JXMapRaised(display, menu->window); 
+   DrawMenuRows(menu, 0, menu->visibleHeight);
+   JXMapRaised(display, menu->window);
 
 }
 
-/** Hide a menu. */
+/** Update the rows of a kept menu that may have changed since it was
+ * last shown: the old selection and the temporary submenus.
+ */
+void RefreshMenu(Menu *menu, int lastIndex)
+{
+
+   MenuItem *ip;
+   int index;
+
+   menu->lastIndex = -1;
+   menu->currentIndex = -1;
+   if(menu->scroll != 0) {
+      menu->scroll = 0;
+      DrawMenuRows(menu, 0, menu->visibleHeight);
+   }
+
+   index = 0;
+   for(ip = menu->items; ip; ip = ip->next) {
+      switch(ip->action.type) {
+      case MA_DESKTOP_MENU:
+      case MA_SENDTO_MENU:
+      case MA_DYNAMIC:
+         break;
+      default:
+         if(index != lastIndex) {
+            index += 1;
+            continue;
+         }
+         break;
+      }
+      if(menu->rows != None) {
+         menu->rowIndex[index % ROW_CACHE_SIZE] = -1;
+      }
+      DrawMenuItem(menu, ip, index);
+      index += 1;
+   }
+
+}
+
+/** Hide a menu.
+ * The window is kept so that the menu can be shown again quickly.
+ */
 void HideMenu(Menu *menu)
+{
+   JXUnmapWindow(display, menu->window);
+}
+
+/** Destroy the window kept for a menu. */
+void DestroyMenuWindow(Menu *menu)
 {
    JXDestroyWindow(display, menu->window);
+   ReleaseStringDrawable(menu->pixmap);
    JXFreePixmap(display, menu->pixmap);
+   if(menu->rows != None) {
+      ReleaseStringDrawable(menu->rows);
+      JXFreePixmap(display, menu->rows);
+      Release(menu->rowIndex);
+   }
+   menu->window = None;
 }
 
-/** Draw a menu. */
+/** Destroy the windows kept for a menu and its submenus. */
+void DestroyMenuWindows(Menu *menu)
+{
+   MenuItem *ip;
+   if(menu->window != None) {
+      DestroyMenuWindow(menu);
+   }
+   for(ip = menu->items; ip; ip = ip->next) {
+      if(ip->submenu) {
+         DestroyMenuWindows(ip->submenu);
+      }
+   }
+}
+
+/** Draw a menu.
+ * The pixmap is always up to date, so it only needs to be copied.
+ */
 void DrawMenu(Menu *menu)
+{
+   JXCopyArea(display, menu->pixmap, menu->window, rootGC,
+              0, 0, menu->width, menu->visibleHeight, 0, 0);
+}
+
+/** Draw the rows of a menu that are visible between two y-coordinates.
+ * The coordinates are relative to the menu window.
+ */
+void DrawMenuRows(Menu *menu, int top, int bottom)
 {
 
    MenuItem *np;
-   int x;
+   int index;
 
    JXSetForeground(display, rootGC, colors[COLOR_MENU_BG]);
-   JXFillRectangle(display, menu->pixmap, rootGC, 0, 0,
-                   menu->width, menu->height);
+   JXFillRectangle(display, menu->pixmap, rootGC, 0, top,
+                   menu->width, bottom - top);
 
-   if(menu->label) {
+   if(menu->label && menu->itemHeight > top + menu->scroll) {
       DrawMenuItem(menu, NULL, -1);
    }
 
-   x = 0;
-   for(np = menu->items; np; np = np->next) {
-      DrawMenuItem(menu, np, x);
-      ++x;
+   if(menu->itemCount == 0) {
+      return;
+   }
+   index = GetMenuIndex(menu, top + menu->scroll);
+   if(index < 0) {
+      index = 0;
+   }
+   np = GetMenuItem(menu, index);
+   while(np && menu->offsets[index] - menu->scroll < bottom) {
+      DrawMenuItem(menu, np, index);
+      np = np->next;
+      index += 1;
    }
-   JXCopyArea(display, menu->pixmap, menu->window, rootGC,
-              0, 0, menu->width, menu->height, 0, 0);
 
 }
 
 /** Determine the action to take given an event. */
-MenuSelectionType UpdateMotion(Menu *menu,
-                               RunMenuCommandType runner,
-                               XEvent *event)
+MenuSelectionType UpdateMotion(Menu *menu, XEvent *event)
 {
 
    MenuItem *ip;
@@ -542,10 +855,7 @@ MenuSelectionType UpdateMotion(Menu *menu,
       case KEY_ESC:
          return MENU_SUBSELECT;
       case KEY_ENTER:
-         ip = GetMenuItem(menu, tp->currentIndex);
-         if(ip != NULL) {
-            (runner)(&ip->action);
-         }
+         SelectMenuItem(GetMenuItem(menu, tp->currentIndex));
          return MENU_SUBSELECT;
       default:
          break;
@@ -563,8 +873,8 @@ MenuSelectionType UpdateMotion(Menu *menu,
    }
 
    /* Update the selection on the current menu */
-   if(x > 0 && y > 0 && x < menu->width && y < menu->height) {
-      menu->currentIndex = GetMenuIndex(menu, y);
+   if(x > 0 && y >= 0 && x < menu->width && y < menu->visibleHeight) {
+      menu->currentIndex = GetMenuIndex(menu, y + menu->scroll);
    } else if(menu->parent && subwindow != menu->parent->window) {
 
       /* Leave if over a menu window. */
@@ -590,19 +900,19 @@ MenuSelectionType UpdateMotion(Menu *menu,
 
    }
 
-   /* Move the menu if needed. */
-   if(menu->height > rootHeight && menu->currentIndex >= 0) {
+   /* Scroll the menu if needed. */
+   if(menu->rows != None && menu->currentIndex >= 0) {
 
-      /* If near the top, shift down. */
-      if(y + menu->y <= 0) {
+      /* If near the top, scroll up. */
+      if(y < menu->itemHeight / 2) {
          if(menu->currentIndex > 0) {
             menu->currentIndex -= 1;
             SetPosition(menu, menu->currentIndex);
          }
       }
 
-      /* If near the bottom, shift up. */
-      if(y + menu->y + menu->itemHeight / 2 >= rootHeight) {
+      /* If near the bottom, scroll down. */
+      if(y + menu->itemHeight / 2 >= menu->visibleHeight) {
          if(menu->currentIndex + 1 < menu->itemCount) {
             menu->currentIndex += 1;
             SetPosition(menu, menu->currentIndex);
@@ -619,19 +929,10 @@ MenuSelectionType UpdateMotion(Menu *menu,
    /* If the selected item is a submenu, show it. */
    ip = GetMenuItem(menu, menu->currentIndex);
    if(ip && IsMenuValid(ip->submenu)) {
-      if(ShowSubmenu(ip->submenu, menu, runner,
-                     menu->x + menu->width + MENU_BORDER_SIZE,
-                     menu->y + menu->offsets[menu->currentIndex])) {
-
-         /* Item selected; destroy the menu tree. */
-         return MENU_SUBSELECT;
-
-      } else {
-
-         /* No selection made. */
-         UpdateMenu(menu);
-
-      }
+      ShowSubmenu(ip->submenu, menu,
+                  menu->x + menu->width + MENU_BORDER_SIZE,
+                  menu->y + menu->offsets[menu->currentIndex]
+                  - menu->scroll);
    }
 
    return MENU_NOSELECTION;
@@ -647,31 +948,133 @@ void UpdateMenu(Menu *menu)
    /* Clear the old selection. */
    ip = GetMenuItem(menu, menu->lastIndex);
    DrawMenuItem(menu, ip, menu->lastIndex);
+   CopyMenuRow(menu, menu->lastIndex);
 
    /* Highlight the new selection. */
    ip = GetMenuItem(menu, menu->currentIndex);
    if(ip != NULL) {
       DrawMenuItem(menu, ip, menu->currentIndex);
+      CopyMenuRow(menu, menu->currentIndex);
+   }
+
+}
+
+/** Copy a row of a menu to the menu window. */
+void CopyMenuRow(Menu *menu, int index)
+{
+   int y, height;
+   if(index >= 0) {
+      y = menu->offsets[index] - menu->scroll;
+      height = GetRowHeight(menu, GetMenuItem(menu, index));
+      if(y < 0) {
+         height += y;
+         y = 0;
+      }
+      height = Min(height, menu->visibleHeight - y);
+      if(height > 0) {
+         JXCopyArea(display, menu->pixmap, menu->window, rootGC,
+                    0, y, menu->width, height, 0, y);
+      }
    }
+}
 
+/** Scroll a menu that is taller than the screen. */
+void ScrollMenu(Menu *menu, int scroll)
+{
+
+   int delta;
+
+   scroll = Max(0, Min(scroll, menu->height - menu->visibleHeight));
+   delta = scroll - menu->scroll;
+   if(delta == 0) {
+      return;
+   }
+   menu->scroll = scroll;
+
+   /* Reuse the rows that are still visible and draw the rest. */
+   if(abs(delta) < menu->visibleHeight) {
+      if(delta > 0) {
+         JXCopyArea(display, menu->pixmap, menu->pixmap, rootGC,
+                    0, delta, menu->width, menu->visibleHeight - delta,
+                    0, 0);
+         DrawMenuRows(menu, menu->visibleHeight - delta,
+                      menu->visibleHeight);
+      } else {
+         JXCopyArea(display, menu->pixmap, menu->pixmap, rootGC,
+                    0, 0, menu->width, menu->visibleHeight + delta,
+                    0, -delta);
+         DrawMenuRows(menu, 0, -delta);
+      }
+   } else {
+      DrawMenuRows(menu, 0, menu->visibleHeight);
+   }
    JXCopyArea(display, menu->pixmap, menu->window, rootGC,
-              0, 0, menu->width, menu->height, 0, 0);
+              0, 0, menu->width, menu->visibleHeight, 0, 0);
+
+}
 
+/** Get the height of a menu row. */
+int GetRowHeight(const Menu *menu, const MenuItem *item)
+{
+   if(item && item->type == MENU_ITEM_SEPARATOR) {
+      return 5;
+   } else {
+      return menu->itemHeight;
+   }
 }
 
-/** Draw a menu item. */
+/** Draw a menu item.
+ * Items of scrolling menus that are not selected are rendered once into
+ * the row cache and copied from there.
+ */
 void DrawMenuItem(Menu *menu, MenuItem *item, int index)
 {
 
+   int y, slot;
+
+   y = (index >= 0 ? menu->offsets[index] : 0) - menu->scroll;
+   if(menu->rows == None) {
+      RenderMenuItem(menu, item, index, menu->pixmap, y);
+      return;
+   }
+
+   if(y + menu->itemHeight <= 0 || y >= menu->visibleHeight) {
+      return;
+   }
+   if(!item || index == menu->currentIndex) {
+      RenderMenuItem(menu, item, index, menu->pixmap, y);
+      return;
+   }
+
+   slot = index % ROW_CACHE_SIZE;
+   if(menu->rowIndex[slot] != index) {
+      JXSetForeground(display, rootGC, colors[COLOR_MENU_BG]);
+      JXFillRectangle(display, menu->rows, rootGC, 0,
+                      slot * menu->itemHeight, menu->width,
+                      menu->itemHeight);
+      RenderMenuItem(menu, item, index, menu->rows, slot * menu->itemHeight);
+      menu->rowIndex[slot] = index;
+   }
+   JXCopyArea(display, menu->rows, menu->pixmap, rootGC,
+              0, slot * menu->itemHeight,
+              menu->width, GetRowHeight(menu, item), 0, y);
+
+}
+
+/** Render a menu item to a drawable. */
+void RenderMenuItem(Menu *menu, MenuItem *item, int index,
+                    Drawable d, int y)
+{
+
    ButtonNode button;
 
    Assert(menu);
 
    if(!item) {
       if(index == -1 && menu->label) {
-         ResetButton(&button, menu->pixmap, &rootVisual);
+         ResetButton(&button, d, &rootVisual);
          button.x = 0;
-         button.y = 0;
+         button.y = y;
          button.width = menu->width - 1;
          button.height = menu->itemHeight - 1;
          button.font = FONT_MENU;
@@ -686,7 +1089,7 @@ void DrawMenuItem(Menu *menu, MenuItem *item, int index)
    if(item->type != MENU_ITEM_SEPARATOR) {
       ColorType fg;
 
-      ResetButton(&button, menu->pixmap, &rootVisual);
+      ResetButton(&button, d, &rootVisual);
       if(menu->currentIndex == index) {
          button.type = BUTTON_MENU_ACTIVE;
          fg = COLOR_MENU_ACTIVE_FG;
@@ -696,7 +1099,7 @@ void DrawMenuItem(Menu *menu, MenuItem *item, int index)
       }
 
       button.x = 0;
-      button.y = menu->offsets[index];
+      button.y = y;
       button.font = FONT_MENU;
       button.width = menu->width;
       button.height = menu->itemHeight;
@@ -707,26 +1110,24 @@ void DrawMenuItem(Menu *menu, MenuItem *item, int index)
       if(item->submenu) {
 
          const int asize = (menu->itemHeight + 7) / 8;
-         const int y = menu->offsets[index] + (menu->itemHeight + 1) / 2;
+         const int ymid = y + (menu->itemHeight + 1) / 2;
          int x = menu->width - 2 * asize - 1;
          int i;
 
          JXSetForeground(display, rootGC, colors[fg]);
          for(i = 0; i < asize; i++) {
-            const int y1 = y - asize + i;
-            const int y2 = y + asize - i;
-            JXDrawLine(display, menu->pixmap, rootGC, x, y1, x, y2);
+            const int y1 = ymid - asize + i;
+            const int y2 = ymid + asize - i;
+            JXDrawLine(display, d, rootGC, x, y1, x, y2);
             x += 1;
          }
-         JXDrawPoint(display, menu->pixmap, rootGC, x, y);
+         JXDrawPoint(display, d, rootGC, x, ymid);
 
       }
 
    } else {
       JXSetForeground(display, rootGC, colors[COLOR_MENU_ACTIVE_FG]);
-      JXDrawLine(display, menu->pixmap, rootGC, 4,
-                 menu->offsets[index] + 2, menu->width - 6,
-                 menu->offsets[index] + 2);
+      JXDrawLine(display, d, rootGC, 4, y + 2, menu->width - 6, y + 2);
    }
 
 }
@@ -771,17 +1172,22 @@ int GetPreviousMenuIndex(Menu *menu)
 int GetMenuIndex(Menu *menu, int y)
 {
 
-   int x;
+   int low, high;
 
    if(y < menu->offsets[0]) {
       return -1;
    }
-   for(x = 0; x < menu->itemCount - 1; x++) {
-      if(y >= menu->offsets[x] && y < menu->offsets[x + 1]) {
-         return x;
+   low = 0;
+   high = menu->itemCount - 1;
+   while(low < high) {
+      const int mid = (low + high + 1) / 2;
+      if(menu->offsets[mid] <= y) {
+         low = mid;
+      } else {
+         high = mid - 1;
       }
    }
-   return x;
+   return low;
 
 }
 
@@ -810,24 +1216,15 @@ MenuItem *GetMenuItem(Menu *menu, int index)
 void SetPosition(Menu *tp, int index)
 {
 
-   int y = tp->offsets[index] + tp->itemHeight / 2;
-   if(tp->height > rootHeight) {
-
-      int updated = 0;
-      while(y + tp->y < tp->itemHeight / 2) {
-         tp->y += tp->itemHeight;
-         updated = tp->itemHeight;
+   int y = tp->offsets[index];
+   if(tp->rows != None) {
+      if(y < tp->scroll) {
+         ScrollMenu(tp, y);
+      } else if(y + tp->itemHeight > tp->scroll + tp->visibleHeight) {
+         ScrollMenu(tp, y + tp->itemHeight - tp->visibleHeight);
       }
-      while(y + tp->y >= rootHeight) {
-         tp->y -= tp->itemHeight;
-         updated = -tp->itemHeight;
-      }
-      if(updated) {
-         JXMoveWindow(display, tp->window, tp->x, tp->y);
-         y += updated;
-      }
-
    }
+   y += tp->itemHeight / 2 - tp->scroll;
 
    /* We need to do this twice so the event gets registered
     * on the submenu if one exists. */
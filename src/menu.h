@@ -78,7 +78,7 @@ typedef struct Menu {
    int itemHeight;         /**< User-specified menu item height. */
 
    /* These fields are handled by menu.c */
-   Window window;          /**< The menu window. */
+   Window window;          /**< The menu window (None if not created). */
    Pixmap pixmap;          /**< Pixmap where the menu is rendered. */
    int x;                  /**< The x-coordinate of the menu. */
    int y;                  /**< The y-coordinate of the menu. */
@@ -90,30 +90,64 @@ typedef struct Menu {
    int parentOffset;       /**< y-offset of this menu wrt the parent. */
    int textOffset;         /**< x-offset of text in the menu. */
    int *offsets;           /**< y-offsets of menu items. */
+   int visibleHeight;      /**< Height of the menu window. */
+   int scroll;             /**< y-offset of the visible part of the menu. */
+   Pixmap rows;            /**< Row cache for scrolling menus (or None). */
+   int *rowIndex;          /**< Item index of each cached row. */
    struct Menu *parent;    /**< The parent menu (or NULL). */
 
 } Menu;
 
 typedef void (*RunMenuCommandType)(const MenuAction *action);
 
+/** Callback executed once a menu has been closed. */
+typedef void (*MenuCloseType)(struct Menu *menu);
+
 /** Initialize a menu structure to be shown.
+ * Submenus are initialized (and their icons loaded) when they are
+ * first shown.
  * @param menu The menu to initialize.
  */
 void InitializeMenu(Menu *menu);
 
 /** Show a menu.
+ * The menu is driven by the main event loop; this returns immediately.
  * @param menu The menu to show.
  * @param runner Callback executed when an item is selected.
+ * @param closer Callback executed when the menu is closed (or NULL).
+ * This is called exactly once, even if the menu could not be shown.
  * @param x The x-coordinate of the menu.
  * @param y The y-coordinate of the menu.
  */
-void ShowMenu(Menu *menu, RunMenuCommandType runner, int x, int y);
+void ShowMenu(Menu *menu, RunMenuCommandType runner, MenuCloseType closer,
+              int x, int y);
+
+/** Destroy the windows kept for a menu and its submenus.
+ * Menus keep their windows when hidden so they can be shown again
+ * quickly; this must be called before the X connection is closed.
+ * @param menu The menu.
+ */
+void DestroyMenuWindows(Menu *menu);
+
+/** Create a menu item.
+ * The item has no name, icon, action, or submenu.
+ * Menu items are released with the menu that contains them.
+ * @param type The menu item type.
+ * @return The new menu item.
+ */
+MenuItem *CreateMenuItem(MenuItemType type);
 
 /** Destroy a menu structure.
  * @param menu The menu to destroy.
  */
 void DestroyMenu(Menu *menu);
 
+/** Replace the dynamic menus generated by a command in the open menus.
+ * This is called when new output for the command is available.
+ * @param command The command.
+ */
+void UpdateDynamicMenus(const char *command);
+
 /** The number of open menus. */
 extern int menuShown;
 
@@ -31,7 +31,6 @@ typedef struct {
    char valid;
 } RectangleType;
 
-static char shouldStopMove;
 static char atLeft;
 static char atRight;
 static char atBottom;
@@ -39,13 +38,30 @@ static char atTop;
 static ClientNode *currentClient;
 static TimeType moveTime;
 
-static void StopMove(ClientNode *np, int doMove,
-                     int oldx, int oldy, int hmax, int vmax);
+/* State of the active move. */
+static int offsetx, offsety;
+static int oldx, oldy;
+static char hmax, vmax;
+static char doMove;
+
+/* Pacing state for opaque moves. */
+static TimeType lastUpdate;
+static TimeType lastMotion;
+static char updatePending;
+static char configurePending;
+
+static void StopMove(void);
 static void MoveController(int wasDestroyed);
+static void CancelMove(void);
+static void HandleMoveEvent(XEvent *event);
+static void HandleKeyboardMoveEvent(XEvent *event);
+static void UpdateMove(ClientNode *np);
 
 static void DoSnap(ClientNode *np);
 static void DoSnapScreen(ClientNode *np);
+#ifndef BENCHMARK
 static void DoSnapBorder(ClientNode *np);
+#endif
 static char ShouldSnap(const ClientNode *np);
 static void GetClientRectangle(const ClientNode *np, RectangleType *r);
 
@@ -69,11 +85,16 @@ static char CheckBottomValid(const RectangleType *client,
 
 static void SignalMove(const TimeType *now, int x, int y, Window w, void *data);
 static void UpdateDesktop(const TimeType *now);
+static void StartOpaqueMove(void);
+static void UpdateOpaqueMove(ClientNode *np);
+static void FlushOpaqueMove(ClientNode *np, const TimeType *now);
 
 /** Callback for stopping moves. */
 void MoveController(int wasDestroyed)
 {
 
+   ClientNode *np = currentClient;
+
    if(settings.moveMode == MOVE_OUTLINE) {
       ClearOutline();
    }
@@ -82,24 +103,38 @@ void MoveController(int wasDestroyed)
    JXUngrabKeyboard(display, CurrentTime);
 
    DestroyMoveWindow();
-   shouldStopMove = 1;
+   UnregisterCallback(SignalMove, NULL);
+   ClearInputHandler();
+
+   if(!wasDestroyed) {
+      SetDefaultCursor(np->parent);
+   }
+   np->controller = NULL;
+   currentClient = NULL;
+
+   updatePending = 0;
+   configurePending = 0;
    atTop = 0;
    atBottom = 0;
    atLeft = 0;
    atRight = 0;
 
+   /* Trays get no crossing events while the pointer is grabbed. */
+   AutoHideTrays();
+
+}
+
+/** Abort the active move. */
+void CancelMove(void)
+{
+   (currentClient->controller)(0);
 }
 
 /** Move a client window. */
 char MoveClient(ClientNode *np, int startx, int starty)
 {
 
-   XEvent event;
-   int oldx, oldy;
-   int doMove;
    int north, south, east, west;
-   int height;
-   int hmax, vmax;
 
    Assert(np);
 
@@ -109,136 +144,138 @@ char MoveClient(ClientNode *np, int startx, int starty)
    if(np->state.status & STAT_FULLSCREEN) {
       return 0;
    }
+   if(HasInputHandler()) {
+      return 0;
+   }
+   if(!(GetMouseMask() & (Button1Mask | Button2Mask))) {
+      return 0;
+   }
 
    GrabMouseForMove();
 
-   RegisterCallback(0, SignalMove, NULL);
+   StartOpaqueMove();
    np->controller = MoveController;
-   shouldStopMove = 0;
 
    oldx = np->x;
    oldy = np->y;
    vmax = 0;
    hmax = 0;
 
-   if(!(GetMouseMask() & (Button1Mask | Button2Mask))) {
-      StopMove(np, 0, oldx, oldy, 0, 0);
-      return 0;
-   }
-
    GetBorderSize(&np->state, &north, &south, &east, &west);
 
-   startx -= west;
-   starty -= north;
+   offsetx = startx - west;
+   offsety = starty - north;
 
    currentClient = np;
    atTop = atBottom = atLeft = atRight = 0;
    doMove = 0;
-   for(;;) {
 
-      WaitForEvent(&event);
+   SetInputHandler(HandleMoveEvent, CancelMove);
+   return 1;
 
-      if(shouldStopMove) {
-         np->controller = NULL;
-         SetDefaultCursor(np->parent);
-         UnregisterCallback(SignalMove, NULL);
-         return doMove;
-      }
+}
 
-      switch(event.type) {
-      case ButtonRelease:
-         if(event.xbutton.button == Button1
-            || event.xbutton.button == Button2) {
-            StopMove(np, doMove, oldx, oldy, hmax, vmax);
-            return doMove;
-         }
-         break;
-      case MotionNotify:
+/** Handle an event during a mouse-initiated move. */
+void HandleMoveEvent(XEvent *event)
+{
 
-         DiscardMotionEvents(&event, np->window);
+   ClientNode *np = currentClient;
+   int north, south, east, west;
+   int height;
 
-         np->x = event.xmotion.x_root - startx;
-         np->y = event.xmotion.y_root - starty;
+   switch(event->type) {
+   case ButtonRelease:
+      if(event->xbutton.button == Button1
+         || event->xbutton.button == Button2) {
+         StopMove();
+      }
+      break;
+   case MotionNotify:
 
-         /* Get the move time used for desktop switching. */
-         if(!(atLeft | atTop | atRight | atBottom)) {
-            if(event.xmotion.state & Mod1Mask) {
-               moveTime.seconds = 0;
-               moveTime.ms = 0;
-            } else {
-               GetCurrentTime(&moveTime);
-            }
-         }
+      DiscardMotionEvents(event, np->window);
 
-         /* Determine if we are at a border for desktop switching. */
-         atLeft = atTop = atRight = atBottom = 0;
-         if(event.xmotion.x_root == 0) {
-            atLeft = 1;
-         } else if(event.xmotion.x_root == rootWidth - 1) {
-            atRight = 1;
+      np->x = event->xmotion.x_root - offsetx;
+      np->y = event->xmotion.y_root - offsety;
+
+      /* Get the move time used for desktop switching. */
+      if(!(atLeft | atTop | atRight | atBottom)) {
+         if(event->xmotion.state & Mod1Mask) {
+            moveTime.seconds = 0;
+            moveTime.ms = 0;
+         } else {
+            GetCurrentTime(&moveTime);
          }
-         if(event.xmotion.y_root == 0) {
-            atTop = 1;
-         } else if(event.xmotion.y_root == rootHeight - 1) {
-            atBottom = 1;
+      }
+
+      /* Determine if we are at a border for desktop switching. */
+      atLeft = atTop = atRight = atBottom = 0;
+      if(event->xmotion.x_root == 0) {
+         atLeft = 1;
+      } else if(event->xmotion.x_root == rootWidth - 1) {
+         atRight = 1;
+      }
+      if(event->xmotion.y_root == 0) {
+         atTop = 1;
+      } else if(event->xmotion.y_root == rootHeight - 1) {
+         atBottom = 1;
+      }
+
+      if(event->xmotion.state & Mod1Mask) {
+         /* Switch desktops immediately if alt is pressed. */
+         if(atLeft | atRight | atTop | atBottom) {
+            TimeType now;
+            GetCurrentTime(&now);
+            UpdateDesktop(&now);
          }
+      } else {
+         /* If alt is not pressed, snap to borders. */
+         DoSnap(np);
+      }
+
+      GetBorderSize(&np->state, &north, &south, &east, &west);
 
-         if(event.xmotion.state & Mod1Mask) {
-            /* Switch desktops immediately if alt is pressed. */
-            if(atLeft | atRight | atTop | atBottom) {
-               TimeType now;
-               GetCurrentTime(&now);
-               UpdateDesktop(&now);
+      if(!doMove && (abs(np->x - oldx) > MOVE_DELTA
+         || abs(np->y - oldy) > MOVE_DELTA)) {
+
+         if(np->state.status & (STAT_HMAX | STAT_VMAX)) {
+            if(np->state.status & STAT_HMAX) {
+               hmax = 1;
             }
-         } else {
-            /* If alt is not pressed, snap to borders. */
-            DoSnap(np);
+            if(np->state.status & STAT_VMAX) {
+               vmax = 1;
+            }
+            MaximizeClient(np, 0, 0);
+            offsetx = np->width / 2;
+            offsety = -north / 2;
+            MoveMouse(np->parent, offsetx, offsety);
          }
 
-         if(!doMove && (abs(np->x - oldx) > MOVE_DELTA
-            || abs(np->y - oldy) > MOVE_DELTA)) {
-
-            if(np->state.status & (STAT_HMAX | STAT_VMAX)) {
-               if(np->state.status & STAT_HMAX) {
-                  hmax = 1;
-               }
-               if(np->state.status & STAT_VMAX) {
-                  vmax = 1;
-               }
-               MaximizeClient(np, 0, 0);
-               startx = np->width / 2;
-               starty = -north / 2;
-               MoveMouse(np->parent, startx, starty);
-            }
+         CreateMoveWindow(np);
+         doMove = 1;
+      }
 
-            CreateMoveWindow(np);
-            doMove = 1;
-         }
+      if(doMove) {
 
-         if(doMove) {
-
-            if(settings.moveMode == MOVE_OUTLINE) {
-               ClearOutline();
-               height = north + south;
-               if(!(np->state.status & STAT_SHADED)) {
-                  height += np->height;
-               }
-               DrawOutline(np->x - west, np->y - north,
-                           np->width + west + east, height);
-            } else {
-               JXMoveWindow(display, np->parent, np->x - west,
-                            np->y - north);
-               SendConfigureEvent(np);
+         if(settings.moveMode == MOVE_OUTLINE) {
+            ClearOutline();
+            height = north + south;
+            if(!(np->state.status & STAT_SHADED)) {
+               height += np->height;
             }
-            UpdateMoveWindow(np);
+            DrawOutline(np->x - west, np->y - north,
+                        np->width + west + east, height);
             UpdatePager();
+         } else {
+            UpdateOpaqueMove(np);
          }
-
-         break;
-      default:
-         break;
+         UpdateMoveWindow(np);
       }
+
+      break;
+   default:
+      break;
    }
+
 }
 
 /** Move a client window (keyboard or menu initiated). */
@@ -246,11 +283,6 @@ char MoveClientKeyboard(ClientNode *np)
 {
 
    XEvent event;
-   int oldx, oldy;
-   int moved;
-   int height;
-   int north, south, east, west;
-   int hmax, vmax;
 
    Assert(np);
 
@@ -260,6 +292,9 @@ char MoveClientKeyboard(ClientNode *np)
    if(np->state.status & STAT_FULLSCREEN) {
       return 0;
    }
+   if(HasInputHandler()) {
+      return 0;
+   }
 
    hmax = 0;
    if(np->state.status & STAT_HMAX) {
@@ -280,14 +315,14 @@ char MoveClientKeyboard(ClientNode *np)
    }
    GrabMouseForMove();
 
-   GetBorderSize(&np->state, &north, &south, &east, &west);
-
    oldx = np->x;
    oldy = np->y;
+   doMove = 1;
 
-   RegisterCallback(0, SignalMove, NULL);
+   StartOpaqueMove();
    np->controller = MoveController;
-   shouldStopMove = 0;
+   currentClient = np;
+   atTop = atBottom = atLeft = atRight = 0;
 
    CreateMoveWindow(np);
    UpdateMoveWindow(np);
@@ -295,100 +330,104 @@ char MoveClientKeyboard(ClientNode *np)
    MoveMouse(rootWindow, np->x, np->y);
    DiscardMotionEvents(&event, np->window);
 
+   SetInputHandler(HandleKeyboardMoveEvent, CancelMove);
+   return 1;
+
+}
+
+/** Handle an event during a keyboard-initiated move. */
+void HandleKeyboardMoveEvent(XEvent *event)
+{
+
+   ClientNode *np = currentClient;
+   int height;
+
    if(np->state.status & STAT_SHADED) {
       height = 0;
    } else {
       height = np->height;
    }
 
-   for(;;) {
-
-      WaitForEvent(&event);
-
-      if(shouldStopMove) {
-         np->controller = NULL;
-         SetDefaultCursor(np->parent);
-         UnregisterCallback(SignalMove, NULL);
-         return 1;
-      }
-
-      moved = 0;
-
-      if(event.type == KeyPress) {
+   if(event->type == KeyPress) {
 
-         DiscardKeyEvents(&event, np->window);
-         switch(GetKey(&event.xkey) & 0xFF) {
-         case KEY_UP:
-            if(np->y + height > 0) {
-               np->y -= 10;
-            }
-            break;
-         case KEY_DOWN:
-            if(np->y < rootHeight) {
-               np->y += 10;
-            }
-            break;
-         case KEY_RIGHT:
-            if(np->x < rootWidth) {
-               np->x += 10;
-            }
-            break;
-         case KEY_LEFT:
-            if(np->x + np->width > 0) {
-               np->x -= 10;
-            }
-            break;
-         default:
-            StopMove(np, 1, oldx, oldy, hmax, vmax);
-            return 1;
+      DiscardKeyEvents(event, np->window);
+      switch(GetKey(&event->xkey) & 0xFF) {
+      case KEY_UP:
+         if(np->y + height > 0) {
+            np->y -= 10;
          }
+         break;
+      case KEY_DOWN:
+         if(np->y < rootHeight) {
+            np->y += 10;
+         }
+         break;
+      case KEY_RIGHT:
+         if(np->x < rootWidth) {
+            np->x += 10;
+         }
+         break;
+      case KEY_LEFT:
+         if(np->x + np->width > 0) {
+            np->x -= 10;
+         }
+         break;
+      default:
+         StopMove();
+         return;
+      }
 
-         MoveMouse(rootWindow, np->x, np->y);
-         DiscardMotionEvents(&event, np->window);
-
-         moved = 1;
-
-      } else if(event.type == MotionNotify) {
+      MoveMouse(rootWindow, np->x, np->y);
+      DiscardMotionEvents(event, np->window);
+      UpdateMove(np);
 
-         DiscardMotionEvents(&event, np->window);
+   } else if(event->type == MotionNotify) {
 
-         np->x = event.xmotion.x;
-         np->y = event.xmotion.y;
+      DiscardMotionEvents(event, np->window);
 
-         moved = 1;
+      np->x = event->xmotion.x;
+      np->y = event->xmotion.y;
+      UpdateMove(np);
 
-      } else if(event.type == ButtonRelease) {
+   } else if(event->type == ButtonRelease) {
 
-         StopMove(np, 1, oldx, oldy, hmax, vmax);
-         return 1;
+      StopMove();
 
-      }
+   }
 
-      if(moved) {
+}
 
-         if(settings.moveMode == MOVE_OUTLINE) {
-            ClearOutline();
-            DrawOutline(np->x - west, np->y - west,
-                        np->width + west + east, height + north + west);
-         } else {
-            JXMoveWindow(display, np->parent, np->x - west, np->y - north);
-            SendConfigureEvent(np);
-         }
+/** Show the new position of a client moved with the keyboard. */
+void UpdateMove(ClientNode *np)
+{
 
-         UpdateMoveWindow(np);
-         UpdatePager();
+   int north, south, east, west;
+   int height;
 
+   if(settings.moveMode == MOVE_OUTLINE) {
+      GetBorderSize(&np->state, &north, &south, &east, &west);
+      if(np->state.status & STAT_SHADED) {
+         height = 0;
+      } else {
+         height = np->height;
       }
-
+      ClearOutline();
+      DrawOutline(np->x - west, np->y - west,
+                  np->width + west + east, height + north + west);
+      UpdatePager();
+   } else {
+      UpdateOpaqueMove(np);
    }
 
+   UpdateMoveWindow(np);
+
 }
 
 /** Stop move. */
-void StopMove(ClientNode *np, int doMove,
-              int oldx, int oldy, int hmax, int vmax)
+void StopMove(void)
 {
 
+   ClientNode *np = currentClient;
    int north, south, east, west;
 
    Assert(np);
@@ -396,11 +435,6 @@ void StopMove(ClientNode *np, int doMove,
 
    (np->controller)(0);
 
-   np->controller = NULL;
-
-   SetDefaultCursor(np->parent);
-   UnregisterCallback(SignalMove, NULL);
-
    if(!doMove) {
 
       np->x = oldx;
@@ -419,6 +453,7 @@ void StopMove(ClientNode *np, int doMove,
 
    JXMoveWindow(display, np->parent, np->x - west, np->y - north);
    SendConfigureEvent(np);
+   UpdatePager();
 
    /* Restore maximized status. */
    if((hmax || vmax) && !(hmax && vmax)) {
@@ -783,10 +818,59 @@ char CheckBottomValid(const RectangleType *client,
 
 }
 
-/** Switch desktops if appropriate. */
+/** Prepare the opaque move state and register the move callback. */
+void StartOpaqueMove(void)
+{
+   int freq;
+   lastUpdate.seconds = 0;
+   lastUpdate.ms = 0;
+   updatePending = 0;
+   configurePending = 0;
+   freq = settings.moveRate > 0 ? 1000 / settings.moveRate : 0;
+   RegisterCallback(freq, SignalMove, NULL);
+}
+
+/** Update the frame of a client being moved (opaque mode).
+ * Frame updates are limited to settings.moveRate per second; any
+ * update that would come sooner is left for SignalMove. The synthetic
+ * ConfigureNotify is only sent once the pointer pauses or the move ends.
+ */
+void UpdateOpaqueMove(ClientNode *np)
+{
+   TimeType now;
+   GetCurrentTime(&now);
+   lastMotion = now;
+   updatePending = 1;
+   if(settings.moveRate == 0
+      || GetTimeDifference(&now, &lastUpdate) >= 1000 / settings.moveRate) {
+      FlushOpaqueMove(np, &now);
+   }
+}
+
+/** Send a pending opaque move to the X server. */
+void FlushOpaqueMove(ClientNode *np, const TimeType *now)
+{
+   int north, south, east, west;
+   GetBorderSize(&np->state, &north, &south, &east, &west);
+   JXMoveWindow(display, np->parent, np->x - west, np->y - north);
+   UpdatePager();
+   lastUpdate = *now;
+   updatePending = 0;
+   configurePending = 1;
+}
+
+/** Switch desktops and flush paced moves if appropriate. */
 void SignalMove(const TimeType *now, int x, int y, Window w, void *data)
 {
    UpdateDesktop(now);
+   if(updatePending) {
+      FlushOpaqueMove(currentClient, now);
+   }
+   if(configurePending
+      && GetTimeDifference(now, &lastMotion) >= CONFIGURE_DELAY) {
+      SendConfigureEvent(currentClient);
+      configurePending = 0;
+   }
 }
 
 /** Switch to the specified desktop. */
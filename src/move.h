@@ -12,19 +12,30 @@
 
 struct ClientNode;
 
-/** Move a client window.
+/** Start moving a client window.
+ * The move is driven by the main event loop; this returns immediately.
  * @param np The client to move.
  * @param startx The starting mouse x-coordinate (window relative).
  * @param starty The starting mouse y-coordinate (window relative).
- * @return 1 if the client moved, 0 otherwise.
+ * @return 1 if the move was started, 0 otherwise.
  */
 char MoveClient(struct ClientNode *np, int startx, int starty);
 
-/** Move a client window using the keyboard (mouse optional).
+/** Start moving a client window using the keyboard (mouse optional).
  * @param np The client to move.
- * @return 1 if the client moved, 0 otherwise.
+ * @return 1 if the move was started, 0 otherwise.
  */
 char MoveClientKeyboard(struct ClientNode *np);
 
+#ifdef BENCHMARK
+
+/** Snap a client to the borders of other windows.
+ * This is only exported for the microbenchmarks.
+ * @param np The client being moved.
+ */
+void DoSnapBorder(struct ClientNode *np);
+
+#endif /* BENCHMARK */
+
 #endif /* MOVE_H */
 
@@ -35,9 +35,6 @@ typedef struct PagerType {
 
    Pixmap buffer;          /**< Buffer for rendering the pager. */
 
-   TimeType mouseTime;     /**< Timestamp of last mouse movement. */
-   int mousex, mousey;     /**< Coordinates of last mouse location. */
-
    struct PagerType *next; /**< Next pager in the list. */
 
 } PagerType;
@@ -55,8 +52,7 @@ static int GetPagerDesktop(PagerType *pp, int x, int y);
 static void ProcessPagerButtonEvent(TrayComponentType *cp,
                                     int x, int y, int mask);
 
-static void ProcessPagerMotionEvent(TrayComponentType *cp,
-                                    int x, int y, int mask);
+static void ShowPagerPopup(TrayComponentType *cp, int x, int y);
 
 static void StartPagerMove(TrayComponentType *cp, int x, int y);
 
@@ -66,9 +62,12 @@ static void StopPagerMove(ClientNode *np,
 static void PagerMoveController(int wasDestroyed);
 
 static void DrawPagerClient(const PagerType *pp, const ClientNode *np);
+static char GetPagerClientRect(const PagerType *pp, const ClientNode *np,
+                               XRectangle *rect);
+static void DrawPager(const PagerType *pp, XRectangle *rects, int count);
+static char IntersectsRects(int x, int y, int width, int height,
+                            const XRectangle *rects, int count);
 
-static void SignalPager(const TimeType *now, int x, int y, Window w,
-                        void *data);
 
 
 /** Shutdown the pager. */
@@ -76,8 +75,8 @@ void ShutdownPager(void)
 {
    PagerType *pp;
    for(pp = pagers; pp; pp = pp->next) {
+      ReleaseStringDrawable(pp->buffer);
       JXFreePixmap(display, pp->buffer);
-      UnregisterCallback(SignalPager, pp);
    }
 }
 
@@ -103,10 +102,6 @@ TrayComponentType *CreatePager(char labeled)
    pp->next = pagers;
    pagers = pp;
    pp->labeled = labeled;
-   pp->mousex = -settings.doubleClickDelta;
-   pp->mousey = -settings.doubleClickDelta;
-   pp->mouseTime.seconds = 0;
-   pp->mouseTime.ms = 0;
 
    cp = CreateTrayComponent();
    cp->object = pp;
@@ -114,9 +109,7 @@ TrayComponentType *CreatePager(char labeled)
    cp->Create = Create;
    cp->SetSize = SetSize;
    cp->ProcessButtonPress = ProcessPagerButtonEvent;
-   cp->ProcessMotionEvent = ProcessPagerMotionEvent;
-
-   RegisterCallback(settings.popupDelay / 2, SignalPager, pp);
+   cp->ShowPopup = ShowPagerPopup;
 
    return cp;
 }
@@ -236,15 +229,17 @@ void ProcessPagerButtonEvent(TrayComponentType *cp, int x, int y, int mask)
    }
 }
 
-/** Process a motion event on a pager tray component. */
-void ProcessPagerMotionEvent(TrayComponentType *cp, int x, int y, int mask)
+/** Show the popup for a pager tray component. */
+void ShowPagerPopup(TrayComponentType *cp, int x, int y)
 {
-
    PagerType *pp = (PagerType*)cp->object;
-
-   pp->mousex = cp->screenx + x;
-   pp->mousey = cp->screeny + y;
-   GetCurrentTime(&pp->mouseTime);
+   const int desktop = GetPagerDesktop(pp, x, y);
+   if(desktop >= 0 && desktop < settings.desktopCount) {
+      const char *desktopName = GetDesktopName(desktop);
+      if(desktopName) {
+         ShowPopup(cp->screenx + x, cp->screeny + y, desktopName);
+      }
+   }
 }
 
 /** Start a pager move operation. */
@@ -495,116 +490,208 @@ void PagerMoveController(int wasDestroyed)
    JXUngrabKeyboard(display, CurrentTime);
    shouldStopMove = 1;
 
+   /* Trays get no crossing events while the pointer is grabbed. */
+   AutoHideTrays();
+
 }
 
 /** Update the pager. */
 void UpdatePager(void)
+{
+
+   PagerType *pp;
+
+   if(JUNLIKELY(shouldExit)) {
+      return;
+   }
+
+   BeginSpan("UpdatePager");
+   for(pp = pagers; pp; pp = pp->next) {
+      DrawPager(pp, NULL, 0);
+   }
+   EndSpan();
+
+}
+
+/** Redraw the areas of the pagers covered by urgent clients. */
+void FlashPager(void)
 {
 
    PagerType *pp;
    ClientNode *np;
-   Pixmap buffer;
-   int width, height;
-   int deskWidth, deskHeight;
+   XRectangle *rects;
    unsigned int x;
-   const char *name;
-   int xc, yc;
-   int textWidth, textHeight;
-   int dx, dy;
+   int count, maxCount;
 
    if(JUNLIKELY(shouldExit)) {
       return;
    }
 
+   maxCount = settings.desktopCount;
+   for(x = FIRST_LAYER; x <= LAST_LAYER; x++) {
+      for(np = nodes[x]; np; np = np->next) {
+         if(np->state.status & STAT_URGENT) {
+            maxCount += 1;
+         }
+      }
+   }
+   rects = AllocateStack(sizeof(XRectangle) * maxCount);
+
    for(pp = pagers; pp; pp = pp->next) {
 
-      buffer = pp->cp->pixmap;
-      width = pp->cp->width;
-      height = pp->cp->height;
-      deskWidth = pp->deskWidth;
-      deskHeight = pp->deskHeight;
-
-      /* Draw the background. */
-      JXSetForeground(display, rootGC, colors[COLOR_PAGER_BG]);
-      JXFillRectangle(display, buffer, rootGC, 0, 0, width, height);
-
-      /* Highlight the current desktop. */
-      JXSetForeground(display, rootGC, colors[COLOR_PAGER_ACTIVE_BG]);
-      dx = currentDesktop % settings.desktopWidth;
-      dy = currentDesktop / settings.desktopWidth;
-      JXFillRectangle(display, buffer, rootGC,
-                      dx * (deskWidth + 1), dy * (deskHeight + 1),
-                      deskWidth, deskHeight);
-
-      /* Draw the labels. */
-      if(pp->labeled) {
-         textHeight = GetStringHeight(FONT_PAGER);
-         if(textHeight < deskHeight) {
-            for(x = 0; x < settings.desktopCount; x++) {
-               dx = x % settings.desktopWidth;
-               dy = x / settings.desktopWidth;
-               name = GetDesktopName(x);
-               textWidth = GetStringWidth(FONT_PAGER, name);
-               if(textWidth < deskWidth) {
-                  xc = dx * (deskWidth + 1) + (deskWidth - textWidth) / 2;
-                  yc = dy * (deskHeight + 1) + (deskHeight - textHeight) / 2;
-                  RenderString(&rootVisual, buffer, FONT_PAGER,
-                               COLOR_PAGER_TEXT, xc, yc, deskWidth, name);
-               }
+      count = 0;
+      for(x = FIRST_LAYER; x <= LAST_LAYER; x++) {
+         for(np = nodes[x]; np; np = np->next) {
+            if((np->state.status & STAT_URGENT)
+               && GetPagerClientRect(pp, np, &rects[count])) {
+               count += 1;
             }
          }
       }
 
-      /* Draw the clients. */
-      for(x = FIRST_LAYER; x <= LAST_LAYER; x++) {
-         for(np = nodeTail[x]; np; np = np->prev) {
-            DrawPagerClient(pp, np);
+      if(count > 0) {
+         DrawPager(pp, rects, count);
+      }
+
+   }
+
+   ReleaseStack(rects);
+
+}
+
+/** Draw a pager.
+ * If rects is not NULL, only the area covered by the rectangles is
+ * redrawn. The array must have room for a rectangle per desktop to be
+ * added for labels that intersect the area.
+ */
+void DrawPager(const PagerType *pp, XRectangle *rects, int count)
+{
+
+   ClientNode *np;
+   Pixmap buffer;
+   int width, height;
+   int deskWidth, deskHeight;
+   unsigned int x;
+   const char *name;
+   int xc, yc;
+   int textWidth, textHeight;
+   int dx, dy;
+   char *labels;
+
+   buffer = pp->cp->pixmap;
+   width = pp->cp->width;
+   height = pp->cp->height;
+   deskWidth = pp->deskWidth;
+   deskHeight = pp->deskHeight;
+
+   /* Determine which labels to draw. Labels are drawn on a clean
+    * background, so the whole label is added to the area. */
+   labels = AllocateStack(settings.desktopCount);
+   textHeight = GetStringHeight(FONT_PAGER);
+   for(x = 0; x < settings.desktopCount; x++) {
+      labels[x] = 0;
+      if(pp->labeled && textHeight < deskHeight) {
+         dx = x % settings.desktopWidth;
+         dy = x / settings.desktopWidth;
+         name = GetDesktopName(x);
+         textWidth = GetFittedStringWidth(FONT_PAGER, name, deskWidth);
+         if(textWidth < deskWidth) {
+            xc = dx * (deskWidth + 1) + (deskWidth - textWidth) / 2;
+            yc = dy * (deskHeight + 1) + (deskHeight - textHeight) / 2;
+            if(!rects) {
+               labels[x] = 1;
+            } else if(IntersectsRects(xc, yc, textWidth, textHeight,
+                                      rects, count)) {
+               rects[count].x = xc;
+               rects[count].y = yc;
+               rects[count].width = textWidth;
+               rects[count].height = textHeight;
+               count += 1;
+               labels[x] = 1;
+            }
          }
       }
+   }
+   if(rects) {
+      JXSetClipRectangles(display, rootGC, 0, 0, rects, count, Unsorted);
+   }
 
-      /* Draw the desktop dividers. */
-      JXSetForeground(display, rootGC, colors[COLOR_PAGER_FG]);
-      for(x = 1; x < settings.desktopHeight; x++) {
-         JXDrawLine(display, buffer, rootGC,
-                    0, (deskHeight + 1) * x - 1,
-                    width, (deskHeight + 1) * x - 1);
+   /* Draw the background. */
+   JXSetForeground(display, rootGC, colors[COLOR_PAGER_BG]);
+   JXFillRectangle(display, buffer, rootGC, 0, 0, width, height);
+
+   /* Highlight the current desktop. */
+   JXSetForeground(display, rootGC, colors[COLOR_PAGER_ACTIVE_BG]);
+   dx = currentDesktop % settings.desktopWidth;
+   dy = currentDesktop / settings.desktopWidth;
+   JXFillRectangle(display, buffer, rootGC,
+                   dx * (deskWidth + 1), dy * (deskHeight + 1),
+                   deskWidth, deskHeight);
+
+   /* Draw the labels. */
+   for(x = 0; x < settings.desktopCount; x++) {
+      if(labels[x]) {
+         dx = x % settings.desktopWidth;
+         dy = x / settings.desktopWidth;
+         name = GetDesktopName(x);
+         textWidth = GetFittedStringWidth(FONT_PAGER, name, deskWidth);
+         xc = dx * (deskWidth + 1) + (deskWidth - textWidth) / 2;
+         yc = dy * (deskHeight + 1) + (deskHeight - textHeight) / 2;
+         RenderString(&rootVisual, buffer, FONT_PAGER,
+                      COLOR_PAGER_TEXT, xc, yc, deskWidth, name);
       }
-      for(x = 1; x < settings.desktopWidth; x++) {
-         JXDrawLine(display, buffer, rootGC,
-                    (deskWidth + 1) * x - 1, 0,
-                    (deskWidth + 1) * x - 1, height);
+   }
+   ReleaseStack(labels);
+
+   /* Draw the clients. */
+   for(x = FIRST_LAYER; x <= LAST_LAYER; x++) {
+      for(np = nodeTail[x]; np; np = np->prev) {
+         DrawPagerClient(pp, np);
       }
+   }
 
-      /* Tell the tray to redraw. */
-      UpdateSpecificTray(pp->cp->tray, pp->cp);
+   /* Draw the desktop dividers. */
+   JXSetForeground(display, rootGC, colors[COLOR_PAGER_FG]);
+   for(x = 1; x < settings.desktopHeight; x++) {
+      JXDrawLine(display, buffer, rootGC,
+                 0, (deskHeight + 1) * x - 1,
+                 width, (deskHeight + 1) * x - 1);
+   }
+   for(x = 1; x < settings.desktopWidth; x++) {
+      JXDrawLine(display, buffer, rootGC,
+                 (deskWidth + 1) * x - 1, 0,
+                 (deskWidth + 1) * x - 1, height);
+   }
 
+   if(rects) {
+      JXSetClipMask(display, rootGC, None);
    }
 
+   /* Tell the tray to redraw. */
+   UpdateSpecificTray(pp->cp->tray, pp->cp);
+
 }
 
-/** Signal pagers (for popups). */
-void SignalPager(const TimeType *now, int x, int y, Window w, void *data)
+/** Determine if an area intersects any of a list of rectangles. */
+char IntersectsRects(int x, int y, int width, int height,
+                     const XRectangle *rects, int count)
 {
-   PagerType *pp = (PagerType*)data;
-   if(pp->cp->tray->window == w &&
-      abs(pp->mousex - x) < settings.doubleClickDelta &&
-      abs(pp->mousey - y) < settings.doubleClickDelta) {
-      if(GetTimeDifference(now, &pp->mouseTime) >= settings.popupDelay) {
-         const int desktop = GetPagerDesktop(pp, x - pp->cp->screenx,
-                                                 y - pp->cp->screeny);
-         if(desktop >= 0 && desktop < settings.desktopCount) {
-            const char *desktopName = GetDesktopName(desktop);
-            if(desktopName) {
-               ShowPopup(x, y, desktopName);
-            }
-         }
-
+   int i;
+   for(i = 0; i < count; i++) {
+      if(x < rects[i].x + rects[i].width && rects[i].x < x + width
+         && y < rects[i].y + rects[i].height && rects[i].y < y + height) {
+         return 1;
       }
    }
+   return 0;
 }
 
-/** Draw a client on the pager. */
-void DrawPagerClient(const PagerType *pp, const ClientNode *np)
+/** Get the area of the pager covered by a client.
+ * The area includes the outline.
+ * @return 1 if the client is drawn on the pager, 0 otherwise.
+ */
+char GetPagerClientRect(const PagerType *pp, const ClientNode *np,
+                        XRectangle *rect)
 {
 
    int x, y;
@@ -613,10 +700,10 @@ void DrawPagerClient(const PagerType *pp, const ClientNode *np)
 
    /* Don't draw the client if it isn't mapped. */
    if(!(np->state.status & STAT_MAPPED)) {
-      return;
+      return 0;
    }
    if(np->state.status & STAT_NOPAGER) {
-      return;
+      return 0;
    }
 
    /* Determine the desktop for the client. */
@@ -654,16 +741,35 @@ void DrawPagerClient(const PagerType *pp, const ClientNode *np)
 
    /* Return if there's nothing to do. */
    if(width <= 0 || height <= 0) {
-      return;
+      return 0;
    }
 
    /* Move to the correct desktop on the pager. */
-   x += offx;
-   y += offy;
+   rect->x = x + offx;
+   rect->y = y + offy;
+   rect->width = width + 1;
+   rect->height = height + 1;
+   return 1;
+
+}
+
+/** Draw a client on the pager. */
+void DrawPagerClient(const PagerType *pp, const ClientNode *np)
+{
+
+   XRectangle rect;
+   int width, height;
+
+   if(!GetPagerClientRect(pp, np, &rect)) {
+      return;
+   }
+   width = rect.width - 1;
+   height = rect.height - 1;
 
    /* Draw the client outline. */
    JXSetForeground(display, rootGC, colors[COLOR_PAGER_OUTLINE]);
-   JXDrawRectangle(display, pp->cp->pixmap, rootGC, x, y, width, height);
+   JXDrawRectangle(display, pp->cp->pixmap, rootGC,
+                   rect.x, rect.y, width, height);
 
    /* Fill the client if there's room. */
    if(width > 1 && height > 1) {
@@ -678,8 +784,8 @@ void DrawPagerClient(const PagerType *pp, const ClientNode *np)
          fillColor = COLOR_PAGER_FG;
       }
       JXSetForeground(display, rootGC, colors[fillColor]);
-      JXFillRectangle(display, pp->cp->pixmap, rootGC, x + 1, y + 1,
-                      width - 1, height - 1);
+      JXFillRectangle(display, pp->cp->pixmap, rootGC,
+                      rect.x + 1, rect.y + 1, width - 1, height - 1);
    }
 
 }
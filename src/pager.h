@@ -28,5 +28,10 @@ struct TrayComponentType *CreatePager(char labeled);
 /** Update pagers. */
 void UpdatePager(void);
 
+/** Redraw the parts of the pagers showing clients that flash for
+ * urgency.
+ */
+void FlashPager(void);
+
 #endif /* PAGER_H */
 
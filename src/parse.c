@@ -32,6 +32,8 @@
 #include "spacer.h"
 #include "desktop.h"
 #include "border.h"
+#include "confcache.h"
+#include "dynmenu.h"
 
 /** Structure to map key names to key types. */
 typedef struct KeyMapType {
@@ -138,14 +140,18 @@ static const char *DELAY_ATTRIBUTE = "delay";
 static const char *ENABLED_ATTRIBUTE = "enabled";
 static const char *COORDINATES_ATTRIBUTE = "coordinates";
 static const char *TYPE_ATTRIBUTE = "type";
+static const char *RATE_ATTRIBUTE = "rate";
+static const char *TTL_ATTRIBUTE = "ttl";
+static const char *TIMEOUT_ATTRIBUTE = "timeout";
+static const char *WATCH_ATTRIBUTE = "watch";
 
 static const char *FALSE_VALUE = "false";
 static const char *TRUE_VALUE = "true";
 static const char *OUTLINE_VALUE = "outline";
 static const char *OPAQUE_VALUE = "opaque";
 
+static void ParseConfigFile(const char *fileName, char rebuild);
 static char ParseFile(const char *fileName, int depth);
-static char *ReadFile(FILE *fd);
 
 /* Misc. */
 static void Parse(const TokenNode *start, int depth);
@@ -156,6 +162,7 @@ static void ParseDesktopBackground(int desktop, const TokenNode *tp);
 
 /* Menus. */
 static Menu *ParseMenu(const TokenNode *start);
+static void ParseDynamicOptions(const TokenNode *tp);
 static void ParseRootMenu(const TokenNode *start);
 static MenuItem *ParseMenuItem(const TokenNode *start, Menu *menu,
                                MenuItem *last);
@@ -213,13 +220,29 @@ static void ParseError(const TokenNode *tp, const char *str, ...);
 /** Parse the JWM configuration. */
 void ParseConfig(const char *fileName)
 {
+   ParseConfigFile(fileName, 0);
+}
+
+/** Parse a configuration file without the cache. */
+void CheckConfig(const char *fileName)
+{
+   ParseConfigFile(fileName, 1);
+}
+
+/** Parse a configuration file, updating the cache. */
+void ParseConfigFile(const char *fileName, char rebuild)
+{
+   BeginSpan("ParseConfig");
+   BeginConfigCache(fileName, rebuild);
    if(!ParseFile(fileName, 0)) {
       if(JUNLIKELY(!ParseFile(SYSTEM_CONFIG, 0))) {
          ParseError(NULL, "could not open %s or %s", fileName, SYSTEM_CONFIG);
       }
    }
+   EndConfigCache();
    ValidateTrayButtons();
    ValidateKeys();
+   EndSpan();
 }
 
 /**
@@ -230,8 +253,6 @@ char ParseFile(const char *fileName, int depth)
 {
 
    TokenNode *tokens;
-   FILE *fd;
-   char *buffer;
 
    depth += 1;
    if(JUNLIKELY(depth > MAX_INCLUDE_DEPTH)) {
@@ -239,16 +260,17 @@ char ParseFile(const char *fileName, int depth)
       return 0;
    }
 
-   fd = fopen(fileName, "r");
-   if(!fd) {
-      return 0;
+   if(GetCachedTokens(fileName, &tokens)) {
+      Parse(tokens, depth);
+      ReleaseCachedTokens(tokens);
+      return 1;
    }
 
-   buffer = ReadFile(fd);
-   fclose(fd);
+   if(!TokenizeFile(fileName, &tokens)) {
+      return 0;
+   }
 
-   tokens = Tokenize(buffer, fileName);
-   Release(buffer);
+   CacheTokens(fileName, tokens);
    Parse(tokens, depth);
    ReleaseTokens(tokens);
 
@@ -432,6 +454,11 @@ void ParseMoveMode(const TokenNode *tp) {
       settings.desktopDelay = ParseUnsigned(tp, str);
    }
 
+   str = FindAttribute(tp->attributes, RATE_ATTRIBUTE);
+   if(str) {
+      settings.moveRate = ParseUnsigned(tp, str);
+   }
+
    if(JLIKELY(tp->value)) {
       if(!strcmp(tp->value, OUTLINE_VALUE)) {
          settings.moveMode = MOVE_OUTLINE;
@@ -456,6 +483,11 @@ void ParseResizeMode(const TokenNode *tp) {
       settings.resizeStatusType = ParseStatusWindowType(tp, str);
    }
 
+   str = FindAttribute(tp->attributes, RATE_ATTRIBUTE);
+   if(str) {
+      settings.resizeRate = ParseUnsigned(tp, str);
+   }
+
    if(JLIKELY(tp->value)) {
       if(!strcmp(tp->value, OUTLINE_VALUE)) {
          settings.resizeMode = RESIZE_OUTLINE;
@@ -525,15 +557,7 @@ MenuItem *InsertMenuItem(MenuItem *last) {
 
    MenuItem *item;
 
-   item = Allocate(sizeof(MenuItem));
-   item->name = NULL;
-   item->type = MENU_ITEM_NORMAL;
-   item->iconName = NULL;
-   item->action.type = MA_NONE;
-   item->action.data.str = NULL;
-   item->submenu = NULL;
-
-   item->next = NULL;
+   item = CreateMenuItem(MENU_ITEM_NORMAL);
    if(last) {
       last->next = item;
    }
@@ -552,6 +576,7 @@ MenuItem *ParseMenuItem(const TokenNode *start, Menu *menu,
    Assert(menu);
 
    menu->offsets = NULL;
+   menu->window = None;
    while(start) {
       switch(start->type) {
       case TOK_MENU:
@@ -683,6 +708,7 @@ MenuItem *ParseMenuItem(const TokenNode *start, Menu *menu,
          case TOK_INCLUDE:
             last->action.type = MA_DYNAMIC;
             last->action.data.str = CopyString(start->value);
+            ParseDynamicOptions(start);
             break;
          default:
             break;
@@ -746,54 +772,72 @@ MenuItem *ParseMenuItem(const TokenNode *start, Menu *menu,
 
 }
 
-/** Parse a dynamic menu (called from menu code). */
-Menu *ParseDynamicMenu(const char *command)
+/** Parse the caching options for a dynamic menu. */
+void ParseDynamicOptions(const TokenNode *tp)
 {
-   FILE *fd;
-   char *path;
-   char *buffer;
-   TokenNode *start;
-   Menu *menu;
+   const char *str;
+   unsigned int ttl, timeout;
+   char *watch;
 
-   buffer = NULL;
-   if(!strncmp(command, "exec:", 5)) {
+   ttl = 0;
+   str = FindAttribute(tp->attributes, TTL_ATTRIBUTE);
+   if(str) {
+      ttl = ParseUnsigned(tp, str);
+   }
 
-      path = Allocate(strlen(command) - 5 + 1);
-      strcpy(path, command + 5);
-      ExpandPath(&path);
+   timeout = 0;
+   str = FindAttribute(tp->attributes, TIMEOUT_ATTRIBUTE);
+   if(str) {
+      timeout = ParseUnsigned(tp, str);
+   }
 
-      fd = popen(path, "r");
-      if(JLIKELY(fd)) {
-         buffer = ReadFile(fd);
-         pclose(fd);
-      } else {
-         ParseError(NULL, "could not execute included program: %s", path);
-      }
+   watch = CopyString(FindAttribute(tp->attributes, WATCH_ATTRIBUTE));
+   if(watch) {
+      ExpandPath(&watch);
+   }
 
-   } else {
+   SetDynamicMenuOptions(tp->value, ttl, timeout, watch);
+   Release(watch);
+}
 
-      path = CopyString(command);
-      ExpandPath(&path);
+/** Parse a dynamic menu from a file (called from menu code). */
+Menu *ParseDynamicMenu(const char *command)
+{
+   char *path;
+   TokenNode *start;
+   Menu *menu;
 
-      fd = fopen(path, "r");
-      if(JLIKELY(fd)) {
-         buffer = ReadFile(fd);
-         fclose(fd);
-      } else {
-         ParseError(NULL, "could not open include: %s", path);
-      }
+   path = CopyString(command);
+   ExpandPath(&path);
 
+   start = NULL;
+   if(JUNLIKELY(!TokenizeFile(path, &start))) {
+      ParseError(NULL, "could not open include: %s", path);
+      Release(path);
+      return NULL;
    }
+   Release(path);
 
-   if(!buffer) {
-      Release(path);
+   if(JUNLIKELY(!start || start->type != TOK_JWM)) {
+      ParseError(NULL, "invalid include: %s", command);
+      if(start) {
+         ReleaseTokens(start);
+      }
       return NULL;
    }
 
-   start = Tokenize(buffer, path);
-   Release(buffer);
-   Release(path);
+   menu = ParseMenu(start);
+   ReleaseTokens(start);
+   return menu;
+}
 
+/** Parse a dynamic menu from program output (called from menu code). */
+Menu *ParseMenuBuffer(char *buffer, const char *command)
+{
+   TokenNode *start;
+   Menu *menu;
+
+   start = Tokenize(buffer, command);
    if(JUNLIKELY(!start || start->type != TOK_JWM)) {
       ParseError(NULL, "invalid include: %s", command);
       if(start) {
@@ -1814,41 +1858,6 @@ char *FindAttribute(AttributeNode *ap, const char *name)
    return NULL;
 }
 
-/** Read a file. */
-char *ReadFile(FILE *fd)
-{
-
-   const int BLOCK_SIZE = 1024;  // Start at 1k.
-
-   char *buffer;
-   int len, max;
-
-   len = 0;
-   max = BLOCK_SIZE;
-   buffer = Allocate(max + 1);
-
-   for(;;) {
-      const size_t count = fread(&buffer[len], 1, max - len, fd);
-      len += count;
-      if(len < max) {
-         break;
-      }
-      max *= 2;
-      if(JUNLIKELY(max < 0)) {
-         /* File is too big. */
-         break;
-      }
-      buffer = Reallocate(buffer, max + 1);
-      if(JUNLIKELY(buffer == NULL)) {
-         FatalError(_("out of memory"));
-      }
-   }
-   buffer[len] = 0;
-
-   return buffer;
-
-}
-
 /** Parse an unsigned integer. */
 unsigned int ParseUnsigned(const TokenNode *tp, const char *str)
 {
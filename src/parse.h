@@ -13,15 +13,28 @@
 struct Menu;
 
 /** Parse a configuration file.
+ * Files that have not changed are read from the configuration cache.
  * @param fileName The file to parse.
  */
 void ParseConfig(const char *fileName);
 
-/** Parse a dynamic menu.
- * @param command The command to generate the menu.
+/** Parse a configuration file without the cache and rebuild the cache.
+ * @param fileName The file to parse.
+ */
+void CheckConfig(const char *fileName);
+
+/** Parse a dynamic menu from a file.
+ * @param command The file containing the menu.
  * @return The menu.
  */
 struct Menu *ParseDynamicMenu(const char *command);
 
+/** Parse a dynamic menu from the output of a program.
+ * @param buffer The program output (taken over by the parser).
+ * @param command The command that generated the output.
+ * @return The menu.
+ */
+struct Menu *ParseMenuBuffer(char *buffer, const char *command);
+
 #endif /* PARSE_H */
 
@@ -34,7 +34,9 @@ static void CenterClient(const BoundingBox *box, ClientNode *np);
 static int IntComparator(const void *a, const void *b);
 static char TryTileClient(const BoundingBox *box, ClientNode *np,
                           int x, int y);
+#ifndef BENCHMARK
 static char TileClient(const BoundingBox *box, ClientNode *np);
+#endif
 static void CascadeClient(const BoundingBox *box, ClientNode *np);
 
 static void SubtractStrutBounds(BoundingBox *box, const ClientNode *np);
@@ -91,5 +91,17 @@ void GetScreenBounds(const struct ScreenType *sp, BoundingBox *box);
 void SubtractTrayBounds(const struct TrayType *tp, BoundingBox *box,
                         unsigned int layer);
 
+#ifdef BENCHMARK
+
+/** Place a client without overlapping other clients (if possible).
+ * This is only exported for the microbenchmarks.
+ * @param box The area in which to place the client.
+ * @param np The client to place.
+ * @return 1 if the client was placed, 0 otherwise.
+ */
+char TileClient(const BoundingBox *box, struct ClientNode *np);
+
+#endif /* BENCHMARK */
+
 #endif /* PLACE_H */
 
@@ -0,0 +1,214 @@
+/**
+ * @file pool.c
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Object pools and arenas.
+ *
+ * Objects that come and go with windows (clients, icons, task bar
+ * entries, menu items, timers) are kept on free lists so that they
+ * can be reused without going back to the allocator. Storage that is
+ * only needed during one operation (parsing, scaling an icon) comes
+ * from an arena that is released all at once.
+ *
+ */
+
+#include "jwm.h"
+#include "pool.h"
+#include "misc.h"
+
+/** Number of objects in a pool block. */
+#define POOL_BLOCK_COUNT 32
+
+/** Type with the strictest alignment needed for pool storage. */
+typedef union PoolAlign {
+   void *pointer;
+   long integer;
+   double real;
+} PoolAlign;
+
+/** Round a size up to the pool storage alignment. */
+#define POOL_ROUND( x ) \
+   ((((x) + sizeof(PoolAlign) - 1) / sizeof(PoolAlign)) * sizeof(PoolAlign))
+
+/** A block of objects in a pool. */
+typedef struct PoolBlock {
+   struct PoolBlock *next;
+} PoolBlock;
+
+/** A block of arena storage. */
+typedef struct ArenaBlock {
+   struct ArenaBlock *next;   /**< Next (older) block. */
+   size_t used;               /**< Bytes used in this block. */
+   size_t size;               /**< Bytes available in this block. */
+} ArenaBlock;
+
+static ObjectPool *pools = NULL;
+static PoolStats *arenaStats = NULL;
+
+static void ShowStats(const PoolStats *stats);
+static void AddUsed(PoolStats *stats, unsigned long count);
+
+/** Release storage of empty pools and show statistics. */
+void DestroyPools(void)
+{
+   ObjectPool *pp;
+   PoolStats *sp;
+
+   for(pp = pools; pp; pp = pp->next) {
+      ShowStats(&pp->stats);
+      if(pp->stats.used == 0) {
+         while(pp->blocks) {
+            PoolBlock *next = pp->blocks->next;
+            Release(pp->blocks);
+            pp->blocks = next;
+         }
+         pp->freeList = NULL;
+      }
+   }
+   for(sp = arenaStats; sp; sp = sp->next) {
+      ShowStats(sp);
+   }
+}
+
+/** Allocate an object from a pool. */
+void *AllocateObject(ObjectPool *pool)
+{
+   void *result;
+
+   if(JUNLIKELY(!pool->freeList)) {
+
+      /* Carve a new block into objects. */
+      const size_t headerSize = POOL_ROUND(sizeof(PoolBlock));
+      const size_t size = POOL_ROUND(Max(pool->size, sizeof(void*)));
+      PoolBlock *bp;
+      char *object;
+      unsigned int x;
+
+      if(!pool->stats.registered) {
+         pool->stats.registered = 1;
+         pool->next = pools;
+         pools = pool;
+      }
+      bp = Allocate(headerSize + size * POOL_BLOCK_COUNT);
+      bp->next = pool->blocks;
+      pool->blocks = bp;
+      pool->stats.blocks += 1;
+
+      object = (char*)bp + headerSize;
+      for(x = 0; x < POOL_BLOCK_COUNT; x++) {
+         *(void**)object = pool->freeList;
+         pool->freeList = object;
+         object += size;
+      }
+
+   }
+
+   result = pool->freeList;
+   pool->freeList = *(void**)result;
+   AddUsed(&pool->stats, 1);
+   return result;
+}
+
+/** Return an object to a pool. */
+void ReleaseObject(ObjectPool *pool, void *object)
+{
+   Assert(object);
+   Assert(pool->stats.used > 0);
+#ifdef DEBUG
+   memset(object, 0xA5, pool->size);
+#endif
+   *(void**)object = pool->freeList;
+   pool->freeList = object;
+   pool->stats.used -= 1;
+}
+
+/** Initialize an arena. */
+void InitializeArena(MemoryArena *arena, PoolStats *stats, size_t blockSize)
+{
+   arena->stats = stats;
+   arena->blockSize = blockSize;
+   arena->used = 0;
+   arena->blocks = NULL;
+}
+
+/** Allocate storage from an arena. */
+void *AllocateArena(MemoryArena *arena, size_t size)
+{
+   const size_t headerSize = POOL_ROUND(sizeof(ArenaBlock));
+   ArenaBlock *bp;
+   void *result;
+
+   size = POOL_ROUND(size);
+   bp = arena->blocks;
+   if(!bp || bp->used + size > bp->size) {
+      const size_t blockSize = Max(size, arena->blockSize);
+      if(!arena->stats->registered) {
+         arena->stats->registered = 1;
+         arena->stats->next = arenaStats;
+         arenaStats = arena->stats;
+      }
+      bp = Allocate(headerSize + blockSize);
+      bp->next = arena->blocks;
+      bp->used = 0;
+      bp->size = blockSize;
+      arena->blocks = bp;
+      arena->stats->blocks += 1;
+   }
+
+   result = (char*)bp + headerSize + bp->used;
+   bp->used += size;
+   arena->used += size;
+   AddUsed(arena->stats, size);
+   return result;
+}
+
+/** Release everything allocated from an arena, keeping one block. */
+void ResetArena(MemoryArena *arena)
+{
+   ArenaBlock *keep = NULL;
+
+   while(arena->blocks) {
+      ArenaBlock *next = arena->blocks->next;
+      if(!keep && arena->blocks->size == arena->blockSize) {
+         keep = arena->blocks;
+         keep->used = 0;
+         keep->next = NULL;
+      } else {
+         Release(arena->blocks);
+      }
+      arena->blocks = next;
+   }
+   arena->blocks = keep;
+
+   arena->stats->used -= arena->used;
+   arena->used = 0;
+}
+
+/** Release everything allocated from an arena and its storage. */
+void DestroyArena(MemoryArena *arena)
+{
+   ResetArena(arena);
+   if(arena->blocks) {
+      Release(arena->blocks);
+      arena->blocks = NULL;
+   }
+}
+
+/** Show statistics for a pool or a kind of arena. */
+void ShowStats(const PoolStats *stats)
+{
+   Debug("POOL: %s: %lu requests, %lu peak, %lu blocks, %lu in use",
+         stats->name, stats->requests, stats->peak, stats->blocks,
+         stats->used);
+}
+
+/** Record an allocation. */
+void AddUsed(PoolStats *stats, unsigned long count)
+{
+   stats->requests += 1;
+   stats->used += count;
+   if(stats->used > stats->peak) {
+      stats->peak = stats->used;
+   }
+}
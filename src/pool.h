@@ -0,0 +1,106 @@
+/**
+ * @file pool.h
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Header for object pools and arenas.
+ *
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+struct PoolBlock;
+struct ArenaBlock;
+
+/** Statistics for an object pool or a kind of arena. */
+typedef struct PoolStats {
+   const char *name;          /**< Name shown with the statistics. */
+   unsigned long requests;    /**< Number of allocations. */
+   unsigned long used;        /**< Objects (or bytes) in use. */
+   unsigned long peak;        /**< Most objects (or bytes) in use. */
+   unsigned long blocks;      /**< Blocks allocated from the system. */
+   char registered;           /**< Set once on the statistics list. */
+   struct PoolStats *next;    /**< Next on the statistics list. */
+} PoolStats;
+
+/** A pool of objects of the same size.
+ * Released objects are kept on a free list for reuse.
+ */
+typedef struct ObjectPool {
+   PoolStats stats;           /**< Statistics. */
+   size_t size;               /**< Size of an object. */
+   void *freeList;            /**< Objects available for reuse. */
+   struct PoolBlock *blocks;  /**< Storage for the objects. */
+   struct ObjectPool *next;   /**< Next pool in use. */
+} ObjectPool;
+
+/** Storage for objects that are released together. */
+typedef struct MemoryArena {
+   PoolStats *stats;          /**< Statistics for this kind of arena. */
+   size_t blockSize;          /**< Minimum size of a block. */
+   size_t used;               /**< Bytes allocated from this arena. */
+   struct ArenaBlock *blocks; /**< Storage (the newest block first). */
+} MemoryArena;
+
+/** Initializer for a pool statistics structure.
+ * @param name The name to show with the statistics.
+ */
+#define POOL_STATS( name ) { (name), 0, 0, 0, 0, 0, NULL }
+
+/** Initializer for an object pool.
+ * @param name The name to show with the statistics.
+ * @param type The type of object in the pool.
+ */
+#define OBJECT_POOL( name, type ) \
+   { POOL_STATS(name), sizeof(type), NULL, NULL, NULL }
+
+/** Initializer for an arena.
+ * @param stats The statistics for this kind of arena.
+ * @param blockSize The minimum size of a block.
+ */
+#define MEMORY_ARENA( stats, blockSize ) { (stats), (blockSize), 0, NULL }
+
+/** Release storage of empty pools and show statistics.
+ * Statistics are shown only when compiled with -DDEBUG.
+ */
+void DestroyPools(void);
+
+/** Allocate an object from a pool.
+ * @param pool The pool.
+ * @return The object (uninitialized).
+ */
+void *AllocateObject(ObjectPool *pool);
+
+/** Return an object to a pool.
+ * @param pool The pool from which the object was allocated.
+ * @param object The object.
+ */
+void ReleaseObject(ObjectPool *pool, void *object);
+
+/** Initialize an arena.
+ * @param arena The arena.
+ * @param stats The statistics for this kind of arena.
+ * @param blockSize The minimum size of a block.
+ */
+void InitializeArena(MemoryArena *arena, PoolStats *stats, size_t blockSize);
+
+/** Allocate storage from an arena.
+ * @param arena The arena.
+ * @param size The number of bytes needed.
+ * @return The storage (aligned for any type).
+ */
+void *AllocateArena(MemoryArena *arena, size_t size);
+
+/** Release everything allocated from an arena.
+ * The first block is kept for the next use of the arena.
+ * @param arena The arena.
+ */
+void ResetArena(MemoryArena *arena);
+
+/** Release everything allocated from an arena and its storage.
+ * @param arena The arena.
+ */
+void DestroyArena(MemoryArena *arena);
+
+#endif /* POOL_H */
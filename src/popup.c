@@ -31,30 +31,23 @@ typedef struct PopupType {
 
 static PopupType popup;
 
-static void SignalPopup(const TimeType *now, int x, int y, Window w,
-                        void *data);
+static void HidePopup(void);
 
 /** Startup popups. */
 void StartupPopup(void)
 {
    popup.text = NULL;
    popup.window = None;
-   RegisterCallback(100, SignalPopup, NULL);
 }
 
 /** Shutdown popups. */
 void ShutdownPopup(void)
 {
-   UnregisterCallback(SignalPopup, NULL);
    if(popup.text) {
       Release(popup.text);
       popup.text = NULL;
    }
-   if(popup.window != None) {
-      JXDestroyWindow(display, popup.window);
-      JXFreePixmap(display, popup.pmap);
-      popup.window = None;
-   }
+   HidePopup();
 }
 
 /** Show a popup window. */
@@ -85,13 +78,11 @@ void ShowPopup(int x, int y, const char *text)
    GetMousePosition(&popup.mx, &popup.my, &popup.mw);
    popup.text = CopyString(text);
    popup.height = GetStringHeight(FONT_POPUP) + 2;
-   popup.width = GetStringWidth(FONT_POPUP, popup.text) + 9;
 
+   /* Only measure as much of the text as fits on the screen. */
    sp = GetCurrentScreen(x, y);
-
-   if(popup.width > sp->width) {
-      popup.width = sp->width;
-   }
+   popup.width = GetFittedStringWidth(FONT_POPUP, popup.text,
+                                      sp->width - 9) + 9;
 
    popup.x = x;
    if(y + 2 * popup.height + 2 >= sp->height) {
@@ -141,6 +132,7 @@ void ShowPopup(int x, int y, const char *text)
 
       JXMoveResizeWindow(display, popup.window, popup.x, popup.y,
                          popup.width, popup.height);
+      ReleaseStringDrawable(popup.pmap);
       JXFreePixmap(display, popup.pmap);
 
    }
@@ -156,22 +148,28 @@ void ShowPopup(int x, int y, const char *text)
    JXDrawRectangle(display, popup.pmap, rootGC, 0, 0,
                    popup.width - 1, popup.height - 1);
    RenderString(&rootVisual, popup.pmap, FONT_POPUP, COLOR_POPUP_FG, 4, 1,
-                popup.width, popup.text);
+                popup.width - 9, popup.text);
    JXCopyArea(display, popup.pmap, popup.window, rootGC,
               0, 0, popup.width, popup.height, 0, 0);
 
 }
 
-/** Signal popup (this is used to hide popups after awhile). */
-void SignalPopup(const TimeType *now, int x, int y, Window w, void *data)
+/** Hide the popup if the mouse moved since it was shown. */
+void UpdatePopup(int x, int y, Window w)
+{
+   if(popup.mw != w || popup.mx != x || popup.my != y) {
+      HidePopup();
+   }
+}
+
+/** Hide the popup window. */
+void HidePopup(void)
 {
    if(popup.window != None) {
-      if(popup.mw != w ||
-         abs(popup.mx - x) > 0 || abs(popup.my - y) > 0) {
-         JXDestroyWindow(display, popup.window);
-         JXFreePixmap(display, popup.pmap);
-         popup.window = None;
-      }
+      JXDestroyWindow(display, popup.window);
+      ReleaseStringDrawable(popup.pmap);
+      JXFreePixmap(display, popup.pmap);
+      popup.window = None;
    }
 }
 
@@ -183,9 +181,7 @@ char ProcessPopupEvent(const XEvent *event)
          JXCopyArea(display, popup.pmap, popup.window, rootGC,
                     0, 0, popup.width, popup.height, 0, 0);
       } else if(event->type == MotionNotify) {
-         JXDestroyWindow(display, popup.window);
-         JXFreePixmap(display, popup.pmap);
-         popup.window = None;
+         HidePopup();
       }
       return 1;
    }
@@ -25,6 +25,13 @@ void ShutdownPopup(void);
  */
 void ShowPopup(int x, int y, const char *text);
 
+/** Hide the popup if the mouse moved since it was shown.
+ * @param x The x-coordinate of the mouse (root relative).
+ * @param y The y-coordinate of the mouse (root relative).
+ * @param w The window under the mouse.
+ */
+void UpdatePopup(int x, int y, Window w);
+
 /** Process a popup event.
  * @param event The event to process.
  * @return 1 if handled, 0 otherwise.
@@ -13,6 +13,7 @@
 #include "image.h"
 #include "main.h"
 #include "color.h"
+#include "pool.h"
 
 /** Draw a scaled icon. */
 void PutScaledRenderIcon(const VisualData *visual, IconNode *icon,
@@ -96,7 +97,7 @@ ScaledIconNode *CreateScaledRenderIcon(IconNode *icon, long fg,
    Assert(icon);
    Assert(haveRender);
 
-   result = Allocate(sizeof(ScaledIconNode));
+   result = AllocateObject(&scaledIconPool);
    result->fg = fg;
    result->next = icon->nodes;
    icon->nodes = result;
@@ -113,11 +114,12 @@ ScaledIconNode *CreateScaledRenderIcon(IconNode *icon, long fg,
 
    destImage = JXCreateImage(display, rootVisual.visual, rootVisual.depth,
                              ZPixmap, 0, NULL, width, height, 8, 0);
-   destImage->data = Allocate(sizeof(unsigned long) * width * height);
+   destImage->data = AllocateArena(&iconArena,
+                                   sizeof(unsigned long) * width * height);
 
    destMask = JXCreateImage(display, rootVisual.visual, 8, ZPixmap,
                             0, NULL, width, height, 8, 0);
-   destMask->data = Allocate(width * height);
+   destMask->data = AllocateArena(&iconArena, width * height);
 
    maskLine = 0;
    for(y = 0; y < height; y++) {
@@ -161,16 +163,15 @@ ScaledIconNode *CreateScaledRenderIcon(IconNode *icon, long fg,
    /* Render the image data to the image pixmap. */
    JXPutImage(display, result->image, rootGC, destImage,
               0, 0, 0, 0, width, height);
-   Release(destImage->data);
    destImage->data = NULL;
    JXDestroyImage(destImage);
 
    /* Render the alpha data to the mask pixmap. */
    JXPutImage(display, result->mask, maskGC, destMask, 0, 0, 0, 0,
               width, height);
-   Release(destMask->data);
    destMask->data = NULL;
    JXDestroyImage(destMask);
+   ResetArena(&iconArena);
    JXFreeGC(display, maskGC);
 
    /* Create the alpha picture. */
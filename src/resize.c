@@ -18,11 +18,49 @@
 #include "key.h"
 #include "event.h"
 #include "settings.h"
-
-static char shouldStopResize;
-
-static void StopResize(ClientNode *np);
+#include "timing.h"
+#include "tray.h"
+
+static ClientNode *currentClient;
+
+/* State of the active resize. */
+static BorderActionType resizeAction;
+static int startx, starty;
+static int oldx, oldy;
+static int oldw, oldh;
+static int gwidth, gheight;
+
+/* Pacing state for opaque resizes. */
+static TimeType lastUpdate;
+static TimeType lastMotion;
+static char updatePending;
+static char configurePending;
+
+#ifdef USE_XSYNC
+/* _NET_WM_SYNC_REQUEST state for the client being resized. */
+static XSyncAlarm syncAlarm = None;
+static XSyncValue syncValue;
+static TimeType syncTime;
+static char syncWaiting;
+#endif
+
+static void StopResize(void);
 static void ResizeController(int wasDestroyed);
+static void CancelResize(void);
+static void HandleResizeEvent(XEvent *event);
+static void HandleKeyboardResizeEvent(XEvent *event);
+static void UpdateResize(ClientNode *np);
+static void StartOpaqueResize(ClientNode *np);
+static void UpdateOpaqueResize(ClientNode *np);
+static void FlushOpaqueResize(ClientNode *np, const TimeType *now);
+static void SignalResize(const TimeType *now, int x, int y, Window w,
+                         void *data);
+
+#ifdef USE_XSYNC
+static void StartSync(ClientNode *np);
+static void StopSync(void);
+static void SendSyncRequest(ClientNode *np);
+#endif
 static void FixWidth(ClientNode *np);
 static void FixHeight(ClientNode *np);
 
@@ -35,20 +73,31 @@ void ResizeController(int wasDestroyed)
    JXUngrabPointer(display, CurrentTime);
    JXUngrabKeyboard(display, CurrentTime);
    DestroyResizeWindow();
-   shouldStopResize = 1;
+   UnregisterCallback(SignalResize, NULL);
+   ClearInputHandler();
+#ifdef USE_XSYNC
+   StopSync();
+#endif
+   currentClient->controller = NULL;
+   currentClient = NULL;
+   updatePending = 0;
+   configurePending = 0;
+
+   /* Trays get no crossing events while the pointer is grabbed. */
+   AutoHideTrays();
+}
+
+/** Abort the active resize. */
+void CancelResize(void)
+{
+   (currentClient->controller)(0);
 }
 
 /** Resize a client window (mouse initiated). */
 void ResizeClient(ClientNode *np, BorderActionType action,
-                  int startx, int starty)
+                  int x, int y)
 {
 
-   XEvent event;
-   int oldx, oldy;
-   int oldw, oldh;
-   int gwidth, gheight;
-   int lastgwidth, lastgheight;
-   int delta;
    int north, south, east, west;
 
    Assert(np);
@@ -59,6 +108,12 @@ void ResizeClient(ClientNode *np, BorderActionType action,
    if(np->state.status & (STAT_VMAX | STAT_HMAX | STAT_FULLSCREEN)) {
       return;
    }
+   if(HasInputHandler()) {
+      return;
+   }
+   if(!(GetMouseMask() & (Button1Mask | Button3Mask))) {
+      return;
+   }
 
    if(JUNLIKELY(!GrabMouseForResize(action))) {
       Debug("ResizeClient: could not grab mouse");
@@ -66,8 +121,9 @@ void ResizeClient(ClientNode *np, BorderActionType action,
    }
 
    np->controller = ResizeController;
-   shouldStopResize = 0;
+   StartOpaqueResize(np);
 
+   resizeAction = action;
    oldx = np->x;
    oldy = np->y;
    oldw = np->width;
@@ -78,139 +134,117 @@ void ResizeClient(ClientNode *np, BorderActionType action,
 
    GetBorderSize(&np->state, &north, &south, &east, &west);
 
-   startx += np->x - west;
-   starty += np->y - north;
+   startx = x + np->x - west;
+   starty = y + np->y - north;
 
    CreateResizeWindow(np);
    UpdateResizeWindow(np, gwidth, gheight);
 
-   if(!(GetMouseMask() & (Button1Mask | Button3Mask))) {
-      StopResize(np);
-      return;
-   }
+   SetInputHandler(HandleResizeEvent, CancelResize);
 
-   for(;;) {
+}
 
-      WaitForEvent(&event);
+/** Handle an event during a mouse-initiated resize. */
+void HandleResizeEvent(XEvent *event)
+{
 
-      if(shouldStopResize) {
-         np->controller = NULL;
-         return;
-      }
+   ClientNode *np = currentClient;
+   const BorderActionType action = resizeAction;
+   int lastgwidth, lastgheight;
+   int delta;
 
-      switch(event.type) {
-      case ButtonRelease:
-         if(   event.xbutton.button == Button1
-            || event.xbutton.button == Button3) {
-            StopResize(np);
-            return;
+   switch(event->type) {
+   case ButtonRelease:
+      if(   event->xbutton.button == Button1
+         || event->xbutton.button == Button3) {
+         StopResize();
+      }
+      break;
+   case MotionNotify:
+
+      SetMousePosition(event->xmotion.x_root, event->xmotion.y_root,
+                       event->xmotion.window);
+      DiscardMotionEvents(event, np->window);
+
+      if(action & BA_RESIZE_N) {
+         delta = (event->xmotion.y - starty) / np->yinc;
+         delta *= np->yinc;
+         if(oldh - delta >= np->minHeight
+            && (oldh - delta <= np->maxHeight || delta > 0)) {
+            np->height = oldh - delta;
+            np->y = oldy + delta;
          }
-         break;
-      case MotionNotify:
-
-         SetMousePosition(event.xmotion.x_root, event.xmotion.y_root,
-                          event.xmotion.window);
-         DiscardMotionEvents(&event, np->window);
-
-         if(action & BA_RESIZE_N) {
-            delta = (event.xmotion.y - starty) / np->yinc;
-            delta *= np->yinc;
-            if(oldh - delta >= np->minHeight
-               && (oldh - delta <= np->maxHeight || delta > 0)) {
-               np->height = oldh - delta;
-               np->y = oldy + delta;
-            }
-            if(!(action & (BA_RESIZE_E | BA_RESIZE_W))) {
-               FixWidth(np);
-            }
+         if(!(action & (BA_RESIZE_E | BA_RESIZE_W))) {
+            FixWidth(np);
          }
-         if(action & BA_RESIZE_S) {
-            delta = (event.xmotion.y - starty) / np->yinc;
-            delta *= np->yinc;
-            np->height = oldh + delta;
-            np->height = Max(np->height, np->minHeight);
-            np->height = Min(np->height, np->maxHeight);
-            if(!(action & (BA_RESIZE_E | BA_RESIZE_W))) {
-               FixWidth(np);
-            }
+      }
+      if(action & BA_RESIZE_S) {
+         delta = (event->xmotion.y - starty) / np->yinc;
+         delta *= np->yinc;
+         np->height = oldh + delta;
+         np->height = Max(np->height, np->minHeight);
+         np->height = Min(np->height, np->maxHeight);
+         if(!(action & (BA_RESIZE_E | BA_RESIZE_W))) {
+            FixWidth(np);
          }
-         if(action & BA_RESIZE_E) {
-            delta = (event.xmotion.x - startx) / np->xinc;
-            delta *= np->xinc;
-            np->width = oldw + delta;
-            np->width = Max(np->width, np->minWidth);
-            np->width = Min(np->width, np->maxWidth);
-            if(!(action & (BA_RESIZE_N | BA_RESIZE_S))) {
-               FixHeight(np);
-            }
+      }
+      if(action & BA_RESIZE_E) {
+         delta = (event->xmotion.x - startx) / np->xinc;
+         delta *= np->xinc;
+         np->width = oldw + delta;
+         np->width = Max(np->width, np->minWidth);
+         np->width = Min(np->width, np->maxWidth);
+         if(!(action & (BA_RESIZE_N | BA_RESIZE_S))) {
+            FixHeight(np);
          }
-         if(action & BA_RESIZE_W) {
-            delta = (event.xmotion.x - startx) / np->xinc;
-            delta *= np->xinc;
-            if(oldw - delta >= np->minWidth
-               && (oldw - delta <= np->maxWidth || delta > 0)) {
-               np->width = oldw - delta;
-               np->x = oldx + delta;
-            }
-            if(!(action & (BA_RESIZE_N | BA_RESIZE_S))) {
-               FixHeight(np);
-            }
+      }
+      if(action & BA_RESIZE_W) {
+         delta = (event->xmotion.x - startx) / np->xinc;
+         delta *= np->xinc;
+         if(oldw - delta >= np->minWidth
+            && (oldw - delta <= np->maxWidth || delta > 0)) {
+            np->width = oldw - delta;
+            np->x = oldx + delta;
          }
+         if(!(action & (BA_RESIZE_N | BA_RESIZE_S))) {
+            FixHeight(np);
+         }
+      }
 
-         if(np->sizeFlags & PAspect) {
-            if((action & (BA_RESIZE_N | BA_RESIZE_S)) &&
-               (action & (BA_RESIZE_E | BA_RESIZE_W))) {
-
-               if(np->width * np->aspect.miny < np->height * np->aspect.minx) {
-                  delta = np->width;
-                  np->width = (np->height * np->aspect.minx) / np->aspect.miny;
-                  if(action & BA_RESIZE_W) {
-                     np->x -= np->width - delta;
-                  }
-               }
-               if(np->width * np->aspect.maxy > np->height * np->aspect.maxx) {
-                  delta = np->height;
-                  np->height = (np->width * np->aspect.maxy) / np->aspect.maxx;
-                  if(action & BA_RESIZE_N) {
-                     np->y -= np->height - delta;
-                  }
+      if(np->sizeFlags & PAspect) {
+         if((action & (BA_RESIZE_N | BA_RESIZE_S)) &&
+            (action & (BA_RESIZE_E | BA_RESIZE_W))) {
+
+            if(np->width * np->aspect.miny < np->height * np->aspect.minx) {
+               delta = np->width;
+               np->width = (np->height * np->aspect.minx) / np->aspect.miny;
+               if(action & BA_RESIZE_W) {
+                  np->x -= np->width - delta;
                }
             }
-         }
-
-         lastgwidth = gwidth;
-         lastgheight = gheight;
-
-         gwidth = (np->width - np->baseWidth) / np->xinc;
-         gheight = (np->height - np->baseHeight) / np->yinc;
-
-         if(lastgheight != gheight || lastgwidth != gwidth) {
-
-            UpdateResizeWindow(np, gwidth, gheight);
-
-            if(settings.resizeMode == RESIZE_OUTLINE) {
-               ClearOutline();
-               if(np->state.status & STAT_SHADED) {
-                  DrawOutline(np->x - west, np->y - north,
-                     np->width + west + east, north + south);
-               } else {
-                  DrawOutline(np->x - west, np->y - north,
-                     np->width + west + east,
-                     np->height + north + south);
+            if(np->width * np->aspect.maxy > np->height * np->aspect.maxx) {
+               delta = np->height;
+               np->height = (np->width * np->aspect.maxy) / np->aspect.maxx;
+               if(action & BA_RESIZE_N) {
+                  np->y -= np->height - delta;
                }
-            } else {
-               ResetBorder(np);
-               SendConfigureEvent(np);
             }
+         }
+      }
 
-            UpdatePager();
+      lastgwidth = gwidth;
+      lastgheight = gheight;
 
-         }
+      gwidth = (np->width - np->baseWidth) / np->xinc;
+      gheight = (np->height - np->baseHeight) / np->yinc;
 
-         break;
-      default:
-         break;
+      if(lastgheight != gheight || lastgwidth != gwidth) {
+         UpdateResize(np);
       }
+
+      break;
+   default:
+      break;
    }
 
 }
@@ -220,11 +254,6 @@ void ResizeClientKeyboard(ClientNode *np)
 {
 
    XEvent event;
-   int gwidth, gheight;
-   int lastgwidth, lastgheight;
-   int north, south, east, west;
-   int deltax, deltay;
-   int ratio, minr, maxr;
 
    Assert(np);
 
@@ -234,6 +263,9 @@ void ResizeClientKeyboard(ClientNode *np)
    if(np->state.status & (STAT_VMAX | STAT_HMAX | STAT_FULLSCREEN)) {
       return;
    }
+   if(HasInputHandler()) {
+      return;
+   }
 
    if(JUNLIKELY(JXGrabKeyboard(display, np->parent, True, GrabModeAsync,
                                GrabModeAsync, CurrentTime) != GrabSuccess)) {
@@ -243,13 +275,11 @@ void ResizeClientKeyboard(ClientNode *np)
    GrabMouseForResize(BA_RESIZE_S | BA_RESIZE_E | BA_RESIZE);
 
    np->controller = ResizeController;
-   shouldStopResize = 0;
+   StartOpaqueResize(np);
 
    gwidth = (np->width - np->baseWidth) / np->xinc;
    gheight = (np->height - np->baseHeight) / np->yinc;
 
-   GetBorderSize(&np->state, &north, &south, &east, &west);
-
    CreateResizeWindow(np);
    UpdateResizeWindow(np, gwidth, gheight);
 
@@ -260,126 +290,136 @@ void ResizeClientKeyboard(ClientNode *np)
    }
    DiscardMotionEvents(&event, np->window);
 
-   for(;;) {
+   SetInputHandler(HandleKeyboardResizeEvent, CancelResize);
 
-      WaitForEvent(&event);
+}
 
-      if(shouldStopResize) {
-         np->controller = NULL;
-         return;
-      }
+/** Handle an event during a keyboard-initiated resize. */
+void HandleKeyboardResizeEvent(XEvent *event)
+{
 
-      deltax = 0;
-      deltay = 0;
-
-      if(event.type == KeyPress) {
-
-         DiscardKeyEvents(&event, np->window);
-         switch(GetKey(&event.xkey) & 0xFF) {
-         case KEY_UP:
-            deltay = Min(-np->yinc, -10);
-            break;
-         case KEY_DOWN:
-            deltay = Max(np->yinc, 10);
-            break;
-         case KEY_RIGHT:
-            deltax = Max(np->xinc, 10);
-            break;
-         case KEY_LEFT:
-            deltax = Min(-np->xinc, -10);
-            break;
-         default:
-            StopResize(np);
-            return;
-         }
+   ClientNode *np = currentClient;
+   int lastgwidth, lastgheight;
+   int deltax, deltay;
+   int ratio, minr, maxr;
 
-      } else if(event.type == MotionNotify) {
+   deltax = 0;
+   deltay = 0;
 
-         SetMousePosition(event.xmotion.x_root, event.xmotion.y_root,
-                          event.xmotion.window);
-         DiscardMotionEvents(&event, np->window);
+   if(event->type == KeyPress) {
 
-         deltax = event.xmotion.x - (np->x + np->width);
-         if(np->state.status & STAT_SHADED) {
-            deltay = 0;
-         } else {
-            deltay = event.xmotion.y - (np->y + np->height);
-         }
+      DiscardKeyEvents(event, np->window);
+      switch(GetKey(&event->xkey) & 0xFF) {
+      case KEY_UP:
+         deltay = Min(-np->yinc, -10);
+         break;
+      case KEY_DOWN:
+         deltay = Max(np->yinc, 10);
+         break;
+      case KEY_RIGHT:
+         deltax = Max(np->xinc, 10);
+         break;
+      case KEY_LEFT:
+         deltax = Min(-np->xinc, -10);
+         break;
+      default:
+         StopResize();
+         return;
+      }
 
-      } else if(event.type == ButtonRelease) {
+   } else if(event->type == MotionNotify) {
 
-         StopResize(np);
-         return;
+      SetMousePosition(event->xmotion.x_root, event->xmotion.y_root,
+                       event->xmotion.window);
+      DiscardMotionEvents(event, np->window);
 
+      deltax = event->xmotion.x - (np->x + np->width);
+      if(np->state.status & STAT_SHADED) {
+         deltay = 0;
+      } else {
+         deltay = event->xmotion.y - (np->y + np->height);
       }
 
-      if(abs(deltax) < np->xinc && abs(deltay) < np->yinc) {
-         continue;
-      }
+   } else if(event->type == ButtonRelease) {
 
-      deltay -= deltay % np->yinc;
-      np->height += deltay;
-      np->height = Max(np->height, np->minHeight);
-      np->height = Min(np->height, np->maxHeight);
-      deltax -= deltax % np->xinc;
-      np->width += deltax;
-      np->width = Max(np->width, np->minWidth);
-      np->width = Min(np->width, np->maxWidth);
+      StopResize();
+      return;
 
-      if(np->sizeFlags & PAspect) {
+   }
 
-         ratio = (np->width << 16) / np->height;
+   if(abs(deltax) < np->xinc && abs(deltay) < np->yinc) {
+      return;
+   }
 
-         minr = (np->aspect.minx << 16) / np->aspect.miny;
-         if(ratio < minr) {
-            np->width = (np->height * minr) >> 16;
-         }
+   deltay -= deltay % np->yinc;
+   np->height += deltay;
+   np->height = Max(np->height, np->minHeight);
+   np->height = Min(np->height, np->maxHeight);
+   deltax -= deltax % np->xinc;
+   np->width += deltax;
+   np->width = Max(np->width, np->minWidth);
+   np->width = Min(np->width, np->maxWidth);
 
-         maxr = (np->aspect.maxx << 16) / np->aspect.maxy;
-         if(ratio > maxr) {
-            np->height = (np->width << 16) / maxr;
-         }
+   if(np->sizeFlags & PAspect) {
+
+      ratio = (np->width << 16) / np->height;
 
+      minr = (np->aspect.minx << 16) / np->aspect.miny;
+      if(ratio < minr) {
+         np->width = (np->height * minr) >> 16;
       }
 
-      lastgwidth = gwidth;
-      lastgheight = gheight;
-      gwidth = (np->width - np->baseWidth) / np->xinc;
-      gheight = (np->height - np->baseHeight) / np->yinc;
+      maxr = (np->aspect.maxx << 16) / np->aspect.maxy;
+      if(ratio > maxr) {
+         np->height = (np->width << 16) / maxr;
+      }
 
-      if(lastgwidth != gwidth || lastgheight != gheight) {
+   }
 
-         UpdateResizeWindow(np, gwidth, gheight);
+   lastgwidth = gwidth;
+   lastgheight = gheight;
+   gwidth = (np->width - np->baseWidth) / np->xinc;
+   gheight = (np->height - np->baseHeight) / np->yinc;
 
-         if(settings.resizeMode == RESIZE_OUTLINE) {
-            ClearOutline();
-            if(np->state.status & STAT_SHADED) {
-               DrawOutline(np->x - west, np->y - north,
-                  np->width + west + east,
-                  north + south);
-            } else {
-               DrawOutline(np->x - west, np->y - north,
-                  np->width + west + east,
-                  np->height + north + south);
-            }
-         } else {
-            ResetBorder(np);
-            SendConfigureEvent(np);
-         }
+   if(lastgwidth != gwidth || lastgheight != gheight) {
+      UpdateResize(np);
+   }
 
-         UpdatePager();
+}
 
-      }
+/** Show the new size of a client being resized. */
+void UpdateResize(ClientNode *np)
+{
 
+   int north, south, east, west;
+
+   UpdateResizeWindow(np, gwidth, gheight);
+
+   if(settings.resizeMode == RESIZE_OUTLINE) {
+      GetBorderSize(&np->state, &north, &south, &east, &west);
+      ClearOutline();
+      if(np->state.status & STAT_SHADED) {
+         DrawOutline(np->x - west, np->y - north,
+            np->width + west + east, north + south);
+      } else {
+         DrawOutline(np->x - west, np->y - north,
+            np->width + west + east,
+            np->height + north + south);
+      }
+      UpdatePager();
+   } else {
+      UpdateOpaqueResize(np);
    }
 
 }
 
 /** Stop a resize action. */
-void StopResize(ClientNode *np)
+void StopResize(void)
 {
 
-   np->controller = NULL;
+   ClientNode *np = currentClient;
+
+   (np->controller)(0);
 
    /* Set the old width/height if maximized so the window
     * is restored to the new size. */
@@ -392,20 +432,187 @@ void StopResize(ClientNode *np)
       np->oldy = np->y;
    }
 
-   if(settings.resizeMode == RESIZE_OUTLINE) {
-      ClearOutline();
-   }
+   ResetBorder(np);
+   SendConfigureEvent(np);
+   UpdatePager();
 
-   JXUngrabPointer(display, CurrentTime);
-   JXUngrabKeyboard(display, CurrentTime);
+}
 
-   DestroyResizeWindow();
+/** Prepare the opaque resize state and register the resize callback. */
+void StartOpaqueResize(ClientNode *np)
+{
+   int freq;
+   currentClient = np;
+   lastUpdate.seconds = 0;
+   lastUpdate.ms = 0;
+   updatePending = 0;
+   configurePending = 0;
+   freq = settings.resizeRate > 0 ? 1000 / settings.resizeRate : 0;
+   RegisterCallback(freq, SignalResize, NULL);
+#ifdef USE_XSYNC
+   if(settings.resizeMode == RESIZE_OPAQUE) {
+      StartSync(np);
+   }
+#endif
+}
 
+/** Update the size of a client being resized (opaque mode).
+ * Like opaque moves, updates are limited to settings.resizeRate per
+ * second and the synthetic ConfigureNotify waits for a pause.
+ */
+void UpdateOpaqueResize(ClientNode *np)
+{
+   TimeType now;
+   GetCurrentTime(&now);
+   lastMotion = now;
+   updatePending = 1;
+   if(settings.resizeRate == 0
+      || GetTimeDifference(&now, &lastUpdate) >= 1000 / settings.resizeRate) {
+      FlushOpaqueResize(np, &now);
+   }
+}
+
+/** Send a pending opaque resize to the X server. */
+void FlushOpaqueResize(ClientNode *np, const TimeType *now)
+{
+#ifdef USE_XSYNC
+   if(syncAlarm != None) {
+      /* Wait for the client to finish drawing the previous size. */
+      if(syncWaiting && GetTimeDifference(now, &syncTime) < SYNC_TIMEOUT) {
+         updatePending = 1;
+         return;
+      }
+      SendSyncRequest(np);
+   }
+#endif
    ResetBorder(np);
-   SendConfigureEvent(np);
+   UpdatePager();
+   lastUpdate = *now;
+   updatePending = 0;
+   configurePending = 1;
+}
+
+/** Flush paced resizes and send ConfigureNotify once the pointer pauses. */
+void SignalResize(const TimeType *now, int x, int y, Window w, void *data)
+{
+   if(updatePending) {
+      FlushOpaqueResize(currentClient, now);
+   }
+   if(configurePending
+      && GetTimeDifference(now, &lastMotion) >= CONFIGURE_DELAY) {
+      SendConfigureEvent(currentClient);
+      configurePending = 0;
+   }
+}
+
+#ifdef USE_XSYNC
+
+/** Set up an alarm on the sync counter of a client that supports
+ * _NET_WM_SYNC_REQUEST.
+ */
+void StartSync(ClientNode *np)
+{
+
+   XSyncAlarmAttributes attr;
+   XSyncValue one;
+   unsigned long counter;
+   int overflow;
+
+   syncAlarm = None;
+   syncWaiting = 0;
+
+   if(!haveSync || !(np->state.status & STAT_SYNC)) {
+      return;
+   }
+   if(!GetCardinalAtom(np->window, ATOM_NET_WM_SYNC_REQUEST_COUNTER,
+                       &counter)) {
+      return;
+   }
+   if(JUNLIKELY(!JXSyncQueryCounter(display, counter, &syncValue))) {
+      return;
+   }
+
+   /* Wait for a value past the current one so the alarm does not
+    * trigger as soon as it is created. */
+   XSyncIntToValue(&one, 1);
+   attr.trigger.counter = counter;
+   attr.trigger.value_type = XSyncAbsolute;
+   XSyncValueAdd(&attr.trigger.wait_value, syncValue, one, &overflow);
+   attr.trigger.test_type = XSyncPositiveComparison;
+   XSyncIntToValue(&attr.delta, 0);
+   attr.events = True;
+   syncAlarm = JXSyncCreateAlarm(display,
+                                 XSyncCACounter | XSyncCAValueType
+                                 | XSyncCAValue | XSyncCATestType
+                                 | XSyncCADelta | XSyncCAEvents,
+                                 &attr);
+
+}
+
+/** Destroy the sync alarm (if any). */
+void StopSync(void)
+{
+   if(syncAlarm != None) {
+      JXSyncDestroyAlarm(display, syncAlarm);
+      syncAlarm = None;
+   }
+   syncWaiting = 0;
+}
+
+/** Ask a client to update its sync counter after the next configure. */
+void SendSyncRequest(ClientNode *np)
+{
+
+   XSyncAlarmAttributes attr;
+   XSyncValue one;
+   XEvent event;
+   int overflow;
+
+   XSyncIntToValue(&one, 1);
+   XSyncValueAdd(&syncValue, syncValue, one, &overflow);
+
+   memset(&event, 0, sizeof(event));
+   event.xclient.type = ClientMessage;
+   event.xclient.window = np->window;
+   event.xclient.message_type = atoms[ATOM_WM_PROTOCOLS];
+   event.xclient.format = 32;
+   event.xclient.data.l[0] = atoms[ATOM_NET_WM_SYNC_REQUEST];
+   event.xclient.data.l[1] = eventTime;
+   event.xclient.data.l[2] = XSyncValueLow32(syncValue);
+   event.xclient.data.l[3] = XSyncValueHigh32(syncValue);
+   JXSendEvent(display, np->window, False, NoEventMask, &event);
+
+   attr.trigger.wait_value = syncValue;
+   JXSyncChangeAlarm(display, syncAlarm, XSyncCAValue, &attr);
+
+   syncWaiting = 1;
+   GetCurrentTime(&syncTime);
 
 }
 
+/** Handle a sync alarm for the client being resized. */
+char HandleResizeSync(const XSyncAlarmNotifyEvent *event)
+{
+   TimeType now;
+   if(syncAlarm == None || event->alarm != syncAlarm) {
+      return 0;
+   }
+
+   /* Ignore alarms for requests before the last one. */
+   if(XSyncValueLessThan(event->counter_value, syncValue)) {
+      return 1;
+   }
+
+   syncWaiting = 0;
+   if(updatePending) {
+      GetCurrentTime(&now);
+      FlushOpaqueResize(currentClient, &now);
+   }
+   return 1;
+}
+
+#endif /* USE_XSYNC */
+
 /** Fix the width to match the aspect ratio. */
 void FixWidth(ClientNode *np)
 {
@@ -14,7 +14,8 @@
 
 struct ClientNode;
 
-/** Resize a client window.
+/** Start resizing a client window.
+ * The resize is driven by the main event loop; this returns immediately.
  * @param np The client to resize.
  * @param action The location on the border where the move should take place.
  * @param startx The starting mouse x-coordinate (window relative).
@@ -23,10 +24,20 @@ struct ClientNode;
 void ResizeClient(struct ClientNode *np, BorderActionType action,
                   int startx, int starty);
 
-/** Resize a client window using the keyboard (mouse optional).
+/** Start resizing a client window using the keyboard (mouse optional).
  * @param np The client to resize.
  */
 void ResizeClientKeyboard(struct ClientNode *np);
 
+#ifdef USE_XSYNC
+/** Handle an XSync alarm event.
+ * This is used to continue an opaque resize once the client has
+ * acknowledged a _NET_WM_SYNC_REQUEST.
+ * @param event The alarm event.
+ * @return 1 if the event was for the current resize, 0 otherwise.
+ */
+char HandleResizeSync(const XSyncAlarmNotifyEvent *event);
+#endif
+
 #endif /* RESIZE_H */
 
@@ -62,6 +62,17 @@ void StartupRootMenu(void)
 
 }
 
+/** Shutdown root menus. */
+void ShutdownRootMenu(void)
+{
+   unsigned int x;
+   for(x = 0; x < ROOT_MENU_COUNT; x++) {
+      if(rootMenu[x]) {
+         DestroyMenuWindows(rootMenu[x]);
+      }
+   }
+}
+
 /** Destroy root menu data. */
 void DestroyRootMenu(void)
 {
@@ -149,13 +160,13 @@ void GetRootMenuSize(int index, int *width, int *height)
 }
 
 /** Show a root menu. */
-char ShowRootMenu(int index, int x, int y)
+char ShowRootMenu(int index, int x, int y, MenuCloseType closer)
 {
 
    if(!rootMenu[index]) {
       return 0;
    }
-   ShowMenu(rootMenu[index], RunRootCommand, x, y);
+   ShowMenu(rootMenu[index], RunRootCommand, closer, x, y);
    return 1;
 
 }
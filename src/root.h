@@ -10,12 +10,12 @@
 #ifndef ROOT_H
 #define ROOT_H
 
-struct Menu;
+#include "menu.h"
 
 /*@{*/
 void InitializeRootMenu(void);
 void StartupRootMenu(void);
-#define ShutdownRootMenu() (void)(0)
+void ShutdownRootMenu(void);
 void DestroyRootMenu(void);
 /*@}*/
 
@@ -41,9 +41,10 @@ void GetRootMenuSize(int index, int *width, int *height);
  * @param index The root menu index.
  * @param x The x-coordinate.
  * @param y The y-coordinate.
+ * @param closer Callback executed when the menu is closed (or NULL).
  * @return 1 if a menu was displayed, 0 if not.
  */
-char ShowRootMenu(int index, int x, int y);
+char ShowRootMenu(int index, int x, int y, MenuCloseType closer);
 
 /** Restart the window manager. */
 void Restart(void);
@@ -41,6 +41,8 @@ void InitializeSettings(void)
    settings.taskInsertMode = INSERT_RIGHT;
    settings.exitConfirmation = 1;
    settings.cornerRadius = 4;
+   settings.moveRate = 60;
+   settings.resizeRate = 60;
 }
 
 /** Make sure settings are reasonable. */
@@ -57,6 +59,9 @@ void StartupSettings(void)
 
    FixRange(&settings.desktopWidth, 1, 64, 4);
    FixRange(&settings.desktopHeight, 1, 64, 1);
+
+   FixRange(&settings.moveRate, 0, 1000, 60);
+   FixRange(&settings.resizeRate, 0, 1000, 60);
    settings.desktopCount = settings.desktopWidth * settings.desktopHeight;
 
 }
@@ -60,6 +60,8 @@ typedef struct {
    unsigned int menuOpacity;
    unsigned int desktopDelay;
    unsigned int cornerRadius;
+   unsigned int moveRate;
+   unsigned int resizeRate;
    SnapModeType snapMode;
    MoveModeType moveMode;
    StatusWindowType moveStatusType;
@@ -117,6 +117,7 @@ void DrawMoveResizeWindow(const ClientNode *np, StatusWindowType type)
 void DestroyMoveResizeWindow(void)
 {
    if(statusWindow != None) {
+      ReleaseStringDrawable(statusWindow);
       JXDestroyWindow(display, statusWindow);
       statusWindow = None;
    }
@@ -24,6 +24,8 @@
 #include "screen.h"
 #include "settings.h"
 #include "event.h"
+#include "font.h"
+#include "pool.h"
 
 typedef struct TaskBarType {
 
@@ -34,9 +36,6 @@ typedef struct TaskBarType {
 
    Pixmap buffer;
 
-   TimeType mouseTime;
-   int mousex, mousey;
-
    unsigned int maxItemWidth;
 
    struct TaskBarType *next;
@@ -50,15 +49,26 @@ typedef struct Node {
    struct Node *prev;
 } Node;
 
+/** Last value written to a client list property on the root window. */
+typedef struct ClientListType {
+   Window *windows;
+   unsigned int count;
+   unsigned int size;
+   char valid;
+} ClientListType;
+
 static TaskBarType *bars;
+static ObjectPool nodePool = OBJECT_POOL("task bar nodes", Node);
 static Node *taskBarNodes;
 static Node *taskBarNodesTail;
+static ClientListType netClientList;
+static ClientListType netClientListStacking;
 
 static Node *GetNode(TaskBarType *bar, int x);
 static unsigned int GetItemCount(void);
 static unsigned int GetItemWidth(const TaskBarType *bp,
                                  unsigned int itemCount);
-static void Render(const TaskBarType *bp);
+static void Render(const TaskBarType *bp, char flashOnly);
 static void ShowTaskWindowMenu(TaskBarType *bar, Node *np);
 
 static void SetSize(TrayComponentType *cp, int width, int height);
@@ -66,10 +76,10 @@ static void Create(TrayComponentType *cp);
 static void Resize(TrayComponentType *cp);
 static void ProcessTaskButtonEvent(TrayComponentType *cp,
                                    int x, int y, int mask);
-static void ProcessTaskMotionEvent(TrayComponentType *cp,
-                                   int x, int y, int mask);
-static void SignalTaskbar(const TimeType *now, int x, int y, Window w,
-                          void *data);
+static void ShowTaskPopup(TrayComponentType *cp, int x, int y);
+static void SetClientList(AtomType atom, ClientListType *list,
+                          const Window *windows, unsigned int count);
+static void ClearClientList(ClientListType *list);
 
 /** Initialize task bar data. */
 void InitializeTaskBar(void)
@@ -77,6 +87,8 @@ void InitializeTaskBar(void)
    bars = NULL;
    taskBarNodes = NULL;
    taskBarNodesTail = NULL;
+   memset(&netClientList, 0, sizeof(netClientList));
+   memset(&netClientListStacking, 0, sizeof(netClientListStacking));
 }
 
 /** Shutdown the task bar. */
@@ -84,7 +96,7 @@ void ShutdownTaskBar(void)
 {
    TaskBarType *bp;
    for(bp = bars; bp; bp = bp->next) {
-      UnregisterCallback(SignalTaskbar, bp);
+      ReleaseStringDrawable(bp->buffer);
       JXFreePixmap(display, bp->buffer);
    }
 }
@@ -98,6 +110,8 @@ void DestroyTaskBar(void)
       Release(bars);
       bars = bp;
    }
+   ClearClientList(&netClientList);
+   ClearClientList(&netClientListStacking);
 }
 
 /** Create a new task bar tray component. */
@@ -112,10 +126,6 @@ TrayComponentType *CreateTaskBar()
    bars = tp;
    tp->itemHeight = 0;
    tp->layout = LAYOUT_HORIZONTAL;
-   tp->mousex = -settings.doubleClickDelta;
-   tp->mousey = -settings.doubleClickDelta;
-   tp->mouseTime.seconds = 0;
-   tp->mouseTime.ms = 0;
    tp->maxItemWidth = 0;
 
    cp = CreateTrayComponent();
@@ -126,9 +136,7 @@ TrayComponentType *CreateTaskBar()
    cp->Create = Create;
    cp->Resize = Resize;
    cp->ProcessButtonPress = ProcessTaskButtonEvent;
-   cp->ProcessMotionEvent = ProcessTaskMotionEvent;
-
-   RegisterCallback(settings.popupDelay / 2, SignalTaskbar, tp);
+   cp->ShowPopup = ShowTaskPopup;
 
    return cp;
 
@@ -200,6 +208,7 @@ void Resize(TrayComponentType *cp)
    Assert(tp);
 
    if(tp->buffer != None) {
+      ReleaseStringDrawable(tp->buffer);
       JXFreePixmap(display, tp->buffer);
    }
 
@@ -261,15 +270,6 @@ void ProcessTaskButtonEvent(TrayComponentType *cp, int x, int y, int mask)
 
 }
 
-/** Process a task list motion event. */
-void ProcessTaskMotionEvent(TrayComponentType *cp, int x, int y, int mask)
-{
-   TaskBarType *bp = (TaskBarType*)cp->object;
-   bp->mousex = cp->screenx + x;
-   bp->mousey = cp->screeny + y;
-   GetCurrentTime(&bp->mouseTime);
-}
-
 /** Show the menu associated with a task list item. */
 void ShowTaskWindowMenu(TaskBarType *bar, Node *np)
 {
@@ -312,7 +312,7 @@ void AddClientToTaskBar(ClientNode *np)
 
    Assert(np);
 
-   tp = Allocate(sizeof(Node));
+   tp = AllocateObject(&nodePool);
    tp->client = np;
 
    if(settings.taskInsertMode == INSERT_RIGHT) {
@@ -361,7 +361,7 @@ void RemoveClientFromTaskBar(ClientNode *np)
          } else {
             taskBarNodesTail = tp->prev;
          }
-         Release(tp);
+         ReleaseObject(&nodePool, tp);
          break;
       }
    }
@@ -392,37 +392,46 @@ void UpdateTaskBar(void)
             ResizeTray(bp->cp->tray);
          }
       }
-      Render(bp);
+      BeginSpanValue("Render", 0);
+      Render(bp, 0);
+      EndSpan();
    }
 
 }
 
-/** Signal task bar (for popups). */
-void SignalTaskbar(const TimeType *now, int x, int y, Window w, void *data)
+/** Redraw the task bar buttons of clients that flash for urgency. */
+void FlashTaskBar(void)
 {
+   TaskBarType *bp;
+   if(JUNLIKELY(shouldExit)) {
+      return;
+   }
+   for(bp = bars; bp; bp = bp->next) {
+      BeginSpanValue("Render", 1);
+      Render(bp, 1);
+      EndSpan();
+   }
+}
 
-   TaskBarType *bp = (TaskBarType*)data;
+/** Show the popup for a task bar item. */
+void ShowTaskPopup(TrayComponentType *cp, int x, int y)
+{
+   TaskBarType *bp = (TaskBarType*)cp->object;
    Node *np;
-
-   if(w == bp->cp->tray->window &&
-      abs(bp->mousex - x) < settings.doubleClickDelta &&
-      abs(bp->mousey - y) < settings.doubleClickDelta) {
-      if(GetTimeDifference(now, &bp->mouseTime) >= settings.popupDelay) {
-         if(bp->layout == LAYOUT_HORIZONTAL) {
-            np = GetNode(bp, x - bp->cp->screenx);
-         } else {
-            np = GetNode(bp, y - bp->cp->screeny);
-         }
-         if(np && np->client->name) {
-            ShowPopup(x, y, np->client->name);
-         }
-      }
+   if(bp->layout == LAYOUT_HORIZONTAL) {
+      np = GetNode(bp, x);
+   } else {
+      np = GetNode(bp, y);
+   }
+   if(np && np->client->name) {
+      ShowPopup(cp->screenx + x, cp->screeny + y, np->client->name);
    }
-
 }
 
-/** Draw a specific task bar. */
-void Render(const TaskBarType *bp)
+/** Draw a specific task bar.
+ * If flashOnly is set, only the buttons of urgent clients are redrawn.
+ */
+void Render(const TaskBarType *bp, char flashOnly)
 {
 
    Node *tp;
@@ -450,9 +459,14 @@ void Render(const TaskBarType *bp)
    width -= x;
    y = 0;
 
-   ClearTrayDrawable(bp->cp);
-
    itemCount = GetItemCount();
+   if(flashOnly) {
+      if(!itemCount) {
+         return;
+      }
+   } else {
+      ClearTrayDrawable(bp->cp);
+   }
    if(!itemCount) {
       UpdateSpecificTray(bp->cp->tray, bp->cp);
       return;
@@ -473,6 +487,10 @@ void Render(const TaskBarType *bp)
 
          tp->y = y;
 
+         if(flashOnly && !(tp->client->state.status & STAT_URGENT)) {
+            goto NextButton;
+         }
+
          if(tp->client->state.status & (STAT_ACTIVE | STAT_FLASH)) {
             button.type = BUTTON_TASK_ACTIVE;
          } else {
@@ -517,6 +535,7 @@ void Render(const TaskBarType *bp)
             }
          }
 
+NextButton:
          if(bp->layout == LAYOUT_HORIZONTAL) {
             x += itemWidth;
             if(remainder) {
@@ -746,9 +765,7 @@ void UpdateNetClientList(void)
       windows[count] = np->client->window;
       count += 1;
    }
-   JXChangeProperty(display, rootWindow, atoms[ATOM_NET_CLIENT_LIST],
-                    XA_WINDOW, 32, PropModeReplace,
-                    (unsigned char*)windows, count);
+   SetClientList(ATOM_NET_CLIENT_LIST, &netClientList, windows, count);
 
    /* Set _NET_CLIENT_LIST_STACKING */
    count = 0;
@@ -758,9 +775,8 @@ void UpdateNetClientList(void)
          count += 1;
       }
    }
-   JXChangeProperty(display, rootWindow, atoms[ATOM_NET_CLIENT_LIST_STACKING],
-                    XA_WINDOW, 32, PropModeReplace,
-                    (unsigned char*)windows, count);
+   SetClientList(ATOM_NET_CLIENT_LIST_STACKING, &netClientListStacking,
+                 windows, count);
 
    if(windows != NULL) {
       ReleaseStack(windows);
@@ -768,3 +784,53 @@ void UpdateNetClientList(void)
    
 }
 
+/** Write a client list property if its contents changed.
+ * When windows were only added to the end, they are appended rather
+ * than rewriting the whole property.
+ */
+void SetClientList(AtomType atom, ClientListType *list,
+                   const Window *windows, unsigned int count)
+{
+
+   const size_t oldSize = list->count * sizeof(Window);
+
+   if(list->valid && count >= list->count
+      && (oldSize == 0 || !memcmp(windows, list->windows, oldSize))) {
+      if(count > list->count) {
+         JXChangeProperty(display, rootWindow, atoms[atom],
+                          XA_WINDOW, 32, PropModeAppend,
+                          (unsigned char*)&windows[list->count],
+                          count - list->count);
+      }
+   } else {
+      JXChangeProperty(display, rootWindow, atoms[atom],
+                       XA_WINDOW, 32, PropModeReplace,
+                       (unsigned char*)windows, count);
+   }
+
+   if(count > list->size) {
+      list->size = count;
+      if(list->windows) {
+         list->windows = Reallocate(list->windows,
+                                    list->size * sizeof(Window));
+      } else {
+         list->windows = Allocate(list->size * sizeof(Window));
+      }
+   }
+   if(count > 0) {
+      memcpy(list->windows, windows, count * sizeof(Window));
+   }
+   list->count = count;
+   list->valid = 1;
+
+}
+
+/** Release the cached contents of a client list property. */
+void ClearClientList(ClientListType *list)
+{
+   if(list->windows) {
+      Release(list->windows);
+   }
+   memset(list, 0, sizeof(ClientListType));
+}
+
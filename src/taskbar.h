@@ -36,6 +36,9 @@ void RemoveClientFromTaskBar(struct ClientNode *np);
 /** Update all task bars. */
 void UpdateTaskBar(void);
 
+/** Redraw the buttons of clients that flash for urgency. */
+void FlashTaskBar(void);
+
 /** Focus the next client in the task bar. */
 void FocusNext(void);
 
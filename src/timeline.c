@@ -0,0 +1,126 @@
+/**
+ * @file timeline.c
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Timeline tracing.
+ *
+ * Spans are recorded when they end as complete ("X") events so that
+ * the ring buffer never holds a begin without its end. The trace is
+ * written to $JWM_TIMELINE or /tmp/jwm-<pid>.json.
+ *
+ */
+
+#include "jwm.h"
+
+#ifdef TRACE_TIMELINE
+
+/** Number of spans kept (the oldest are overwritten). */
+#define TIMELINE_SIZE 32768
+
+/** Deepest nesting of spans that is recorded. */
+#define TIMELINE_DEPTH 64
+
+/** A finished span. */
+typedef struct SpanType {
+   const char *name;
+   long value;
+   double start;        /**< Microseconds since tracing started. */
+   double duration;     /**< Microseconds. */
+} SpanType;
+
+/** A span that has not ended. */
+typedef struct OpenSpanType {
+   const char *name;
+   long value;
+   double start;
+} OpenSpanType;
+
+static SpanType spans[TIMELINE_SIZE];
+static unsigned int spanOffset = 0;
+static unsigned int spanCount = 0;
+static OpenSpanType openSpans[TIMELINE_DEPTH];
+static unsigned int depth = 0;
+static struct timeval base;
+
+static double GetTimestamp(void);
+
+/** Start a span. */
+void TIMELINE_Begin(const char *name, long value)
+{
+   if(depth < TIMELINE_DEPTH) {
+      openSpans[depth].name = name;
+      openSpans[depth].value = value;
+      openSpans[depth].start = GetTimestamp();
+   }
+   depth += 1;
+}
+
+/** End the most recently started span. */
+void TIMELINE_End(void)
+{
+   Assert(depth > 0);
+   depth -= 1;
+   if(depth < TIMELINE_DEPTH) {
+      SpanType *sp = &spans[spanOffset];
+      sp->name = openSpans[depth].name;
+      sp->value = openSpans[depth].value;
+      sp->start = openSpans[depth].start;
+      sp->duration = GetTimestamp() - sp->start;
+      spanOffset = (spanOffset + 1) % TIMELINE_SIZE;
+      if(spanCount < TIMELINE_SIZE) {
+         spanCount += 1;
+      }
+   }
+}
+
+/** Write the recorded spans to the trace file and clear them. */
+void TIMELINE_Flush(void)
+{
+   char path[64];
+   const char *name;
+   FILE *fd;
+   unsigned int x, offset;
+   const int pid = (int)getpid();
+
+   name = getenv("JWM_TIMELINE");
+   if(!name) {
+      snprintf(path, sizeof(path), "/tmp/jwm-%d.json", pid);
+      name = path;
+   }
+   fd = fopen(name, "w");
+   if(JUNLIKELY(!fd)) {
+      Debug("TIMELINE: could not write %s", name);
+      return;
+   }
+
+   fprintf(fd, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+   fprintf(fd, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+               "\"args\":{\"name\":\"jwm\"}}", pid);
+   offset = (spanOffset + TIMELINE_SIZE - spanCount) % TIMELINE_SIZE;
+   for(x = 0; x < spanCount; x++) {
+      const SpanType *sp = &spans[offset];
+      fprintf(fd, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+                  "\"ts\":%.1f,\"dur\":%.1f,\"args\":{\"value\":%ld}}",
+              sp->name, pid, pid, sp->start, sp->duration, sp->value);
+      offset = (offset + 1) % TIMELINE_SIZE;
+   }
+   fprintf(fd, "\n]}\n");
+   fclose(fd);
+
+   spanCount = 0;
+}
+
+/** Get the microseconds since tracing started. */
+double GetTimestamp(void)
+{
+   struct timeval now;
+   gettimeofday(&now, NULL);
+   if(JUNLIKELY(base.tv_sec == 0)) {
+      base = now;
+   }
+   return (double)(now.tv_sec - base.tv_sec) * 1000000.0
+        + (double)(now.tv_usec - base.tv_usec);
+}
+
+#endif /* TRACE_TIMELINE */
@@ -0,0 +1,50 @@
+/**
+ * @file timeline.h
+ * @author Joe Wingbermuehle
+ * @date 2015
+ *
+ * @brief Header for timeline tracing.
+ *
+ * When compiled with -DTRACE_TIMELINE, spans of time marked with
+ * BeginSpan and EndSpan are recorded in a ring buffer. FlushTimeline
+ * writes the buffer as Chrome trace-event JSON (for Perfetto or
+ * chrome://tracing). Otherwise the macros do nothing.
+ *
+ */
+
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#ifdef TRACE_TIMELINE
+
+/** Start a span.
+ * @param name The name of the span (a string constant).
+ */
+#  define BeginSpan( name )            TIMELINE_Begin( (name), 0 )
+
+/** Start a span with a value to show with it.
+ * @param name The name of the span (a string constant).
+ * @param value The value (for example, an event type).
+ */
+#  define BeginSpanValue( name, value ) TIMELINE_Begin( (name), (value) )
+
+/** End the most recently started span. */
+#  define EndSpan()                    TIMELINE_End()
+
+/** Write the recorded spans to the trace file and clear them. */
+#  define FlushTimeline()              TIMELINE_Flush()
+
+   void TIMELINE_Begin(const char*, long);
+   void TIMELINE_End(void);
+   void TIMELINE_Flush(void);
+
+#else /* TRACE_TIMELINE */
+
+#  define BeginSpan( name )            ((void)0)
+#  define BeginSpanValue( name, value ) ((void)0)
+#  define EndSpan()                    ((void)0)
+#  define FlushTimeline()              ((void)0)
+
+#endif /* TRACE_TIMELINE */
+
+#endif /* TIMELINE_H */
@@ -9,9 +9,31 @@
 
 #include "jwm.h"
 #include "timing.h"
+#include "misc.h"
 
 static const unsigned long MAX_TIME_SECONDS = 60;
 
+/** Seconds that a cached time zone offset is used before it is checked
+ * again. Offsets only change on quarter-hour boundaries.
+ */
+#define ZONE_PERIOD  900
+
+/** Cached state of a time zone. */
+typedef struct ZoneNode {
+   char *zone;             /**< The zone in tzset() format. */
+   long offset;            /**< Offset from UTC in seconds. */
+   time_t start;           /**< Start of the period the state is for. */
+   char name[16];          /**< Zone abbreviation. */
+   char isdst;             /**< Set if daylight saving time is in effect. */
+   struct ZoneNode *next;
+} ZoneNode;
+
+static ZoneNode *zones = NULL;
+
+static const ZoneNode *GetZone(const char *zone, time_t t);
+static void ExpandZoneFormat(const char *format, const ZoneNode *zp,
+                             time_t t, char *dest, size_t size);
+
 /** Get the current time in milliseconds since midnight 1970-01-01 UTC. */
 void GetCurrentTime(TimeType *t)
 {
@@ -57,9 +79,8 @@ unsigned long GetTimeDifference(const TimeType *t1, const TimeType *t2)
 const char *GetTimeString(const char *format, const char *zone)
 {
 
-   static char saveTZ[256];
-   static char newTZ[256];
    static char str[80];
+   struct tm tm;
    time_t t;
 
    Assert(format);
@@ -67,6 +88,59 @@ const char *GetTimeString(const char *format, const char *zone)
    time(&t);
 
    if(zone) {
+      char zoneFormat[80];
+      const ZoneNode *zp = GetZone(zone, t);
+      const time_t local = t + zp->offset;
+      tm = *gmtime(&local);
+      tm.tm_isdst = zp->isdst;
+      ExpandZoneFormat(format, zp, t, zoneFormat, sizeof(zoneFormat));
+      strftime(str, sizeof(str), zoneFormat, &tm);
+   } else {
+      strftime(str, sizeof(str), format, localtime(&t));
+   }
+
+   return str;
+
+}
+
+/** Release cached time zone data. */
+void ReleaseTimeZones(void)
+{
+   while(zones) {
+      ZoneNode *zp = zones->next;
+      Release(zones->zone);
+      Release(zones);
+      zones = zp;
+   }
+}
+
+/** Get the cached state of a time zone, updating it if needed. */
+const ZoneNode *GetZone(const char *zone, time_t t)
+{
+
+   static char saveTZ[256];
+   static char newTZ[256];
+   ZoneNode *zp;
+   struct tm local, utc;
+   int days;
+
+   for(zp = zones; zp; zp = zp->next) {
+      if(!strcmp(zp->zone, zone)) {
+         if(t >= zp->start && t < zp->start + ZONE_PERIOD) {
+            return zp;
+         }
+         break;
+      }
+   }
+   if(!zp) {
+      zp = Allocate(sizeof(ZoneNode));
+      zp->zone = CopyString(zone);
+      zp->next = zones;
+      zones = zp;
+   }
+
+   /* Switch TZ to read the offset and abbreviation of the zone. */
+   {
       const char *oldTZ = getenv("TZ");
       if(oldTZ) {
          snprintf(saveTZ, sizeof(saveTZ), "TZ=%s", oldTZ);
@@ -78,7 +152,8 @@ const char *GetTimeString(const char *format, const char *zone)
       snprintf(newTZ, sizeof(newTZ), "TZ=%s", zone);
       putenv(newTZ);
       tzset();
-      strftime(str, sizeof(str), format, localtime(&t));
+      local = *localtime(&t);
+      strftime(zp->name, sizeof(zp->name), "%Z", &local);
 #ifdef HAVE_UNSETENV
       if(oldTZ) {
          putenv(saveTZ);
@@ -88,10 +163,61 @@ const char *GetTimeString(const char *format, const char *zone)
 #else
       putenv(saveTZ);
 #endif
+      tzset();
+   }
+
+   utc = *gmtime(&t);
+   if(local.tm_year != utc.tm_year) {
+      days = local.tm_year > utc.tm_year ? 1 : -1;
    } else {
-      strftime(str, sizeof(str), format, localtime(&t));
+      days = local.tm_yday - utc.tm_yday;
    }
+   zp->offset = days * 86400L
+              + (local.tm_hour - utc.tm_hour) * 3600L
+              + (local.tm_min - utc.tm_min) * 60L
+              + (local.tm_sec - utc.tm_sec);
+   zp->isdst = local.tm_isdst;
+   zp->start = t - t % ZONE_PERIOD;
 
-   return str;
+   return zp;
+
+}
 
+/** Replace the time zone conversions and seconds since the epoch in a
+ * format with the zone state and time. These cannot be left to strftime
+ * since the broken-down time is computed in UTC.
+ */
+void ExpandZoneFormat(const char *format, const ZoneNode *zp,
+                      time_t t, char *dest, size_t size)
+{
+   size_t len = 0;
+   while(*format && len + 1 < size) {
+      if(format[0] == '%'
+         && (format[1] == 'Z' || format[1] == 'z' || format[1] == 's')) {
+         char temp[32];
+         if(format[1] == 'Z') {
+            strcpy(temp, zp->name);
+         } else if(format[1] == 's') {
+            /* strftime would convert the shifted time as local time. */
+            snprintf(temp, sizeof(temp), "%ld", (long)t);
+         } else {
+            const long minutes = labs(zp->offset) / 60;
+            snprintf(temp, sizeof(temp), "%c%02d%02d",
+                     zp->offset < 0 ? '-' : '+',
+                     (int)(minutes / 60), (int)(minutes % 60));
+         }
+         len += snprintf(&dest[len], size - len, "%s", temp);
+         len = Min(len, size - 1);
+         format += 2;
+      } else if(format[0] == '%' && format[1]) {
+         if(len + 2 >= size) {
+            break;
+         }
+         dest[len++] = *format++;
+         dest[len++] = *format++;
+      } else {
+         dest[len++] = *format++;
+      }
+   }
+   dest[len] = 0;
 }
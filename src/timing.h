@@ -43,5 +43,8 @@ unsigned long GetTimeDifference(const TimeType *t1, const TimeType *t2);
  */
 const char *GetTimeString(const char *format, const char *zone);
 
+/** Release the state cached for time zones by GetTimeString. */
+void ReleaseTimeZones(void);
+
 #endif /* TIMING_H */
 
@@ -22,6 +22,7 @@
 #include "event.h"
 #include "client.h"
 #include "misc.h"
+#include "popup.h"
 
 #define DEFAULT_TRAY_WIDTH 32
 #define DEFAULT_TRAY_HEIGHT 32
@@ -30,8 +31,12 @@
 static TrayType *trays;
 static unsigned int trayCount;
 
+/* The component waiting to show a popup (NULL for none). */
+static TrayComponentType *hoverComponent;
+
 static void HandleTrayExpose(TrayType *tp, const XExposeEvent *event);
 static void HandleTrayEnterNotify(TrayType *tp, const XCrossingEvent *event);
+static void HandleTrayLeaveNotify(TrayType *tp, const XCrossingEvent *event);
 
 static TrayComponentType *GetTrayComponent(TrayType *tp, int x, int y);
 static void HandleTrayButtonPress(TrayType *tp, const XButtonEvent *event);
@@ -48,8 +53,11 @@ static char CheckVerticalFill(TrayType *tp);
 static void LayoutTray(TrayType *tp, int *variableSize,
                        int *variableRemainder);
 
-static void SignalTray(const TimeType *now, int x, int y, Window w,
-                       void *data);
+static char ContainsPoint(const TrayType *tp, int x, int y);
+static void StartHover(TrayType *tp, int x, int y);
+static void StopHover(void);
+static void SignalHover(const TimeType *now, int x, int y, Window w,
+                        void *data);
 
 
 /** Initialize tray data. */
@@ -57,6 +65,7 @@ void InitializeTray(void)
 {
    trays = NULL;
    trayCount = 0;
+   hoverComponent = NULL;
 }
 
 /** Startup trays. */
@@ -93,6 +102,7 @@ void StartupTray(void)
          | KeyPressMask
          | KeyReleaseMask
          | EnterWindowMask
+         | LeaveWindowMask
          | PointerMotionMask;
 
       attrMask |= CWBackPixel;
@@ -185,6 +195,7 @@ void ShutdownTray(void)
    TrayType *tp;
    TrayComponentType *cp;
 
+   StopHover();
    for(tp = trays; tp; tp = tp->next) {
       for(cp = tp->components; cp; cp = cp->next) {
          if(cp->Destroy) {
@@ -192,7 +203,6 @@ void ShutdownTray(void)
          }
       }
       JXDestroyWindow(display, tp->window);
-      UnregisterCallback(SignalTray, tp);
    }
 
 }
@@ -251,8 +261,6 @@ TrayType *CreateTray(void)
    tp->next = trays;
    trays = tp;
 
-   RegisterCallback(100, SignalTray, tp);
-
    return tp;
 
 }
@@ -288,6 +296,7 @@ TrayComponentType *CreateTrayComponent(void)
    cp->ProcessButtonPress = NULL;
    cp->ProcessButtonRelease = NULL;
    cp->ProcessMotionEvent = NULL;
+   cp->ShowPopup = NULL;
 
    cp->next = NULL;
 
@@ -571,26 +580,15 @@ void ComputeTraySize(TrayType *tp)
 
 }
 
-/** Display a tray (for autohide). */
+/** Display a tray (for autohide).
+ * The tray will hide again when the mouse leaves it.
+ */
 void ShowTray(TrayType *tp)
 {
-
-   Window win1, win2;
-   int winx, winy;
-   unsigned int mask;
-   int mousex, mousey;
-
    if(tp->hidden) {
-
       tp->hidden = 0;
       JXMoveWindow(display, tp->window, tp->x, tp->y);
-
-      JXQueryPointer(display, rootWindow, &win1, &win2,
-                     &mousex, &mousey, &winx, &winy, &mask);
-      SetMousePosition(mousex, mousey, win2);
-
    }
-
 }
 
 /** Show all trays. */
@@ -668,6 +666,9 @@ char ProcessTrayEvent(const XEvent *event)
          case EnterNotify:
             HandleTrayEnterNotify(tp, &event->xcrossing);
             return 1;
+         case LeaveNotify:
+            HandleTrayLeaveNotify(tp, &event->xcrossing);
+            return 1;
          case ButtonPress:
             HandleTrayButtonPress(tp, &event->xbutton);
             return 1;
@@ -687,15 +688,47 @@ char ProcessTrayEvent(const XEvent *event)
 
 }
 
-/** Signal the tray (needed for autohide). */
-void SignalTray(const TimeType *now, int x, int y, Window w, void *data)
+/** Determine if a point is on a tray. */
+char ContainsPoint(const TrayType *tp, int x, int y)
 {
-   TrayType *tp = (TrayType*)data;
-   if(tp->autoHide != THIDE_OFF && !tp->hidden && !menuShown) {
-      if(x < tp->x || x >= tp->x + tp->width
-         || y < tp->y || y >= tp->y + tp->height) {
-         HideTray(tp);
-      }
+   return x >= tp->x && x < tp->x + tp->width
+       && y >= tp->y && y < tp->y + tp->height;
+}
+
+/** Start waiting to show a popup for the component under the mouse.
+ * The coordinates are relative to the tray.
+ */
+void StartHover(TrayType *tp, int x, int y)
+{
+   TrayComponentType *cp = GetTrayComponent(tp, x, y);
+   if(!cp || !cp->ShowPopup || !settings.popupEnabled) {
+      StopHover();
+      return;
+   }
+   if(hoverComponent) {
+      SetCallbackDelay(SignalHover, NULL, settings.popupDelay);
+   } else {
+      RegisterCallback(settings.popupDelay, SignalHover, NULL);
+   }
+   hoverComponent = cp;
+}
+
+/** Stop waiting to show a popup. */
+void StopHover(void)
+{
+   if(hoverComponent) {
+      UnregisterCallback(SignalHover, NULL);
+      hoverComponent = NULL;
+   }
+}
+
+/** Show the popup for a component after the mouse rests on it. */
+void SignalHover(const TimeType *now, int x, int y, Window w, void *data)
+{
+   TrayComponentType *cp = hoverComponent;
+   StopHover();
+   if(cp->tray->window == w && !cp->tray->hidden) {
+      (cp->ShowPopup)(cp, x - cp->screenx, y - cp->screeny);
    }
 }
 
@@ -705,10 +738,34 @@ void HandleTrayExpose(TrayType *tp, const XExposeEvent *event)
    DrawSpecificTray(tp);
 }
 
-/** Handle a tray enter notify (for autohide). */
+/** Handle a tray enter notify (for autohide and popups). */
 void HandleTrayEnterNotify(TrayType *tp, const XCrossingEvent *event)
 {
    ShowTray(tp);
+   StartHover(tp, event->x, event->y);
+}
+
+/** Handle a tray leave notify (for autohide and popups). */
+void HandleTrayLeaveNotify(TrayType *tp, const XCrossingEvent *event)
+{
+
+   /* Swallowed windows get no tray motion, so popups and hovers end
+    * when the pointer moves onto one. */
+   StopHover();
+   UpdatePopup(event->x_root, event->y_root, None);
+
+   /* Moving onto a swallowed window does not leave the tray. */
+   if(event->detail == NotifyInferior) {
+      return;
+   }
+
+   /* Grabs (for menus) are handled when the grab ends. */
+   if(event->mode == NotifyNormal && !menuShown
+      && tp->autoHide != THIDE_OFF && !tp->hidden
+      && !ContainsPoint(tp, event->x_root, event->y_root)) {
+      HideTray(tp);
+   }
+
 }
 
 /** Get the tray component under the given coordinates. */
@@ -768,6 +825,7 @@ void HandleTrayButtonRelease(TrayType *tp, const XButtonEvent *event)
          (cp->ProcessButtonRelease)(cp, x, y, mask);
          JXUngrabPointer(display, CurrentTime);
          cp->grabbed = 0;
+         AutoHideTrays();
          return;
       }
    }
@@ -794,6 +852,9 @@ void HandleTrayMotionNotify(TrayType *tp, const XMotionEvent *event)
       (cp->ProcessMotionEvent)(cp, x, y, mask);
    }
 
+   UpdatePopup(event->x_root, event->y_root, tp->window);
+   StartHover(tp, event->x, event->y);
+
 }
 
 /** Draw all trays. */
@@ -833,6 +894,7 @@ void RaiseTrays(void)
       ShowTray(tp);
       JXRaiseWindow(display, tp->window);
    }
+   InvalidateStacking();
 }
 
 /** Lower tray windows. */
@@ -843,6 +905,27 @@ void LowerTrays(void)
       tp->autoHide &= ~THIDE_RAISED;
    }
    RestackClients();
+   AutoHideTrays();
+}
+
+/** Hide trays that should autohide and do not contain the mouse. */
+void AutoHideTrays(void)
+{
+   TrayType *tp;
+   Window w;
+   int x, y;
+
+   if(menuShown) {
+      return;
+   }
+
+   GetMousePosition(&x, &y, &w);
+   for(tp = trays; tp; tp = tp->next) {
+      if(tp->autoHide != THIDE_OFF && !tp->hidden
+         && !ContainsPoint(tp, x, y)) {
+         HideTray(tp);
+      }
+   }
 }
 
 /** Update a specific component on a tray. */
@@ -109,6 +109,11 @@ typedef struct TrayComponentType {
    void (*ProcessMotionEvent)(struct TrayComponentType *cp,
                               int x, int y, int mask);
 
+   /** Callback to show a popup after the mouse rests on the component.
+    * The coordinates are relative to the component.
+    */
+   void (*ShowPopup)(struct TrayComponentType *cp, int x, int y);
+
    /** The next component in the tray. */
    struct TrayComponentType *next;
 
@@ -197,6 +202,11 @@ void RaiseTrays(void);
 /** Lower tray windows. */
 void LowerTrays(void);
 
+/** Hide trays that should autohide and do not contain the mouse.
+ * This is needed when a grab that hid crossing events ends.
+ */
+void AutoHideTrays(void);
+
 /** Update a component on a tray.
  * @param tp The tray containing the component.
  * @param cp The component that needs updating.
@@ -37,15 +37,12 @@ typedef struct TrayButtonType {
    IconNode *icon;
    char *action;
 
-   int mousex;
-   int mousey;
-   TimeType mouseTime;
-
    struct TrayButtonType *next;
 
 } TrayButtonType;
 
 static TrayButtonType *buttons = NULL;
+static TrayComponentType *menuButton = NULL;
 
 static void Create(TrayComponentType *cp);
 static void Destroy(TrayComponentType *cp);
@@ -57,10 +54,8 @@ static void ProcessButtonPress(TrayComponentType *cp,
                                int x, int y, int mask);
 static void ProcessButtonRelease(TrayComponentType *cp,
                                  int x, int y, int mask);
-static void ProcessMotionEvent(TrayComponentType *cp,
-                               int x, int y, int mask);
-static void SignalTrayButton(const TimeType *now,
-                             int x, int y, Window w, void *data);
+static void ShowButtonPopup(TrayComponentType *cp, int x, int y);
+static void RootMenuClosed(Menu *menu);
 
 /** Startup tray buttons. */
 void StartupTrayButtons(void)
@@ -97,7 +92,6 @@ void DestroyTrayButtons(void)
    TrayButtonType *bp;
    while(buttons) {
       bp = buttons->next;
-      UnregisterCallback(SignalTrayButton, buttons);
       if(buttons->label) {
          Release(buttons->label);
       }
@@ -149,9 +143,6 @@ TrayComponentType *CreateTrayButton(const char *iconName,
    cp->requestedWidth = width;
    cp->requestedHeight = height;
 
-   bp->mousex = -settings.doubleClickDelta;
-   bp->mousey = -settings.doubleClickDelta;
-
    cp->Create = Create;
    cp->Destroy = Destroy;
    cp->SetSize = SetSize;
@@ -160,11 +151,9 @@ TrayComponentType *CreateTrayButton(const char *iconName,
    cp->ProcessButtonPress = ProcessButtonPress;
    cp->ProcessButtonRelease = ProcessButtonRelease;
    if(popup || label) {
-      cp->ProcessMotionEvent = ProcessMotionEvent;
+      cp->ShowPopup = ShowButtonPopup;
    }
 
-   RegisterCallback(settings.popupDelay / 2, SignalTrayButton, bp);
-
    return cp;
 
 }
@@ -265,6 +254,7 @@ void Resize(TrayComponentType *cp)
 void Destroy(TrayComponentType *cp)
 {
    if(cp->pixmap != None) {
+      ReleaseStringDrawable(cp->pixmap);
       JXFreePixmap(display, cp->pixmap);
    }
 }
@@ -344,12 +334,23 @@ void ProcessButtonPress(TrayComponentType *cp, int x, int y, int mask)
 
    Draw(cp, 1);
    UpdateSpecificTray(cp->tray, cp);
-   ShowRootMenu(button, x, y);
-   Draw(cp, 0);
-   UpdateSpecificTray(cp->tray, cp);
+   menuButton = cp;
+   if(!ShowRootMenu(button, x, y, RootMenuClosed)) {
+      RootMenuClosed(NULL);
+   }
 
 }
 
+/** Release the tray button once its root menu is closed. */
+void RootMenuClosed(Menu *menu)
+{
+   if(menuButton) {
+      Draw(menuButton, 0);
+      UpdateSpecificTray(menuButton->tray, menuButton);
+      menuButton = NULL;
+   }
+}
+
 /** Process a button release. */
 void ProcessButtonRelease(TrayComponentType *cp, int x, int y, int mask)
 {
@@ -383,35 +384,12 @@ void ProcessButtonRelease(TrayComponentType *cp, int x, int y, int mask)
 
 }
 
-/** Process a motion event. */
-void ProcessMotionEvent(TrayComponentType *cp, int x, int y, int mask)
+/** Show the popup for a tray button. */
+void ShowButtonPopup(TrayComponentType *cp, int x, int y)
 {
    TrayButtonType *bp = (TrayButtonType*)cp->object;
-   bp->mousex = cp->screenx + x;
-   bp->mousey = cp->screeny + y;
-   GetCurrentTime(&bp->mouseTime);
-}
-
-/** Signal (needed for popups). */
-void SignalTrayButton(const TimeType *now, int x, int y, Window w, void *data)
-{
-   TrayButtonType *bp = (TrayButtonType*)data;
-   const char *popup;
-
-   if(bp->popup) {
-      popup = bp->popup;
-   } else if(bp->label) {
-      popup = bp->label;
-   } else {
-      return;
-   }
-   if(bp->cp->tray->window == w &&
-      abs(bp->mousex - x) < settings.doubleClickDelta &&
-      abs(bp->mousey - y) < settings.doubleClickDelta) {
-      if(GetTimeDifference(now, &bp->mouseTime) >= settings.popupDelay) {
-         ShowPopup(x, y, popup);
-      }
-   }
+   const char *popup = bp->popup ? bp->popup : bp->label;
+   ShowPopup(cp->screenx + x, cp->screeny + y, popup);
 }
 
 /** Validate tray buttons. */
@@ -18,6 +18,7 @@
 #include "misc.h"
 #include "root.h"
 #include "settings.h"
+#include "tray.h"
 
 static Menu *CreateWindowMenu(void);
 static void RunWindowCommand(const MenuAction *action);
@@ -27,7 +28,11 @@ static void CreateWindowSendToMenu(Menu *menu);
 static void AddWindowMenuItem(Menu *menu, const char *name,
                               MenuActionType type, int value);
 
+static void HandleChooseEvent(XEvent *event);
+static void StopChoose(void);
+
 static ClientNode *client = NULL;
+static MenuAction chooseAction;
 
 /** Get the size of a window menu. */
 void GetWindowMenuSize(ClientNode *np, int *width, int *height)
@@ -55,9 +60,7 @@ void ShowWindowMenu(ClientNode *np, int x, int y)
 
    InitializeMenu(menu);
 
-   ShowMenu(menu, RunWindowCommand, x, y);
-
-   DestroyMenu(menu);
+   ShowMenu(menu, RunWindowCommand, DestroyMenu, x, y);
 
 }
 
@@ -151,12 +154,8 @@ void CreateWindowLayerMenu(Menu *menu)
    Menu *submenu;
    MenuItem *item;
 
-   item = Allocate(sizeof(MenuItem));
-   item->type = MENU_ITEM_SUBMENU;
+   item = CreateMenuItem(MENU_ITEM_SUBMENU);
    item->name = CopyString(_("Layer"));
-   item->action.type = MA_NONE;
-   item->action.data.str = NULL;
-   item->iconName = NULL;
 
    item->next = menu->items;
    menu->items = item;
@@ -214,17 +213,10 @@ void AddWindowMenuItem(Menu *menu, const char *name,
 
    MenuItem *item;
 
-   item = Allocate(sizeof(MenuItem));
-   if(name) {
-      item->type = MENU_ITEM_NORMAL;
-   } else {
-      item->type = MENU_ITEM_SEPARATOR;
-   }
+   item = CreateMenuItem(name ? MENU_ITEM_NORMAL : MENU_ITEM_SEPARATOR);
    item->name = CopyString(name);
    item->action.type = type;
    item->action.data.i = value;
-   item->iconName = NULL;
-   item->submenu = NULL;
 
    item->next = menu->items;
    menu->items = item;
@@ -234,33 +226,41 @@ void AddWindowMenuItem(Menu *menu, const char *name,
 /** Select a window for performing an action. */
 void ChooseWindow(const MenuAction *action)
 {
-
-   XEvent event;
-   ClientNode *np;
-
+   if(HasInputHandler()) {
+      return;
+   }
    GrabMouseForChoose();
+   chooseAction = *action;
+   SetInputHandler(HandleChooseEvent, StopChoose);
+}
 
-   for(;;) {
+/** Handle an event while choosing a window. */
+void HandleChooseEvent(XEvent *event)
+{
 
-      WaitForEvent(&event);
+   ClientNode *np;
 
-      if(event.type == ButtonPress) {
-         if(event.xbutton.button == Button1) {
-            np = FindClient(event.xbutton.subwindow);
-            if(np) {
-               client = np;
-               RunWindowCommand(action);
-            }
+   if(event->type == ButtonPress) {
+      StopChoose();
+      if(event->xbutton.button == Button1) {
+         np = FindClient(event->xbutton.subwindow);
+         if(np) {
+            client = np;
+            RunWindowCommand(&chooseAction);
          }
-         break;
-      } else if(event.type == KeyPress) {
-         break;
       }
-
+   } else if(event->type == KeyPress) {
+      StopChoose();
    }
 
-   JXUngrabPointer(display, CurrentTime);
+}
 
+/** Stop choosing a window. */
+void StopChoose(void)
+{
+   ClearInputHandler();
+   JXUngrabPointer(display, CurrentTime);
+   AutoHideTrays();
 }
 
 /** Window menu action callback. */